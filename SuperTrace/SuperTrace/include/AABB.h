@@ -0,0 +1,87 @@
+//*************************************************************************************************
+// Title: AABB.h
+// Description: An axis aligned bounding box, used to bound objects for the acceleration structure.
+//*************************************************************************************************
+#ifndef __STAABB_H__
+#define __STAABB_H__
+
+#include "Vector3.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Math
+	*	@{
+	*/
+
+	class AABB
+	{
+	public:
+		/** Default constructor, the box is empty until it is grown
+		*/
+		AABB();
+
+		/** Constructor
+		* @param
+		*	min The minimum corner
+		* @param
+		*	max The maximum corner
+		*/
+		AABB(const Vector3& min, const Vector3& max);
+
+		/** Grow the box to contain a point
+		* @param
+		*	point The point to contain
+		*/
+		void grow(const Vector3& point);
+
+		/** Grow the box to contain another box
+		* @param
+		*	box The box to contain
+		*/
+		void grow(const AABB& box);
+
+		/** Get the minimum corner
+		* @return
+		*	const Vector3& The minimum corner
+		*/
+		const Vector3& getMin() const;
+
+		/** Get the maximum corner
+		* @return
+		*	const Vector3& The maximum corner
+		*/
+		const Vector3& getMax() const;
+
+		/** Get the center of the box
+		* @return
+		*	Vector3 The center
+		*/
+		Vector3 getCenter() const;
+
+		/** Get the surface area of the box
+		* @return
+		*	float The surface area, 0 for an empty box
+		*/
+		float getSurfaceArea() const;
+
+		/** Check whether the box contains nothing
+		* @return
+		*	bool True if the box has never been grown
+		*/
+		bool isEmpty() const;
+
+	private:
+		/** Minimum corner
+		*/
+		Vector3 _min;
+
+		/** Maximum corner
+		*/
+		Vector3 _max;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STAABB_H__
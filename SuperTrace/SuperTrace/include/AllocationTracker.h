@@ -0,0 +1,70 @@
+//*************************************************************************************************
+// Title: AllocationTracker.h
+// Description: Counts heap allocations made through operator new. Counting replaces the global
+//	operator new and delete, so it is only compiled in when ST_TRACK_ALLOCATIONS is defined,
+//	otherwise every count reads 0.
+//*************************************************************************************************
+#ifndef __STALLOCATIONTRACKER_H__
+#define __STALLOCATIONTRACKER_H__
+
+namespace SuperTrace
+{
+	/** \addtogroup Memory
+	*	@{
+	*/
+
+	/** Heap allocations made by a thread or by the whole process
+	*/
+	struct AllocationCount
+	{
+		AllocationCount()
+			:	numAllocations(0), numBytes(0)
+		{ }
+
+		AllocationCount& operator+=(const AllocationCount& count)
+		{
+			numAllocations += count.numAllocations;
+			numBytes += count.numBytes;
+			return *this;
+		}
+
+		AllocationCount operator-(const AllocationCount& count) const
+		{
+			AllocationCount difference;
+			difference.numAllocations = numAllocations - count.numAllocations;
+			difference.numBytes = numBytes - count.numBytes;
+			return difference;
+		}
+
+		/** Number of calls to operator new
+		*/
+		unsigned long long numAllocations;
+
+		/** Bytes requested by those calls
+		*/
+		unsigned long long numBytes;
+	};
+
+	/** Check whether allocations are being counted
+	* @return
+	*	bool True when built with ST_TRACK_ALLOCATIONS
+	*/
+	bool IsAllocationTrackingEnabled();
+
+	/** Get the allocations made by the calling thread since it started
+	* @return
+	*	AllocationCount The allocations
+	*/
+	AllocationCount GetThreadAllocations();
+
+	/** Get the allocations made by every thread since the process started
+	* @return
+	*	AllocationCount The allocations
+	*/
+	AllocationCount GetProcessAllocations();
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STALLOCATIONTRACKER_H__
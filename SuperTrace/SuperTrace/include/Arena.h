@@ -0,0 +1,191 @@
+//*************************************************************************************************
+// Title: Arena.h
+// Description: A bump allocator that hands out memory from large blocks. Everything allocated is
+//	released at once by reset, which keeps the blocks so a frame that fits in the last frame's
+//	blocks never touches the heap.
+//*************************************************************************************************
+#ifndef __STARENA_H__
+#define __STARENA_H__
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace SuperTrace
+{
+	/** \addtogroup Memory
+	*	@{
+	*/
+
+	class Arena
+	{
+	public:
+		/** Constructor, no memory is taken until the first allocation
+		* @param
+		*	blockSize The size of each block in bytes, larger allocations get a block of their own
+		*/
+		explicit Arena(size_t blockSize = 64 * 1024);
+
+		/** Destructor, destroys every object created in the arena and frees the blocks
+		*/
+		~Arena();
+
+		/** Allocate raw memory, valid until the next reset
+		* @param
+		*	size The number of bytes
+		* @param
+		*	alignment The alignment, a power of two
+		* @return
+		*	void* The memory
+		*/
+		void* allocate(size_t size, size_t alignment);
+
+		/** Construct an object in the arena, its destructor runs when the arena is reset
+		* @param
+		*	args The constructor arguments
+		* @return
+		*	T* The object
+		*/
+		template <typename T, typename... Args>
+		T* create(Args&&... args)
+		{
+			void* memory = allocate(sizeof(T), alignof(T));
+			T* object = new(memory) T(std::forward<Args>(args)...);
+			if(std::is_trivially_destructible<T>::value == false)
+			{
+				addFinalizer(&Destroy<T>, object);
+			}
+			return object;
+		}
+
+		/** Allocate an array of default constructed elements, only for types that need no destructor
+		* @param
+		*	count The number of elements
+		* @param
+		*	alignment The alignment of the first element, at least that of T
+		* @return
+		*	T* The first element
+		*/
+		template <typename T>
+		T* allocateArray(size_t count, size_t alignment = alignof(T))
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "arena arrays are never destroyed");
+			T* elements = static_cast<T*>(allocate(sizeof(T) * count, alignment < alignof(T) ? alignof(T) : alignment));
+			for(size_t i = 0; i < count; ++i)
+			{
+				new(elements + i) T();
+			}
+			return elements;
+		}
+
+		/** Destroy every object created since the last reset and rewind to the first block, the
+		*	blocks are kept for reuse
+		*/
+		void reset();
+
+		/** Get the bytes handed out since the last reset, including alignment padding
+		* @return
+		*	size_t The bytes in use
+		*/
+		size_t getBytesUsed() const;
+
+		/** Get the bytes held in blocks
+		* @return
+		*	size_t The bytes reserved
+		*/
+		size_t getBytesReserved() const;
+
+		/** Get the number of blocks taken from the heap over the arena's lifetime
+		* @return
+		*	unsigned int The number of blocks
+		*/
+		unsigned int getNumBlocks() const;
+
+	private:
+		// Copying would free the blocks twice
+		Arena(const Arena&);
+		Arena& operator=(const Arena&);
+
+		/** Header at the start of each block, the usable memory follows it
+		*/
+		struct Block
+		{
+			Block* next;
+			size_t size;
+		};
+
+		/** Destructor to run on reset, allocated in the arena itself
+		*/
+		struct Finalizer
+		{
+			void (*destroy)(void*);
+			void* object;
+			Finalizer* next;
+		};
+
+		/** Run the destructor of an arena object
+		*/
+		template <typename T>
+		static void Destroy(void* object)
+		{
+			static_cast<T*>(object)->~T();
+		}
+
+		/** Record a destructor to run on reset
+		* @param
+		*	destroy The function that destroys the object
+		* @param
+		*	object The object
+		*/
+		void addFinalizer(void (*destroy)(void*), void* object);
+
+		/** Make the next block that can hold an allocation current, taking a new one if none fits
+		* @param
+		*	size The number of bytes
+		* @param
+		*	alignment The alignment
+		*/
+		void nextBlock(size_t size, size_t alignment);
+
+		/** Get the first usable byte of a block
+		*/
+		static char* BlockBegin(Block* block);
+
+	private:
+		/** Size of a regular block in bytes
+		*/
+		size_t _blockSize;
+
+		/** Blocks in allocation order, every block past the current one is free
+		*/
+		Block* _first;
+		Block* _current;
+
+		/** Next free byte and end of the current block
+		*/
+		char* _next;
+		char* _end;
+
+		/** Bytes used in the blocks before the current one
+		*/
+		size_t _bytesBeforeCurrent;
+
+		/** Bytes held in blocks
+		*/
+		size_t _bytesReserved;
+
+		/** Number of blocks held
+		*/
+		unsigned int _numBlocks;
+
+		/** Destructors to run on reset, most recent first
+		*/
+		Finalizer* _finalizers;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STARENA_H__
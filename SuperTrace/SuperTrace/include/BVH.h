@@ -0,0 +1,692 @@
+//*************************************************************************************************
+// Title: BVH.h
+// Description: A bounding volume hierarchy built with the surface area heuristic. The hierarchy
+//	only knows primitive bounds, the caller intersects the primitives in each leaf it reaches.
+//*************************************************************************************************
+#ifndef __STBVH_H__
+#define __STBVH_H__
+
+#include <vector>
+#include "AABB.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "RenderStats.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** A node of the hierarchy, 32 bytes so two share a cache line
+	*/
+	struct BVHNode
+	{
+		/** Minimum corner of the node bounds
+		*/
+		float min[3];
+
+		/** Index of the left child for an interior node, the right child follows it. Index of the
+		*	first primitive for a leaf
+		*/
+		unsigned int leftFirst;
+
+		/** Maximum corner of the node bounds
+		*/
+		float max[3];
+
+		/** Number of primitives in a leaf, 0 for an interior node
+		*/
+		unsigned int count;
+	};
+
+	/** What a build produced and what it cost
+	*/
+	struct BVHBuildStats
+	{
+		BVHBuildStats()
+			:	buildSeconds(0.0), sahCost(0.0f), numNodes(0), numLeaves(0), maxDepth(0), numThreads(0)
+		{ }
+
+		/** Wall clock time of the build
+		*/
+		double buildSeconds;
+
+		/** Expected cost of a random ray under the surface area heuristic, lower traces faster
+		*/
+		float sahCost;
+
+		/** Number of nodes and leaves in the tree
+		*/
+		unsigned int numNodes;
+		unsigned int numLeaves;
+
+		/** Depth of the deepest leaf, the root is at depth 1
+		*/
+		unsigned int maxDepth;
+
+		/** Number of threads the build used
+		*/
+		unsigned int numThreads;
+	};
+
+	class BVH
+	{
+	public:
+		/** Default constructor
+		*/
+		BVH();
+
+		/** Destructor
+		*/
+		~BVH();
+
+		/** Set the largest number of primitives a leaf may hold
+		* @param
+		*	maxLeafSize The maximum leaf size
+		*/
+		void setMaxLeafSize(unsigned int maxLeafSize);
+
+		/** Set the cost of intersecting one primitive relative to stepping through a node, lower it
+		*	for primitives that are tested several at a time so leaves fill up
+		* @param
+		*	cost The relative cost of a primitive test, 1 by default
+		*/
+		void setIntersectionCost(float cost);
+
+		/** Set the number of bins the SAH sweep uses per axis, fewer builds faster, more finds
+		*	better splits
+		* @param
+		*	numBins The bin count, clamped to [2, MaxBins]
+		*/
+		void setNumBins(unsigned int numBins);
+
+		/** Set the number of threads used to build
+		* @param
+		*	numThreads The number of threads, 0 to use the hardware concurrency
+		*/
+		void setNumBuildThreads(unsigned int numThreads);
+
+		/** Build the hierarchy, replacing any previous one
+		* @param
+		*	bounds The bounds of each primitive, primitives are referred to by their index
+		*/
+		void build(const std::vector<AABB>& bounds);
+
+		/** Release the hierarchy
+		*/
+		void clear();
+
+		/** Get the number of nodes
+		* @return
+		*	unsigned int The number of nodes, 0 if nothing has been built
+		*/
+		unsigned int getNumNodes() const;
+
+		/** Get the bounds of everything in the hierarchy
+		* @return
+		*	AABB The root bounds
+		*/
+		AABB getBounds() const;
+
+		/** Get the statistics of the last build
+		* @return
+		*	const BVHBuildStats& The build statistics
+		*/
+		const BVHBuildStats& getBuildStats() const;
+
+		/** Get the primitive indices in leaf order, a leaf covers a contiguous range of them
+		* @return
+		*	const std::vector<unsigned int>& The primitive indices
+		*/
+		const std::vector<unsigned int>& getIndices() const;
+
+		/** Walk the leaves a ray passes through, nearest first. Nodes beyond tMax are skipped, and
+		*	tMax is read again after every leaf, so a test that shortens it on a hit prunes the rest
+		*	of the walk
+		* @param
+		*	ray The ray
+		* @param
+		*	tMax The far end of the ray, usually the distance of the closest hit so far
+		* @param
+		*	leafTest Called with each primitive index in a reached leaf, returns true to stop
+		*/
+		template <typename LeafTest>
+		void traverse(const Ray& ray, const float& tMax, LeafTest leafTest) const;
+
+		/** Walk the leaves a ray passes through, nearest first, like traverse but handing over each
+		*	leaf whole so its primitives can be tested together
+		* @param
+		*	ray The ray
+		* @param
+		*	tMax The far end of the ray, usually the distance of the closest hit so far
+		* @param
+		*	leafTest Called with the position of a reached leaf's first primitive in getIndices and
+		*	its primitive count, returns true to stop
+		*/
+		template <typename LeafTest>
+		void traverseLeaves(const Ray& ray, const float& tMax, LeafTest leafTest) const;
+
+		/** Walk the leaves a ray passes through in no particular order until a leaf test reports a
+		*	hit. Cheaper per node than traverse since children are not sorted, for occlusion queries
+		*	where any hit will do
+		* @param
+		*	ray The ray, only nodes within [tMin, tMax] are visited
+		* @param
+		*	leafTest Called with each primitive index in a reached leaf, returns true on a hit
+		* @return
+		*	bool True if a leaf test reported a hit
+		*/
+		template <typename LeafTest>
+		bool traverseAny(const Ray& ray, LeafTest leafTest) const;
+
+		/** Walk the leaves a packet of rays passes through. Each node is tested across every lane
+		*	still active below it, and lanes that miss a node drop out of its subtree. Children are
+		*	ordered by the direction of the first active ray, which suits coherent packets. tMax is
+		*	read again at every node
+		* @param
+		*	packet The rays
+		* @param
+		*	mask The lanes to trace, a bit per lane
+		* @param
+		*	tMax The far end of each lane, usually the distance of the closest hit so far
+		* @param
+		*	leafTest Called with each primitive index in a reached leaf and the lanes that reached
+		*	it, returns true to stop
+		*/
+		template <typename LeafTest>
+		void traversePacket(const RayPacket& packet, unsigned int mask, const float* tMax, LeafTest leafTest) const;
+
+		/** Walk the leaves a packet of rays passes through like traversePacket, handing over each
+		*	leaf whole
+		* @param
+		*	packet The rays
+		* @param
+		*	mask The lanes to trace, a bit per lane
+		* @param
+		*	tMax The far end of each lane, usually the distance of the closest hit so far
+		* @param
+		*	leafTest Called with the position of a reached leaf's first primitive in getIndices, its
+		*	primitive count and the lanes that reached it, returns true to stop
+		*/
+		template <typename LeafTest>
+		void traversePacketLeaves(const RayPacket& packet, unsigned int mask, const float* tMax, LeafTest leafTest) const;
+
+	public:
+		/** Most bins the SAH sweep can use
+		*/
+		static const unsigned int MaxBins = 64;
+
+	private:
+		// Copying would share the build storage
+		BVH(const BVH&);
+		BVH& operator=(const BVH&);
+
+		/** Working storage kept between builds, defined with the builder
+		*/
+		struct BuildStorage;
+
+		/** Measure the SAH cost, leaf count and depth of the built tree
+		*/
+		void measureTree();
+
+		/** Slab test of a ray against a node
+		* @param
+		*	node The node
+		* @param
+		*	origin The ray origin
+		* @param
+		*	invDirection The inverse ray direction
+		* @param
+		*	tMin The start of the ray
+		* @param
+		*	tMax The end of the ray
+		* @param
+		*	tNear Receives the distance at which the ray enters the node
+		* @return
+		*	bool True if the ray overlaps the node
+		*/
+		static bool intersectNode(const BVHNode& node, const float* origin, const float* invDirection, float tMin, float tMax, float& tNear);
+
+		/** Slab test of every lane of a packet against a node
+		* @param
+		*	node The node
+		* @param
+		*	origin The ray origins, one register per axis
+		* @param
+		*	invDirection The inverse ray directions, one register per axis
+		* @param
+		*	tMin The start of each ray
+		* @param
+		*	tMax The end of each ray
+		* @return
+		*	unsigned int A bit per lane that overlaps the node
+		*/
+		static unsigned int intersectNodePacket(const BVHNode& node, const PacketFloat* origin, const PacketFloat* invDirection, PacketFloat tMin, PacketFloat tMax);
+
+	private:
+		/** Deepest the tree may get, which bounds the traversal stack
+		*/
+		static const unsigned int MaxDepth = 64;
+
+		/** Largest number of primitives in a leaf
+		*/
+		unsigned int _maxLeafSize;
+
+		/** Cost of a primitive test relative to a node step
+		*/
+		float _intersectionCost;
+
+		/** Bins per axis in the SAH sweep
+		*/
+		unsigned int _numBins;
+
+		/** Requested build threads, 0 for hardware concurrency
+		*/
+		unsigned int _numBuildThreads;
+
+		/** Statistics of the last build
+		*/
+		BVHBuildStats _buildStats;
+
+		/** The nodes, the root is first
+		*/
+		std::vector<BVHNode> _nodes;
+
+		/** Primitive indices, each leaf covers a contiguous range
+		*/
+		std::vector<unsigned int> _indices;
+
+		/** Working storage of the last build, reused so rebuilding a hierarchy of the same size
+		*	allocates nothing
+		*/
+		BuildStorage* _buildStorage;
+	};
+
+	/** Slab test of a ray against a node
+	* @param
+	*	node The node
+	* @param
+	*	origin The ray origin
+	* @param
+	*	invDirection The inverse ray direction
+	* @param
+	*	tMin The start of the ray
+	* @param
+	*	tMax The end of the ray
+	* @param
+	*	tNear Receives the distance at which the ray enters the node
+	* @return
+	*	bool True if the ray overlaps the node
+	*/
+	inline bool BVH::intersectNode(const BVHNode& node, const float* origin, const float* invDirection, float tMin, float tMax, float& tNear)
+	{
+		ST_STATS_ADD(numNodeTests, 1);
+		for(unsigned int axis = 0; axis < 3; ++axis)
+		{
+			float t0 = (node.min[axis] - origin[axis]) * invDirection[axis];
+			float t1 = (node.max[axis] - origin[axis]) * invDirection[axis];
+			if(t0 > t1)
+			{
+				float t = t0;
+				t0 = t1;
+				t1 = t;
+			}
+
+			// Written so a NaN from a zero direction component leaves the interval alone
+			tMin = t0 > tMin ? t0 : tMin;
+			tMax = t1 < tMax ? t1 : tMax;
+		}
+
+		tNear = tMin;
+		return tMin <= tMax;
+	}
+
+	/** Slab test of every lane of a packet against a node
+	* @param
+	*	node The node
+	* @param
+	*	origin The ray origins, one register per axis
+	* @param
+	*	invDirection The inverse ray directions, one register per axis
+	* @param
+	*	tMin The start of each ray
+	* @param
+	*	tMax The end of each ray
+	* @return
+	*	unsigned int A bit per lane that overlaps the node
+	*/
+	inline unsigned int BVH::intersectNodePacket(const BVHNode& node, const PacketFloat* origin, const PacketFloat* invDirection, PacketFloat tMin, PacketFloat tMax)
+	{
+		for(unsigned int axis = 0; axis < 3; ++axis)
+		{
+			PacketFloat t0 = (PacketSplat(node.min[axis]) - origin[axis]) * invDirection[axis];
+			PacketFloat t1 = (PacketSplat(node.max[axis]) - origin[axis]) * invDirection[axis];
+			tMin = PacketMax(tMin, PacketMin(t0, t1));
+			tMax = PacketMin(tMax, PacketMax(t0, t1));
+		}
+		return PacketMoveMask(PacketLessEqual(tMin, tMax));
+	}
+
+	/** Walk the leaves a ray passes through, nearest first. Nodes beyond tMax are skipped, and
+	*	tMax is read again after every leaf, so a test that shortens it on a hit prunes the rest
+	*	of the walk
+	* @param
+	*	ray The ray
+	* @param
+	*	tMax The far end of the ray, usually the distance of the closest hit so far
+	* @param
+	*	leafTest Called with each primitive index in a reached leaf, returns true to stop
+	*/
+	template <typename LeafTest>
+	void BVH::traverse(const Ray& ray, const float& tMax, LeafTest leafTest) const
+	{
+		traverseLeaves(ray, tMax, [&](unsigned int first, unsigned int count)
+		{
+			for(unsigned int i = 0; i < count; ++i)
+			{
+				if(leafTest(_indices[first + i]) == true)
+				{
+					return true;
+				}
+			}
+			return false;
+		});
+	}
+
+	/** Walk the leaves a ray passes through, nearest first, like traverse but handing over each
+	*	leaf whole so its primitives can be tested together
+	* @param
+	*	ray The ray
+	* @param
+	*	tMax The far end of the ray, usually the distance of the closest hit so far
+	* @param
+	*	leafTest Called with the position of a reached leaf's first primitive in getIndices and
+	*	its primitive count, returns true to stop
+	*/
+	template <typename LeafTest>
+	void BVH::traverseLeaves(const Ray& ray, const float& tMax, LeafTest leafTest) const
+	{
+		if(_nodes.empty() == true)
+		{
+			return;
+		}
+
+		const Vector3& o = ray.getOrigin();
+		const Vector3& d = ray.getInvDirection();
+		float origin[3] = { o.getX(), o.getY(), o.getZ() };
+		float invDirection[3] = { d.getX(), d.getY(), d.getZ() };
+		float tMin = ray.getTMin();
+
+		// Far children waiting to be visited, with the distance at which the ray enters them
+		unsigned int stack[MaxDepth];
+		float stackNear[MaxDepth];
+		unsigned int stackSize = 0;
+
+		float tNear;
+		if(intersectNode(_nodes[0], origin, invDirection, tMin, tMax, tNear) == false)
+		{
+			return;
+		}
+
+		unsigned int nodeIndex = 0;
+		while(true)
+		{
+			const BVHNode& node = _nodes[nodeIndex];
+			if(node.count > 0)
+			{
+				if(leafTest(node.leftFirst, node.count) == true)
+				{
+					return;
+				}
+			}
+			else
+			{
+				unsigned int left = node.leftFirst;
+				unsigned int right = left + 1;
+				float tLeft, tRight;
+				bool hitLeft = intersectNode(_nodes[left], origin, invDirection, tMin, tMax, tLeft);
+				bool hitRight = intersectNode(_nodes[right], origin, invDirection, tMin, tMax, tRight);
+
+				if(hitLeft == true && hitRight == true)
+				{
+					// Visit the nearer child first so hits found there cull the other one
+					if(tRight < tLeft)
+					{
+						unsigned int n = left;
+						left = right;
+						right = n;
+						tRight = tLeft;
+					}
+					stack[stackSize] = right;
+					stackNear[stackSize] = tRight;
+					++stackSize;
+					nodeIndex = left;
+					continue;
+				}
+				if(hitLeft == true)
+				{
+					nodeIndex = left;
+					continue;
+				}
+				if(hitRight == true)
+				{
+					nodeIndex = right;
+					continue;
+				}
+			}
+
+			// Pop the next far child that still lies within the ray
+			bool found = false;
+			while(stackSize > 0)
+			{
+				--stackSize;
+				if(stackNear[stackSize] <= tMax)
+				{
+					nodeIndex = stack[stackSize];
+					found = true;
+					break;
+				}
+			}
+			if(found == false)
+			{
+				return;
+			}
+		}
+	}
+
+	/** Walk the leaves a ray passes through in no particular order until a leaf test reports a
+	*	hit. Cheaper per node than traverse since children are not sorted, for occlusion queries
+	*	where any hit will do
+	* @param
+	*	ray The ray, only nodes within [tMin, tMax] are visited
+	* @param
+	*	leafTest Called with each primitive index in a reached leaf, returns true on a hit
+	* @return
+	*	bool True if a leaf test reported a hit
+	*/
+	template <typename LeafTest>
+	bool BVH::traverseAny(const Ray& ray, LeafTest leafTest) const
+	{
+		if(_nodes.empty() == true)
+		{
+			return false;
+		}
+
+		const Vector3& o = ray.getOrigin();
+		const Vector3& d = ray.getInvDirection();
+		float origin[3] = { o.getX(), o.getY(), o.getZ() };
+		float invDirection[3] = { d.getX(), d.getY(), d.getZ() };
+		float tMin = ray.getTMin();
+		float tMax = ray.getTMax();
+
+		unsigned int stack[MaxDepth];
+		unsigned int stackSize = 0;
+
+		float tNear;
+		if(intersectNode(_nodes[0], origin, invDirection, tMin, tMax, tNear) == false)
+		{
+			return false;
+		}
+
+		unsigned int nodeIndex = 0;
+		while(true)
+		{
+			const BVHNode& node = _nodes[nodeIndex];
+			if(node.count > 0)
+			{
+				for(unsigned int i = 0; i < node.count; ++i)
+				{
+					if(leafTest(_indices[node.leftFirst + i]) == true)
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				unsigned int left = node.leftFirst;
+				bool hitLeft = intersectNode(_nodes[left], origin, invDirection, tMin, tMax, tNear);
+				bool hitRight = intersectNode(_nodes[left + 1], origin, invDirection, tMin, tMax, tNear);
+				if(hitLeft == true)
+				{
+					if(hitRight == true)
+					{
+						stack[stackSize++] = left + 1;
+					}
+					nodeIndex = left;
+					continue;
+				}
+				if(hitRight == true)
+				{
+					nodeIndex = left + 1;
+					continue;
+				}
+			}
+
+			if(stackSize == 0)
+			{
+				return false;
+			}
+			nodeIndex = stack[--stackSize];
+		}
+	}
+
+	/** Walk the leaves a packet of rays passes through. Each node is tested across every lane
+	*	still active below it, and lanes that miss a node drop out of its subtree. Children are
+	*	ordered by the direction of the first active ray, which suits coherent packets. tMax is
+	*	read again at every node
+	* @param
+	*	packet The rays
+	* @param
+	*	mask The lanes to trace, a bit per lane
+	* @param
+	*	tMax The far end of each lane, usually the distance of the closest hit so far
+	* @param
+	*	leafTest Called with each primitive index in a reached leaf and the lanes that reached
+	*	it, returns true to stop
+	*/
+	template <typename LeafTest>
+	void BVH::traversePacket(const RayPacket& packet, unsigned int mask, const float* tMax, LeafTest leafTest) const
+	{
+		traversePacketLeaves(packet, mask, tMax, [&](unsigned int first, unsigned int count, unsigned int leafMask)
+		{
+			for(unsigned int i = 0; i < count; ++i)
+			{
+				if(leafTest(_indices[first + i], leafMask) == true)
+				{
+					return true;
+				}
+			}
+			return false;
+		});
+	}
+
+	/** Walk the leaves a packet of rays passes through like traversePacket, handing over each
+	*	leaf whole
+	* @param
+	*	packet The rays
+	* @param
+	*	mask The lanes to trace, a bit per lane
+	* @param
+	*	tMax The far end of each lane, usually the distance of the closest hit so far
+	* @param
+	*	leafTest Called with the position of a reached leaf's first primitive in getIndices, its
+	*	primitive count and the lanes that reached it, returns true to stop
+	*/
+	template <typename LeafTest>
+	void BVH::traversePacketLeaves(const RayPacket& packet, unsigned int mask, const float* tMax, LeafTest leafTest) const
+	{
+		if(_nodes.empty() == true || mask == 0)
+		{
+			return;
+		}
+
+		PacketFloat origin[3] = { PacketLoad(packet.originX), PacketLoad(packet.originY), PacketLoad(packet.originZ) };
+		PacketFloat invDirection[3] = { PacketLoad(packet.invDirectionX), PacketLoad(packet.invDirectionY), PacketLoad(packet.invDirectionZ) };
+		PacketFloat tMin = PacketLoad(packet.tMin);
+
+		// The first active ray stands in for the packet when choosing which child to visit first
+		unsigned int first = 0;
+		while((mask & (1u << first)) == 0)
+		{
+			++first;
+		}
+		float direction[3] = { packet.directionX[first], packet.directionY[first], packet.directionZ[first] };
+
+		// Far children waiting to be visited, with the lanes that reached their parent
+		unsigned int stack[MaxDepth];
+		unsigned int stackMask[MaxDepth];
+		unsigned int stackSize = 0;
+
+		unsigned int nodeIndex = 0;
+		unsigned int nodeMask = mask;
+		while(true)
+		{
+			const BVHNode& node = _nodes[nodeIndex];
+			ST_STATS_ADD(numNodeTests, CountLanes(nodeMask));
+			nodeMask &= intersectNodePacket(node, origin, invDirection, tMin, PacketLoad(tMax));
+			if(nodeMask != 0)
+			{
+				if(node.count > 0)
+				{
+					if(leafTest(node.leftFirst, node.count, nodeMask) == true)
+					{
+						return;
+					}
+				}
+				else
+				{
+					// The child whose center lies further along the ray is visited second
+					const BVHNode& left = _nodes[node.leftFirst];
+					const BVHNode& right = _nodes[node.leftFirst + 1];
+					float order = 0.0f;
+					for(unsigned int axis = 0; axis < 3; ++axis)
+					{
+						order += (left.min[axis] + left.max[axis] - right.min[axis] - right.max[axis]) * direction[axis];
+					}
+					unsigned int near = order > 0.0f ? node.leftFirst + 1 : node.leftFirst;
+
+					stack[stackSize] = near == node.leftFirst ? node.leftFirst + 1 : node.leftFirst;
+					stackMask[stackSize] = nodeMask;
+					++stackSize;
+					nodeIndex = near;
+					continue;
+				}
+			}
+
+			if(stackSize == 0)
+			{
+				return;
+			}
+			--stackSize;
+			nodeIndex = stack[stackSize];
+			nodeMask = stackMask[stackSize];
+		}
+	}
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STBVH_H__
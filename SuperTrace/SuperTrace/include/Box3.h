@@ -25,10 +25,38 @@ namespace SuperTrace
 		/** Test for an intersection between a ray and this box
 		* @param
 		*	ray The ray to test against intersection
+		* @param
+		*	hit The closest hit so far, overwritten if the box is hit nearer than hit.t
 		* @return
 		*	bool True if intersection is found, false otherwise
 		*/
-		bool intersect(const Ray& ray) const;
+		bool intersect(const Ray& ray, HitRecord& hit) const;
+
+		/** Test the active lanes of a ray packet for intersection
+		* @param
+		*	packet The rays to test
+		* @param
+		*	mask The lanes to test, a bit per lane
+		* @param
+		*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+		* @return
+		*	unsigned int The lanes whose hit was overwritten
+		*/
+		unsigned int intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const;
+
+		/** Calculate the surface normal for a given contact point
+		* @param
+		*	surfacePoint The surface point at which to construct a normal
+		* @return
+		*	Vector3 The normal of the face nearest to the point
+		*/
+		Vector3 getSurfaceNormal(const Vector3& surfacePoint) const;
+
+		/** Get the world space bounds of the box
+		* @return
+		*	AABB The box itself
+		*/
+		AABB getBounds() const;
 
 	private:
 		/** Bounds of our box
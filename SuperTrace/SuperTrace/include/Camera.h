@@ -7,6 +7,7 @@
 #define __STCAMERA_H__
 
 #include "Ray.h"
+#include "RayPacket.h"
 
 namespace SuperTrace
 {
@@ -27,7 +28,7 @@ namespace SuperTrace
 		* @param
 		*	height The view plane height
 		* @param
-		*	fov The viewing angle for this camera
+		*	fov The tangent of half the vertical viewing angle
 		*/
 		Camera(unsigned int width, unsigned int height, float fov);
 
@@ -55,6 +56,30 @@ namespace SuperTrace
 		*/
 		const Vector3& getForward() const;
 
+		/** Set the up direction of the camera, it need not be perpendicular to the forward
+		* @param
+		*	v The new up direction
+		*/
+		void setUp(const Vector3& v);
+
+		/** Get the up direction of the camera
+		* @return
+		*	Vector3 The up direction
+		*/
+		const Vector3& getUp() const;
+
+		/** Set the field of view
+		* @param
+		*	fov The tangent of half the vertical viewing angle
+		*/
+		void setFieldOfView(float fov);
+
+		/** Get the field of view
+		* @return
+		*	float The tangent of half the vertical viewing angle
+		*/
+		float getFieldOfView() const;
+
 		/** Given a raster position on the screen, return a view ray
 		* @param
 		*	x The x raster position
@@ -65,6 +90,39 @@ namespace SuperTrace
 		*/
 		Ray rasterToRay(unsigned int x, unsigned int y) const;
 
+		/** Generate the view rays of a block of pixels, row by row
+		* @param
+		*	x The raster x of the first pixel
+		* @param
+		*	y The raster y of the first pixel
+		* @param
+		*	width The number of pixels in each row
+		* @param
+		*	height The number of rows
+		* @param
+		*	origins Receives width * height ray origins, row major
+		* @param
+		*	directions Receives width * height normalized ray directions, row major
+		*/
+		void generateRays(unsigned int x, unsigned int y, unsigned int width, unsigned int height, Vector3* origins, Vector3* directions) const;
+
+		/** Generate a packet of view rays for consecutive pixels along a row
+		* @param
+		*	x The raster x of the first pixel
+		* @param
+		*	y The raster y of the row
+		* @param
+		*	count The number of pixels, at most PacketWidth
+		* @param
+		*	packet Receives the rays in lanes 0 to count - 1, the lanes after them repeat the last ray
+		*/
+		void generatePacket(unsigned int x, unsigned int y, unsigned int count, RayPacket& packet) const;
+
+	private:
+		/** Recompute the raster to world mapping, called whenever the view changes
+		*/
+		void updateRasterMapping();
+
 	private:
 		/** Width of the view plane
 		*/
@@ -78,7 +136,7 @@ namespace SuperTrace
 		*/
 		float _aspectRatio;
 
-		/** Field of view
+		/** Tangent of half the vertical viewing angle
 		*/
 		float _fov;
 
@@ -89,6 +147,19 @@ namespace SuperTrace
 		/** Forward view direction of the camera
 		*/
 		Vector3 _forward;
+
+		/** Up direction of the camera
+		*/
+		Vector3 _up;
+
+		/** Unnormalized direction through the center of pixel (0, 0)
+		*/
+		Vector3 _rasterOrigin;
+
+		/** Change in direction from one pixel to the next along a row, and from one row to the next
+		*/
+		Vector3 _rasterDx;
+		Vector3 _rasterDy;
 	};
 
 	/** @} */
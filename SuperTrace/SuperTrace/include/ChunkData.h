@@ -13,11 +13,21 @@ namespace SuperTrace
         ChunkData();
 
         /** Constructor
+        * @param
+        *   startX The first raster column of the chunk
+        * @param
+        *   startY The first raster row of the chunk
+        * @param
+        *   width The width of the chunk in pixels
+        * @param
+        *   height The height of the chunk in pixels
         */
-        ChunkData(unsigned int startX, unsigned int startY);
+        ChunkData(unsigned int startX, unsigned int startY, unsigned int width, unsigned int height);
 
         unsigned int _startX;
         unsigned int _startY;
+        unsigned int _width;
+        unsigned int _height;
     };
 }
 
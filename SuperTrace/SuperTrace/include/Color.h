@@ -23,6 +23,14 @@ namespace SuperTrace
 			:	r(inR), g(inG), b(inB)
 		{ }
 
+		Color& operator+=(const Color& c)
+		{
+			r += c.r;
+			g += c.g;
+			b += c.b;
+			return *this;
+		}
+
 		float r;
 		float g;
 		float b;
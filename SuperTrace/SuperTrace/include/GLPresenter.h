@@ -0,0 +1,68 @@
+//*************************************************************************************************
+// Title: GLPresenter.h
+// Description: Presents dirty rectangles of the frame to a WGL window with glDrawPixels.
+//*************************************************************************************************
+#ifndef __STGLPRESENTER_H__
+#define __STGLPRESENTER_H__
+
+#include <windows.h>
+#include "Presenter.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	class GLPresenter : public Presenter
+	{
+	public:
+		/** Constructor
+		* @param
+		*	hDC The device context of the window
+		* @param
+		*	hRC The GL context, it is made current on the present thread while a frame is shown
+		*/
+		GLPresenter(HDC hDC, HGLRC hRC);
+
+		/** Called on the thread that starts a render, before the present thread runs
+		* @param
+		*	width The image width
+		* @param
+		*	height The image height
+		* @param
+		*	pixels The frame buffer, RGB floats stored bottom up
+		*/
+		virtual void begin(unsigned int width, unsigned int height, const float* pixels);
+
+		/** Make the GL context current on the present thread
+		*/
+		virtual void attach();
+
+		/** Release the GL context so the next render can claim it
+		*/
+		virtual void detach();
+
+	protected:
+		/** Upload a rectangle of the frame buffer
+		* @param
+		*	rect The rectangle, in image coordinates with y pointing down
+		*/
+		virtual void uploadRect(const RenderData& rect);
+
+		/** Submit the uploads to the driver
+		*/
+		virtual void flush();
+
+	private:
+		/** Render context values
+		*/
+		HDC _hDC;
+		HGLRC _hRC;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STGLPRESENTER_H__
@@ -0,0 +1,63 @@
+//*************************************************************************************************
+// Title: HeadlessPresenter.h
+// Description: Presents dirty rectangles into a frame buffer in memory, for running without a
+//	window or GPU.
+//*************************************************************************************************
+#ifndef __STHEADLESSPRESENTER_H__
+#define __STHEADLESSPRESENTER_H__
+
+#include <mutex>
+#include <vector>
+#include "Presenter.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	class HeadlessPresenter : public Presenter
+	{
+	public:
+		/** Default constructor
+		*/
+		HeadlessPresenter();
+
+		/** Called on the thread that starts a render, before the present thread runs
+		* @param
+		*	width The image width
+		* @param
+		*	height The image height
+		* @param
+		*	pixels The frame buffer, RGB floats stored bottom up
+		*/
+		virtual void begin(unsigned int width, unsigned int height, const float* pixels);
+
+		/** Copy what has been presented so far, safe to call while the frame is being presented
+		* @param
+		*	pixels Receives the presented RGB floats, stored bottom up
+		*/
+		void copyFrame(std::vector<float>& pixels);
+
+	protected:
+		/** Copy a rectangle of the frame buffer into the presented frame
+		* @param
+		*	rect The rectangle, in image coordinates with y pointing down
+		*/
+		virtual void uploadRect(const RenderData& rect);
+
+	private:
+		/** Guards the presented frame
+		*/
+		std::mutex _frameMutex;
+
+		/** The presented frame
+		*/
+		std::vector<float> _frame;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STHEADLESSPRESENTER_H__
@@ -0,0 +1,75 @@
+//*************************************************************************************************
+// Title: HitRecord.h
+// Description: What an intersection test found, filled in by the object that was hit so shading
+//	never has to recompute the geometry.
+//*************************************************************************************************
+#ifndef __STHITRECORD_H__
+#define __STHITRECORD_H__
+
+#include <float.h>
+#include "Vector3.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	class Material;
+	class Object;
+
+	class HitRecord
+	{
+	public:
+		/** Constructor
+		* @param
+		*	tMax The far end of the ray, only hits closer than this are accepted
+		*/
+		explicit HitRecord(float tMax = FLT_MAX)
+			:	t(tMax), primitive(InvalidPrimitive), object(0), material(0), u(0.0f), v(0.0f)
+		{ }
+
+		/** Check whether anything was hit
+		* @return
+		*	bool True once an intersection test has accepted a hit
+		*/
+		bool isHit() const
+		{
+			return object != 0;
+		}
+
+		/** Primitive id of a record that has not hit anything
+		*/
+		static const unsigned int InvalidPrimitive = 0xffffffff;
+
+		/** Distance along the ray to the closest hit so far, tests only accept hits nearer than this
+		*/
+		float t;
+
+		/** Index of the hit primitive in the scene
+		*/
+		unsigned int primitive;
+
+		/** The object that was hit, 0 if the ray hit nothing
+		*/
+		const Object* object;
+
+		/** Material of the surface that was hit, objects holding many primitives may give each its own
+		*/
+		const Material* material;
+
+		/** Unit geometric normal at the hit, facing out of the object
+		*/
+		Vector3 normal;
+
+		/** Surface parameterization of the hit
+		*/
+		float u;
+		float v;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STHITRECORD_H__
@@ -0,0 +1,94 @@
+//*************************************************************************************************
+// Title: ImageWriter.h
+// Description: Writes a rendered frame to disk. Frames are RGB floats stored bottom up, the way
+//	SceneRenderer fills them.
+//*************************************************************************************************
+#ifndef __STIMAGEWRITER_H__
+#define __STIMAGEWRITER_H__
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	// Supported output formats
+	enum ImageFormat
+	{
+		IMAGE_FORMAT_UNKNOWN = 0,
+		IMAGE_FORMAT_PPM,			// Binary 8 bit PPM (P6)
+		IMAGE_FORMAT_PFM,			// Little endian 32 bit float PFM (PF)
+		IMAGE_FORMAT_PNG			// 8 bit RGB PNG
+	};
+
+	/** Pick an image format from a file name
+	* @param
+	*	path The file name
+	* @return
+	*	ImageFormat The format matching the extension, IMAGE_FORMAT_UNKNOWN if none does
+	*/
+	ImageFormat ImageFormatFromPath(const char* path);
+
+	/** Write a frame in the given format
+	* @param
+	*	path The file to write
+	* @param
+	*	format The image format
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteImage(const char* path, ImageFormat format, unsigned int width, unsigned int height, const float* pixels);
+
+	/** Write a frame as a binary PPM, colors are clamped to [0, 1]
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePPM(const char* path, unsigned int width, unsigned int height, const float* pixels);
+
+	/** Write a frame as a PFM, keeping the full float range
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePFM(const char* path, unsigned int width, unsigned int height, const float* pixels);
+
+	/** Write a frame as an uncompressed PNG, colors are clamped to [0, 1]
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePNG(const char* path, unsigned int width, unsigned int height, const float* pixels);
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STIMAGEWRITER_H__
@@ -13,8 +13,10 @@ namespace SuperTrace
 	*/
 
 	class Color;
-	class Object;
+	class HitRecord;
 	class Ray;
+	class Scene;
+	struct RayStats;
 
 	class Light
 	{
@@ -37,9 +39,19 @@ namespace SuperTrace
 		*/
 		virtual ~Light();
 
-		/** Determine the color based on the object's properties
+		/** Determine the light's contribution to a surface point
+		* @param
+		*	scene The scene, queried for anything blocking the light
+		* @param
+		*	hit The closest hit of the ray
+		* @param
+		*	ray The ray that found the hit
+		* @param
+		*	stats Receives counts of the shadow rays cast
+		* @return
+		*	Color The reflected color
 		*/
-		virtual Color compute(const Object* obj, const Ray& ray) = 0;
+		virtual Color compute(const Scene& scene, const HitRecord& hit, const Ray& ray, RayStats& stats) const = 0;
 
 	protected:
 		/** Ambient properties
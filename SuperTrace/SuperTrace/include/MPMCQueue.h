@@ -0,0 +1,236 @@
+//*************************************************************************************************
+// Title: MPMCQueue.h
+// Description: A bounded lock-free multi-producer/multi-consumer ring buffer. Each slot carries a
+//	sequence number that tells producers and consumers whose turn it is, so pushing and popping
+//	cost one compare-and-swap and never take a lock or allocate.
+//*************************************************************************************************
+#ifndef __STMPMCQUEUE_H__
+#define __STMPMCQUEUE_H__
+
+#include <assert.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	template <typename T>
+	class MPMCQueue
+	{
+	public:
+		/** Default constructor, the queue has no capacity until reset is called
+		*/
+		MPMCQueue()
+			:	_cells(0), _mask(0), _enqueuePos(0), _dequeuePos(0)
+		{ }
+
+		/** Constructor
+		* @param
+		*	capacity The minimum number of elements the queue can hold
+		*/
+		explicit MPMCQueue(size_t capacity)
+			:	_cells(0), _mask(0), _enqueuePos(0), _dequeuePos(0)
+		{
+			reset(capacity);
+		}
+
+		/** Destructor
+		*/
+		~MPMCQueue()
+		{
+			delete[] _cells;
+		}
+
+		/** Empty the queue and resize it, must not be called while other threads use the queue
+		* @param
+		*	capacity The minimum number of elements the queue can hold, rounded up to a power of two
+		*/
+		void reset(size_t capacity)
+		{
+			size_t size = 2;
+			while(size < capacity)
+			{
+				size <<= 1;
+			}
+
+			if(size != _mask + 1)
+			{
+				delete[] _cells;
+				_cells = new Cell[size];
+				_mask = size - 1;
+			}
+
+			for(size_t i = 0; i < size; ++i)
+			{
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+			_enqueuePos.store(0, std::memory_order_relaxed);
+			_dequeuePos.store(0, std::memory_order_relaxed);
+		}
+
+		/** Get the capacity of the queue
+		* @return
+		*	size_t The number of elements the queue can hold
+		*/
+		size_t getCapacity() const
+		{
+			return _cells != 0 ? _mask + 1 : 0;
+		}
+
+		/** Try to push an element
+		* @param
+		*	value The element to push
+		* @return
+		*	bool False if the queue is full
+		*/
+		bool tryPush(const T& value)
+		{
+			if(_cells == 0)
+			{
+				return false;
+			}
+
+			Cell* cell;
+			size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+			while(true)
+			{
+				cell = &_cells[pos & _mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos);
+
+				if(diff == 0)
+				{
+					// The slot is free for this lap, claim it
+					if(_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) == true)
+					{
+						break;
+					}
+				}
+				else if(diff < 0)
+				{
+					// The slot still holds an element from the previous lap
+					return false;
+				}
+				else
+				{
+					// Another producer claimed the slot first
+					pos = _enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->value = value;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Try to pop an element
+		* @param
+		*	value Receives the popped element
+		* @return
+		*	bool False if the queue is empty
+		*/
+		bool tryPop(T& value)
+		{
+			if(_cells == 0)
+			{
+				return false;
+			}
+
+			Cell* cell;
+			size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+			while(true)
+			{
+				cell = &_cells[pos & _mask];
+				size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				ptrdiff_t diff = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1);
+
+				if(diff == 0)
+				{
+					// The slot has been published for this lap, claim it
+					if(_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) == true)
+					{
+						break;
+					}
+				}
+				else if(diff < 0)
+				{
+					// Nothing has been published here yet
+					return false;
+				}
+				else
+				{
+					// Another consumer claimed the slot first
+					pos = _dequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			value = cell->value;
+
+			// Hand the slot to the producer one lap ahead
+			cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Check whether the queue looks empty, exact only when no other thread is pushing or popping
+		* @return
+		*	bool True if no published element was found at the head of the queue
+		*/
+		bool isEmpty() const
+		{
+			if(_cells == 0)
+			{
+				return true;
+			}
+
+			size_t pos = _dequeuePos.load(std::memory_order_acquire);
+			size_t sequence = _cells[pos & _mask].sequence.load(std::memory_order_acquire);
+			return static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(pos + 1) < 0;
+		}
+
+	private:
+		// Copying would duplicate the ring
+		MPMCQueue(const MPMCQueue&);
+		MPMCQueue& operator=(const MPMCQueue&);
+
+		/** A slot in the ring
+		*/
+		struct Cell
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		// Keep the producer and consumer positions on separate cache lines
+		static const size_t CacheLineSize = 64;
+
+		/** The ring of cells
+		*/
+		Cell* _cells;
+
+		/** Capacity - 1, the capacity is a power of two
+		*/
+		size_t _mask;
+
+		char _pad0[CacheLineSize];
+
+		/** Next position to push to
+		*/
+		std::atomic<size_t> _enqueuePos;
+
+		char _pad1[CacheLineSize - sizeof(std::atomic<size_t>)];
+
+		/** Next position to pop from
+		*/
+		std::atomic<size_t> _dequeuePos;
+
+		char _pad2[CacheLineSize - sizeof(std::atomic<size_t>)];
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STMPMCQUEUE_H__
@@ -0,0 +1,442 @@
+//*************************************************************************************************
+// Title: MathKernels.h
+// Description: The kernels behind the vector and matrix classes, in a scalar form and an SSE/AVX
+//	form. The math classes use the SIMD form whenever the compiler targets SSE2 or better, unless
+//	ST_NO_SIMD is defined. Both forms stay callable by name so they can be compared.
+//*************************************************************************************************
+#ifndef __STMATHKERNELS_H__
+#define __STMATHKERNELS_H__
+
+#include <math.h>
+
+#if !defined(ST_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ST_SIMD_SSE 1
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define ST_SIMD_AVX 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace SuperTrace
+{
+	/** \addtogroup Math
+	*	@{
+	*/
+
+	/** Plain C++ kernels, the reference the SIMD kernels are checked against. Vectors are arrays of
+	*	4 floats, matrices arrays of 16 floats in row major order
+	*/
+	namespace ScalarMath
+	{
+		/** Dot product of the first three components
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @return
+		*	float The dot product
+		*/
+		inline float Dot3(const float* a, const float* b)
+		{
+			return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+		}
+
+		/** Cross product of the first three components, the fourth component of the result is 0
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @param
+		*	r Receives the cross product, may alias a or b
+		*/
+		inline void Cross3(const float* a, const float* b, float* r)
+		{
+			float x = a[1] * b[2] - a[2] * b[1];
+			float y = a[2] * b[0] - a[0] * b[2];
+			float z = a[0] * b[1] - a[1] * b[0];
+			r[0] = x;
+			r[1] = y;
+			r[2] = z;
+			r[3] = 0.0f;
+		}
+
+		/** Scale the first three components to unit length
+		* @param
+		*	v The vector to normalize
+		*/
+		inline void Normalize3(float* v)
+		{
+			float scale = 1.0f / sqrtf(Dot3(v, v));
+			v[0] *= scale;
+			v[1] *= scale;
+			v[2] *= scale;
+		}
+
+		/** Dot product of all four components
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @return
+		*	float The dot product
+		*/
+		inline float Dot4(const float* a, const float* b)
+		{
+			return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]);
+		}
+
+		/** Scale all four components to unit length
+		* @param
+		*	v The vector to normalize
+		*/
+		inline void Normalize4(float* v)
+		{
+			float scale = 1.0f / sqrtf(Dot4(v, v));
+			v[0] *= scale;
+			v[1] *= scale;
+			v[2] *= scale;
+			v[3] *= scale;
+		}
+
+		/** Multiply two matrices
+		* @param
+		*	a The left hand matrix
+		* @param
+		*	b The right hand matrix
+		* @param
+		*	r Receives a * b, may alias a or b
+		*/
+		inline void MultiplyMatrix44(const float* a, const float* b, float* r)
+		{
+			float t[16];
+			for(unsigned int i = 0; i < 4; ++i)
+			{
+				for(unsigned int j = 0; j < 4; ++j)
+				{
+					t[i * 4 + j] =	a[i * 4 + 0] * b[0 + j] +
+									a[i * 4 + 1] * b[4 + j] +
+									a[i * 4 + 2] * b[8 + j] +
+									a[i * 4 + 3] * b[12 + j];
+				}
+			}
+			for(unsigned int i = 0; i < 16; ++i)
+			{
+				r[i] = t[i];
+			}
+		}
+
+		/** Invert a matrix through its 2x2 sub determinants
+		* @param
+		*	m The matrix to invert
+		* @param
+		*	r Receives the inverse, may alias m. Not finite if m is singular
+		* @return
+		*	float The determinant of m
+		*/
+		inline float InverseMatrix44(const float* m, float* r)
+		{
+			// Determinants of the 2x2 blocks from the top two rows and from the bottom two rows
+			float s0 = m[0] * m[5] - m[4] * m[1];
+			float s1 = m[0] * m[6] - m[4] * m[2];
+			float s2 = m[0] * m[7] - m[4] * m[3];
+			float s3 = m[1] * m[6] - m[5] * m[2];
+			float s4 = m[1] * m[7] - m[5] * m[3];
+			float s5 = m[2] * m[7] - m[6] * m[3];
+
+			float c5 = m[10] * m[15] - m[14] * m[11];
+			float c4 = m[9] * m[15] - m[13] * m[11];
+			float c3 = m[9] * m[14] - m[13] * m[10];
+			float c2 = m[8] * m[15] - m[12] * m[11];
+			float c1 = m[8] * m[14] - m[12] * m[10];
+			float c0 = m[8] * m[13] - m[12] * m[9];
+
+			float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			float inv = 1.0f / det;
+
+			float t[16];
+			t[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) * inv;
+			t[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * inv;
+			t[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) * inv;
+			t[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * inv;
+
+			t[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * inv;
+			t[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) * inv;
+			t[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv;
+			t[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) * inv;
+
+			t[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) * inv;
+			t[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * inv;
+			t[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) * inv;
+			t[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * inv;
+
+			t[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * inv;
+			t[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) * inv;
+			t[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv;
+			t[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) * inv;
+
+			for(unsigned int i = 0; i < 16; ++i)
+			{
+				r[i] = t[i];
+			}
+			return det;
+		}
+	}
+
+#ifdef ST_SIMD_SSE
+	/** SSE kernels, with AVX matrix products where the target allows. Dot products sum with
+	*	shuffles rather than dpps, which measured slower. Loads and stores are unaligned, so any
+	*	float array of the right size will do
+	*/
+	namespace SimdMath
+	{
+		/** Broadcast one lane of a register to all four
+		*/
+		#define ST_SPLAT(v, i) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+		/** Sum the first three lanes into every lane
+		*/
+		inline __m128 HorizontalSum3(__m128 v)
+		{
+			__m128 s = _mm_add_ss(v, ST_SPLAT(v, 1));
+			s = _mm_add_ss(s, _mm_movehl_ps(v, v));
+			return ST_SPLAT(s, 0);
+		}
+
+		/** Sum all four lanes into every lane
+		*/
+		inline __m128 HorizontalSum4(__m128 v)
+		{
+			__m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+			s = _mm_add_ss(s, ST_SPLAT(s, 1));
+			return ST_SPLAT(s, 0);
+		}
+
+		/** Dot product of the first three components
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @return
+		*	float The dot product
+		*/
+		inline float Dot3(const float* a, const float* b)
+		{
+			__m128 va = _mm_loadu_ps(a);
+			__m128 vb = _mm_loadu_ps(b);
+			return _mm_cvtss_f32(HorizontalSum3(_mm_mul_ps(va, vb)));
+		}
+
+		/** Cross product of the first three components, the fourth component of the result is 0
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @param
+		*	r Receives the cross product, may alias a or b
+		*/
+		inline void Cross3(const float* a, const float* b, float* r)
+		{
+			__m128 va = _mm_loadu_ps(a);
+			__m128 vb = _mm_loadu_ps(b);
+
+			// a * b.yzx - a.yzx * b gives the cross product in zxy order
+			__m128 aYZX = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 bYZX = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+			__m128 c = _mm_sub_ps(_mm_mul_ps(va, bYZX), _mm_mul_ps(aYZX, vb));
+			c = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+
+			// Clear the fourth lane in case the inputs carried something there
+			c = _mm_and_ps(c, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+			_mm_storeu_ps(r, c);
+		}
+
+		/** Scale the first three components to unit length, the fourth component is left as is
+		* @param
+		*	v The vector to normalize
+		*/
+		inline void Normalize3(float* v)
+		{
+			__m128 vv = _mm_loadu_ps(v);
+			__m128 lengthSqr = HorizontalSum3(_mm_mul_ps(vv, vv));
+			// The fourth lane divides by 1 so it comes back unchanged
+			__m128 length = _mm_move_ss(_mm_sqrt_ps(lengthSqr), _mm_set_ss(1.0f));
+			length = _mm_shuffle_ps(length, length, _MM_SHUFFLE(0, 1, 1, 1));
+			_mm_storeu_ps(v, _mm_div_ps(vv, length));
+		}
+
+		/** Dot product of all four components
+		* @param
+		*	a The first vector
+		* @param
+		*	b The second vector
+		* @return
+		*	float The dot product
+		*/
+		inline float Dot4(const float* a, const float* b)
+		{
+			__m128 va = _mm_loadu_ps(a);
+			__m128 vb = _mm_loadu_ps(b);
+			return _mm_cvtss_f32(HorizontalSum4(_mm_mul_ps(va, vb)));
+		}
+
+		/** Scale all four components to unit length
+		* @param
+		*	v The vector to normalize
+		*/
+		inline void Normalize4(float* v)
+		{
+			__m128 vv = _mm_loadu_ps(v);
+			__m128 lengthSqr = HorizontalSum4(_mm_mul_ps(vv, vv));
+			_mm_storeu_ps(v, _mm_div_ps(vv, _mm_sqrt_ps(lengthSqr)));
+		}
+
+		/** Multiply two matrices
+		* @param
+		*	a The left hand matrix
+		* @param
+		*	b The right hand matrix
+		* @param
+		*	r Receives a * b, may alias a or b
+		*/
+		inline void MultiplyMatrix44(const float* a, const float* b, float* r)
+		{
+			// Each row of the result is the rows of b weighted by the matching row of a
+#ifdef ST_SIMD_AVX
+			// Two rows at a time, every row of b is repeated in both halves of a register
+			__m256 b0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b)), _mm_loadu_ps(b), 1);
+			__m256 b1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 4)), _mm_loadu_ps(b + 4), 1);
+			__m256 b2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 8)), _mm_loadu_ps(b + 8), 1);
+			__m256 b3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(b + 12)), _mm_loadu_ps(b + 12), 1);
+			__m256 a01 = _mm256_loadu_ps(a);
+			__m256 a23 = _mm256_loadu_ps(a + 8);
+
+			__m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xaa), b2));
+			r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xff), b3));
+
+			__m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xaa), b2));
+			r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xff), b3));
+
+			_mm256_storeu_ps(r, r01);
+			_mm256_storeu_ps(r + 8, r23);
+#else
+			__m128 b0 = _mm_loadu_ps(b);
+			__m128 b1 = _mm_loadu_ps(b + 4);
+			__m128 b2 = _mm_loadu_ps(b + 8);
+			__m128 b3 = _mm_loadu_ps(b + 12);
+
+			// A row of a is read before the same row of r is written, so r may alias a
+			for(unsigned int i = 0; i < 4; ++i)
+			{
+				__m128 row = _mm_loadu_ps(a + i * 4);
+				__m128 sum = _mm_mul_ps(ST_SPLAT(row, 0), b0);
+				sum = _mm_add_ps(sum, _mm_mul_ps(ST_SPLAT(row, 1), b1));
+				sum = _mm_add_ps(sum, _mm_mul_ps(ST_SPLAT(row, 2), b2));
+				sum = _mm_add_ps(sum, _mm_mul_ps(ST_SPLAT(row, 3), b3));
+				_mm_storeu_ps(r + i * 4, sum);
+			}
+#endif
+		}
+
+		/** Product of two 2x2 matrices held row major in one register
+		*/
+		inline __m128 Multiply2x2(__m128 a, __m128 b)
+		{
+			return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+
+		/** Product of the adjugate of a 2x2 matrix with another
+		*/
+		inline __m128 AdjugateMultiply2x2(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+		}
+
+		/** Product of a 2x2 matrix with the adjugate of another
+		*/
+		inline __m128 MultiplyAdjugate2x2(__m128 a, __m128 b)
+		{
+			return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+				_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+		}
+
+		/** Invert a matrix blockwise, treating it as four 2x2 matrices
+		* @param
+		*	m The matrix to invert
+		* @param
+		*	r Receives the inverse, may alias m. Not finite if m is singular
+		* @return
+		*	float The determinant of m
+		*/
+		inline float InverseMatrix44(const float* m, float* r)
+		{
+			__m128 row0 = _mm_loadu_ps(m);
+			__m128 row1 = _mm_loadu_ps(m + 4);
+			__m128 row2 = _mm_loadu_ps(m + 8);
+			__m128 row3 = _mm_loadu_ps(m + 12);
+
+			// The blocks |A B|
+			//            |C D|
+			__m128 A = _mm_movelh_ps(row0, row1);
+			__m128 B = _mm_movehl_ps(row1, row0);
+			__m128 C = _mm_movelh_ps(row2, row3);
+			__m128 D = _mm_movehl_ps(row3, row2);
+
+			// Determinants of the blocks as (|A|, |B|, |C|, |D|)
+			__m128 detSub = _mm_sub_ps(
+				_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+				_mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))));
+			__m128 detA = ST_SPLAT(detSub, 0);
+			__m128 detB = ST_SPLAT(detSub, 1);
+			__m128 detC = ST_SPLAT(detSub, 2);
+			__m128 detD = ST_SPLAT(detSub, 3);
+
+			// The inverse is 1 / |M| times the adjugates of X, Y, Z and W, where
+			//	X# = |D|A - B(D#C), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#, W# = |A|D - C(A#B)
+			__m128 DC = AdjugateMultiply2x2(D, C);
+			__m128 AB = AdjugateMultiply2x2(A, B);
+			__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Multiply2x2(B, DC));
+			__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Multiply2x2(C, AB));
+			__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), MultiplyAdjugate2x2(D, AB));
+			__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), MultiplyAdjugate2x2(A, DC));
+
+			// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+			__m128 trace = _mm_mul_ps(AB, _mm_shuffle_ps(DC, DC, _MM_SHUFFLE(3, 1, 2, 0)));
+			__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), HorizontalSum4(trace));
+
+			// The signs apply the adjugate to each block
+			__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+			X = _mm_mul_ps(X, invDet);
+			Y = _mm_mul_ps(Y, invDet);
+			Z = _mm_mul_ps(Z, invDet);
+			W = _mm_mul_ps(W, invDet);
+
+			// Transpose the adjugates back into rows
+			_mm_storeu_ps(r, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+			_mm_storeu_ps(r + 4, _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+			_mm_storeu_ps(r + 8, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+			_mm_storeu_ps(r + 12, _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+
+			return _mm_cvtss_f32(detM);
+		}
+
+		#undef ST_SPLAT
+	}
+
+	// The kernels the math classes use
+	namespace MathKernels = SimdMath;
+#else
+	namespace MathKernels = ScalarMath;
+#endif
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STMATHKERNELS_H__
@@ -6,6 +6,10 @@
 #ifndef __STMATRIX44_H__
 #define __STMATRIX44_H__
 
+#include <assert.h>
+#include <math.h>
+#include "MathKernels.h"
+
 namespace SuperTrace
 {
 	/** \addtogroup Math
@@ -17,7 +21,7 @@ namespace SuperTrace
 	public:
 		/** Default constructor
 		*/
-		Matrix44();
+		constexpr Matrix44();
 
 		/** Constructor from array
 		* @param
@@ -29,36 +33,18 @@ namespace SuperTrace
 		* @param
 		*	m00..m33 -> floating point values for each row-column value
 		*/
-		Matrix44(	float m00, float m01, float m02, float m03,
+		constexpr Matrix44(	float m00, float m01, float m02, float m03,
 					float m10, float m11, float m12, float m13,
 					float m20, float m21, float m22, float m23,
 					float m30, float m31, float m32, float m33);
 
-		/** Copy constructor
-		* @param
-		*	m The matrix to copy
-		*/
-		Matrix44(const Matrix44& m);
-
-		/** Destructor
-		*/
-		~Matrix44();
-
-		/** Assignment operator
-		* @param
-		*	m The matrix to copy over
-		* @return
-		*	Matrix44& The reference to the assigned matrix
-		*/
-		Matrix44& operator=(const Matrix44& m);
-
 		/** Multiplication operator
 		* @param
 		*	m The right-hand matrix in the multiplication
 		* @return
 		*	Matrix44 The resultant matrix
 		*/
-		Matrix44 operator*(const Matrix44& m);
+		Matrix44 operator*(const Matrix44& m) const;
 
 		/** Multiplication operator
 		* @param
@@ -134,11 +120,167 @@ namespace SuperTrace
 		};
 	};
 
+	/** Default constructor
+	*/
+	constexpr Matrix44::Matrix44()
+		:	_m00(0.0f), _m01(0.0f), _m02(0.0f), _m03(0.0f),
+			_m10(0.0f), _m11(0.0f), _m12(0.0f), _m13(0.0f),
+			_m20(0.0f), _m21(0.0f), _m22(0.0f), _m23(0.0f),
+			_m30(0.0f), _m31(0.0f), _m32(0.0f), _m33(0.0f)
+	{ }
+
+	/** Constructor from array
+	* @param
+	*	f An array of 16 floating point values
+	*/
+	inline Matrix44::Matrix44(const float* f)
+		:	_m00(f[0]), _m01(f[1]), _m02(f[2]), _m03(f[3]),
+			_m10(f[4]), _m11(f[5]), _m12(f[6]), _m13(f[7]),
+			_m20(f[8]), _m21(f[9]), _m22(f[10]), _m23(f[11]),
+			_m30(f[12]), _m31(f[13]), _m32(f[14]), _m33(f[15])
+	{ }
+
+	/** Constructor from individual values
+	* @param
+	*	m00..m33 -> floating point values for each row-column value
+	*/
+	constexpr Matrix44::Matrix44(	float m00, float m01, float m02, float m03,
+				float m10, float m11, float m12, float m13,
+				float m20, float m21, float m22, float m23,
+				float m30, float m31, float m32, float m33)
+		:	_m00(m00), _m01(m01), _m02(m02), _m03(m03),
+			_m10(m10), _m11(m11), _m12(m12), _m13(m13),
+			_m20(m20), _m21(m21), _m22(m22), _m23(m23),
+			_m30(m30), _m31(m31), _m32(m32), _m33(m33)
+	{ }
+
+	/** Multiplication operator
+	* @param
+	*	m The right-hand matrix in the multiplication
+	* @return
+	*	Matrix44 The resultant matrix
+	*/
+	inline Matrix44 Matrix44::operator*(const Matrix44& m) const
+	{
+		Matrix44 r;
+		MathKernels::MultiplyMatrix44(_f, m._f, r._f);
+		return r;
+	}
+
+	/** Multiplication operator
+	* @param
+	*	m The right-hand matrix in the multiplication
+	* @return
+	*	Matrix44& The resultant matrix
+	*/
+	inline Matrix44& Matrix44::operator*=(const Matrix44& m)
+	{
+		MathKernels::MultiplyMatrix44(_f, m._f, _f);
+		return *this;
+	}
+
+	/** Access operator
+	* @param
+	*	row	The row index
+	* @param
+	*	column The column index
+	* @return
+	*	float The corresponding value
+	*/
+	inline float Matrix44::operator()(int row, int column) const
+	{
+		assert(row > -1 && row < 4 && column > -1 && column < 4);
+		return _m[row][column];
+	}
+
+	/** Access operator
+	* @param
+	*	row	The row index
+	* @param
+	*	column The column index
+	* @return
+	*	float The corresponding value
+	*/
+	inline float Matrix44::operator()(unsigned int row, unsigned int column) const
+	{
+		assert(row < 4 && column < 4);
+		return _m[row][column];
+	}
+
+	/** Set this matrix to identity
+	*/
+	inline void Matrix44::setIdentity()
+	{
+		_m00 = 1.0f; _m01 = 0.0f; _m02 = 0.0f; _m03 = 0.0f;
+		_m10 = 0.0f; _m11 = 1.0f; _m12 = 0.0f; _m13 = 0.0f;
+		_m20 = 0.0f; _m21 = 0.0f; _m22 = 1.0f; _m23 = 0.0f;
+		_m30 = 0.0f; _m31 = 0.0f; _m32 = 0.0f; _m33 = 1.0f;
+	}
+
+	/** Transpose this matrix
+	*/
+	inline void Matrix44::transpose()
+	{
+		// Temp storage value
+		float t;
+		for(unsigned int i = 0; i < 4; ++i)
+		{
+			for(unsigned int j = i; j < 4; ++j)
+			{
+				// Swap values
+				t = _m[i][j];
+				_m[i][j] = _m[j][i];
+				_m[j][i] = t;
+			}
+		}
+	}
+
+	/** Return a transposed copy of this matrix
+	* @return
+	*	Matrix44 The transposed copy
+	*/
+	inline Matrix44 Matrix44::getTranspose() const
+	{
+		Matrix44 m;
+		for(unsigned int i = 0; i < 4; ++i)
+		{
+			for(unsigned int j = 0; j < 4; ++j)
+			{
+				m._m[i][j] = _m[j][i];
+			}
+		}
+		return m;
+	}
+
+	/** Invert this matrix
+	*/
+	inline void Matrix44::inverse()
+	{
+		MathKernels::InverseMatrix44(_f, _f);
+	}
+
+	/** Return the inverse of this matrix
+	* @return
+	*	Matrix44 The inverse of the matrix
+	*/
+	inline Matrix44 Matrix44::getInverse() const
+	{
+		Matrix44 r;
+		MathKernels::InverseMatrix44(_f, r._f);
+		return r;
+	}
+
 	/** Return an identity matrix
 	* @return
 	*	Matrix44 An identity matrix
 	*/
-	Matrix44 Matrix44Identity();
+	inline Matrix44 Matrix44Identity()
+	{
+		return Matrix44(1.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, 1.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 1.0f, 0.0f,
+						0.0f, 0.0f, 0.0f, 1.0f);
+	}
 
 	/** Return a translation matrix
 	* @param
@@ -150,7 +292,13 @@ namespace SuperTrace
 	* @return
 	*	Matrix44 A translation matrix
 	*/
-	Matrix44 Matrix44Translation(float tx, float ty, float tz);
+	inline Matrix44 Matrix44Translation(float tx, float ty, float tz)
+	{
+		return Matrix44(1.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, 1.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 1.0f, 0.0f,
+						tx, ty, tz, 1.0f);
+	}
 
 	/** Return a scaling matrix 
 	* @param
@@ -162,7 +310,13 @@ namespace SuperTrace
 	* @return
 	*	Matrix44 A scaling matrix
 	*/
-	Matrix44 Matrix44Scale(float sx, float sy, float sz);
+	inline Matrix44 Matrix44Scale(float sx, float sy, float sz)
+	{
+		return Matrix44(sx, 0.0f, 0.0f, 0.0f,
+						0.0f, sy, 0.0f, 0.0f,
+						0.0f, 0.0f, sz, 0.0f,
+						0.0f, 0.0f, 0.0f, 1.0f);
+	}
 
 	/** Return a x-axis rotation matrix
 	* @param
@@ -170,7 +324,15 @@ namespace SuperTrace
 	* @return
 	*	Matrix44 The rotation matrix
 	*/
-	Matrix44 Matrix44RotationX(float rot);
+	inline Matrix44 Matrix44RotationX(float rot)
+	{
+		float cos = cosf(rot);
+		float sin = sinf(rot);
+		return Matrix44(1.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, cos, sin, 0.0f,
+						0.0f, -sin, cos, 0.0f,
+						0.0f, 0.0f, 0.0f, 1.0f);
+	}
 
 	/** Return a y-axis rotation matrix
 	* @param
@@ -178,7 +340,15 @@ namespace SuperTrace
 	* @return
 	*	Matrix44 The rotation matrix
 	*/
-	Matrix44 Matrix44RotationY(float rot);
+	inline Matrix44 Matrix44RotationY(float rot)
+	{
+		float cos = cosf(rot);
+		float sin = sinf(rot);
+		return Matrix44(cos, 0.0f, -sin, 0.0f,
+						0.0f, 1.0f, 0.0f, 0.0f,
+						sin, 0.0f, cos, 0.0f,
+						0.0f, 0.0f, 0.0f, 1.0f);
+	}
 
 	/** Return a z-axis rotation matrix
 	* @param
@@ -186,10 +356,18 @@ namespace SuperTrace
 	* @return
 	*	Matrix44 The rotation matrix
 	*/
-	Matrix44 Matrix44RotationZ(float rot);
+	inline Matrix44 Matrix44RotationZ(float rot)
+	{
+		float cos = cosf(rot);
+		float sin = sinf(rot);
+		return Matrix44(cos, sin, 0.0f, 0.0f,
+						-sin, cos, 0.0f, 0.0f,
+						0.0f, 0.0f, 1.0f, 0.0f,
+						0.0f, 0.0f, 0.0f, 1.0f);
+	}
 
 	/** @} */
 
 }	// Namespace
 
-#endif // __STMATRIX44_H__
\ No newline at end of file
+#endif // __STMATRIX44_H__
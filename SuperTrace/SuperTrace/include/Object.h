@@ -7,6 +7,7 @@
 #define __STOBJECT_H__
 
 #include "STMath.h"
+#include "AABB.h"
 #include "Color.h"
 #include "Material.h"
 
@@ -16,7 +17,10 @@ namespace SuperTrace
 	*	@{
 	*/
 
+	class HitPacket;
+	class HitRecord;
 	class Ray;
+	class RayPacket;
 	class Vector3;
 
 	class Object
@@ -34,11 +38,33 @@ namespace SuperTrace
 
 		/** Intersect test
 		* @param
-		*	ray The ray to test intersection again
+		*	ray The ray to test intersection against
 		* @param
-		*	intersectData The object that holds intersection data (point of contact, etc)
+		*	hit The closest hit so far, overwritten if this object is hit nearer than hit.t
+		* @return
+		*	bool True if the hit record was updated
+		*/
+		virtual bool intersect(const Ray& ray, HitRecord& hit) const = 0;
+
+		/** Any hit test, cheaper than intersect when only visibility matters
+		* @param
+		*	ray The ray to test, only hits within [tMin, tMax] count
+		* @return
+		*	bool True if the object blocks the ray
+		*/
+		virtual bool occludes(const Ray& ray) const;
+
+		/** Test the active lanes of a ray packet for intersection
+		* @param
+		*	packet The rays to test
+		* @param
+		*	mask The lanes to test, a bit per lane
+		* @param
+		*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+		* @return
+		*	unsigned int The lanes whose hit was overwritten
 		*/
-		virtual bool intersect(const Ray& ray) const = 0;
+		virtual unsigned int intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const;
 
 		/** Get the color
 		* @return
@@ -66,6 +92,12 @@ namespace SuperTrace
 		*/
 		virtual Vector3 getSurfaceNormal(const Vector3& surfacePoint) const = 0;
 
+		/** Get the world space bounds of the object
+		* @return
+		*	AABB A box containing the whole object
+		*/
+		virtual AABB getBounds() const = 0;
+
 	protected:
 		/** World matrix
 		*/
@@ -0,0 +1,122 @@
+//*************************************************************************************************
+// Title: PacketMath.h
+// Description: One float per ray of a packet, 8 lanes wide with AVX and 4 wide otherwise. Follows
+//	the same target selection as MathKernels.h, with a scalar form when SIMD is unavailable.
+//*************************************************************************************************
+#ifndef __STPACKETMATH_H__
+#define __STPACKETMATH_H__
+
+#include <math.h>
+#include "MathKernels.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Math
+	*	@{
+	*/
+
+#if defined(ST_SIMD_AVX)
+	/** Number of rays in a packet
+	*/
+	const unsigned int PacketWidth = 8;
+
+	/** Whether packet operations map to SIMD instructions, without them packets trace slower
+	*	than single rays
+	*/
+	const bool PacketHasSimd = true;
+
+	/** A value per packet lane, comparisons give lanes of all ones or all zeros
+	*/
+	struct PacketFloat
+	{
+		__m256 v;
+	};
+
+	inline PacketFloat PacketMake(__m256 v) { PacketFloat r; r.v = v; return r; }
+	inline PacketFloat PacketLoad(const float* f) { return PacketMake(_mm256_loadu_ps(f)); }
+	inline void PacketStore(float* f, PacketFloat a) { _mm256_storeu_ps(f, a.v); }
+	inline PacketFloat PacketSplat(float f) { return PacketMake(_mm256_set1_ps(f)); }
+	inline PacketFloat operator+(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_add_ps(a.v, b.v)); }
+	inline PacketFloat operator-(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_sub_ps(a.v, b.v)); }
+	inline PacketFloat operator*(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_mul_ps(a.v, b.v)); }
+	inline PacketFloat operator/(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_div_ps(a.v, b.v)); }
+	inline PacketFloat PacketMin(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_min_ps(a.v, b.v)); }
+	inline PacketFloat PacketMax(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_max_ps(a.v, b.v)); }
+	inline PacketFloat PacketSqrt(PacketFloat a) { return PacketMake(_mm256_sqrt_ps(a.v)); }
+	inline PacketFloat PacketLess(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+	inline PacketFloat PacketLessEqual(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)); }
+	inline PacketFloat PacketAnd(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_and_ps(a.v, b.v)); }
+	inline PacketFloat PacketOr(PacketFloat a, PacketFloat b) { return PacketMake(_mm256_or_ps(a.v, b.v)); }
+	inline PacketFloat PacketSelect(PacketFloat mask, PacketFloat a, PacketFloat b) { return PacketMake(_mm256_blendv_ps(b.v, a.v, mask.v)); }
+	inline unsigned int PacketMoveMask(PacketFloat mask) { return static_cast<unsigned int>(_mm256_movemask_ps(mask.v)); }
+#elif defined(ST_SIMD_SSE)
+	const unsigned int PacketWidth = 4;
+	const bool PacketHasSimd = true;
+
+	struct PacketFloat
+	{
+		__m128 v;
+	};
+
+	inline PacketFloat PacketMake(__m128 v) { PacketFloat r; r.v = v; return r; }
+	inline PacketFloat PacketLoad(const float* f) { return PacketMake(_mm_loadu_ps(f)); }
+	inline void PacketStore(float* f, PacketFloat a) { _mm_storeu_ps(f, a.v); }
+	inline PacketFloat PacketSplat(float f) { return PacketMake(_mm_set1_ps(f)); }
+	inline PacketFloat operator+(PacketFloat a, PacketFloat b) { return PacketMake(_mm_add_ps(a.v, b.v)); }
+	inline PacketFloat operator-(PacketFloat a, PacketFloat b) { return PacketMake(_mm_sub_ps(a.v, b.v)); }
+	inline PacketFloat operator*(PacketFloat a, PacketFloat b) { return PacketMake(_mm_mul_ps(a.v, b.v)); }
+	inline PacketFloat operator/(PacketFloat a, PacketFloat b) { return PacketMake(_mm_div_ps(a.v, b.v)); }
+	inline PacketFloat PacketMin(PacketFloat a, PacketFloat b) { return PacketMake(_mm_min_ps(a.v, b.v)); }
+	inline PacketFloat PacketMax(PacketFloat a, PacketFloat b) { return PacketMake(_mm_max_ps(a.v, b.v)); }
+	inline PacketFloat PacketSqrt(PacketFloat a) { return PacketMake(_mm_sqrt_ps(a.v)); }
+	inline PacketFloat PacketLess(PacketFloat a, PacketFloat b) { return PacketMake(_mm_cmplt_ps(a.v, b.v)); }
+	inline PacketFloat PacketLessEqual(PacketFloat a, PacketFloat b) { return PacketMake(_mm_cmple_ps(a.v, b.v)); }
+	inline PacketFloat PacketAnd(PacketFloat a, PacketFloat b) { return PacketMake(_mm_and_ps(a.v, b.v)); }
+	inline PacketFloat PacketOr(PacketFloat a, PacketFloat b) { return PacketMake(_mm_or_ps(a.v, b.v)); }
+	inline PacketFloat PacketSelect(PacketFloat mask, PacketFloat a, PacketFloat b) { return PacketMake(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))); }
+	inline unsigned int PacketMoveMask(PacketFloat mask) { return static_cast<unsigned int>(_mm_movemask_ps(mask.v)); }
+#else
+	const unsigned int PacketWidth = 4;
+	const bool PacketHasSimd = false;
+
+	/** Without SIMD a mask lane is 1.0f for true and 0.0f for false
+	*/
+	struct PacketFloat
+	{
+		float v[4];
+	};
+
+	inline PacketFloat PacketLoad(const float* f) { PacketFloat r; for(unsigned int i = 0; i < 4; ++i) { r.v[i] = f[i]; } return r; }
+	inline void PacketStore(float* f, PacketFloat a) { for(unsigned int i = 0; i < 4; ++i) { f[i] = a.v[i]; } }
+	inline PacketFloat PacketSplat(float f) { PacketFloat r; for(unsigned int i = 0; i < 4; ++i) { r.v[i] = f; } return r; }
+	inline PacketFloat operator+(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] += b.v[i]; } return a; }
+	inline PacketFloat operator-(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] -= b.v[i]; } return a; }
+	inline PacketFloat operator*(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] *= b.v[i]; } return a; }
+	inline PacketFloat operator/(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] /= b.v[i]; } return a; }
+	inline PacketFloat PacketMin(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; } return a; }
+	inline PacketFloat PacketMax(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; } return a; }
+	inline PacketFloat PacketSqrt(PacketFloat a) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = sqrtf(a.v[i]); } return a; }
+	inline PacketFloat PacketLess(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = a.v[i] < b.v[i] ? 1.0f : 0.0f; } return a; }
+	inline PacketFloat PacketLessEqual(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = a.v[i] <= b.v[i] ? 1.0f : 0.0f; } return a; }
+	inline PacketFloat PacketAnd(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = (a.v[i] != 0.0f && b.v[i] != 0.0f) ? 1.0f : 0.0f; } return a; }
+	inline PacketFloat PacketOr(PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = (a.v[i] != 0.0f || b.v[i] != 0.0f) ? 1.0f : 0.0f; } return a; }
+	inline PacketFloat PacketSelect(PacketFloat mask, PacketFloat a, PacketFloat b) { for(unsigned int i = 0; i < 4; ++i) { a.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i]; } return a; }
+	inline unsigned int PacketMoveMask(PacketFloat mask) { unsigned int m = 0; for(unsigned int i = 0; i < 4; ++i) { m |= mask.v[i] != 0.0f ? 1u << i : 0u; } return m; }
+#endif
+
+	/** Mask with a bit set for each of the first count lanes
+	* @param
+	*	count The number of lanes, at most PacketWidth
+	* @return
+	*	unsigned int The lane mask
+	*/
+	inline unsigned int PacketLaneMask(unsigned int count)
+	{
+		return count >= 32 ? 0xffffffff : (1u << count) - 1;
+	}
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STPACKETMATH_H__
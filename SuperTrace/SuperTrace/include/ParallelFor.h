@@ -0,0 +1,103 @@
+//*************************************************************************************************
+// Title: ParallelFor.h
+// Description: Fork-join helpers for one-off parallel passes outside the trace workers, like
+//	building a hierarchy or generating a scene. Each call starts its threads and joins them before
+//	it returns, the calling thread always takes part.
+//*************************************************************************************************
+#ifndef __STPARALLELFOR_H__
+#define __STPARALLELFOR_H__
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** Run a function on numWorkers threads at once, the calling thread is worker 0
+	* @param
+	*	numWorkers The number of threads, at least 1
+	* @param
+	*	function Called as function(worker) once on each thread
+	*/
+	template <typename Function>
+	void RunWorkers(unsigned int numWorkers, Function function)
+	{
+		std::vector<std::thread> threads;
+		for(unsigned int i = 1; i < numWorkers; ++i)
+		{
+			threads.push_back(std::thread(function, i));
+		}
+		function(0u);
+
+		for(unsigned int i = 0; i < threads.size(); ++i)
+		{
+			threads[i].join();
+		}
+	}
+
+	/** Cut a range into one contiguous slice per thread and run a function over each, slices are
+	*	never smaller than minSliceSize so small ranges stay on the calling thread
+	* @param
+	*	numThreads The most threads to use
+	* @param
+	*	first The start of the range
+	* @param
+	*	count The size of the range
+	* @param
+	*	minSliceSize The smallest slice worth a thread of its own
+	* @param
+	*	function Called as function(slice, begin, end)
+	* @return
+	*	unsigned int The number of slices the range was cut into
+	*/
+	template <typename Function>
+	unsigned int ParallelFor(unsigned int numThreads, unsigned int first, unsigned int count, unsigned int minSliceSize, Function function)
+	{
+		unsigned int numSlices = std::max(std::min(numThreads, count / minSliceSize), 1u);
+		unsigned int sliceSize = (count + numSlices - 1) / numSlices;
+		RunWorkers(numSlices, [&](unsigned int slice)
+		{
+			unsigned int begin = std::min(slice * sliceSize, count);
+			unsigned int end = std::min(begin + sliceSize, count);
+			function(slice, first + begin, first + end);
+		});
+		return numSlices;
+	}
+
+	/** Cut a range into fixed size blocks and run a function over each on up to numThreads
+	*	threads, threads take the next block as they finish one. Blocks are the same however many
+	*	threads run them
+	* @param
+	*	numThreads The most threads to use
+	* @param
+	*	count The size of the range
+	* @param
+	*	blockSize The size of every block but the last
+	* @param
+	*	function Called as function(block, begin, end)
+	*/
+	template <typename Function>
+	void ParallelForBlocks(unsigned int numThreads, unsigned int count, unsigned int blockSize, Function function)
+	{
+		unsigned int numBlocks = (count + blockSize - 1) / blockSize;
+		std::atomic<unsigned int> nextBlock(0);
+		RunWorkers(std::max(std::min(numThreads, numBlocks), 1u), [&](unsigned int)
+		{
+			for(unsigned int block = nextBlock++; block < numBlocks; block = nextBlock++)
+			{
+				unsigned int begin = block * blockSize;
+				function(block, begin, std::min(begin + blockSize, count));
+			}
+		});
+	}
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STPARALLELFOR_H__
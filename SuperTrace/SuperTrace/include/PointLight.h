@@ -35,9 +35,19 @@ namespace SuperTrace
 		*/
 		~PointLight();
 
-		/** Determine the color based on the object's properties
+		/** Determine the light's contribution to a surface point
+		* @param
+		*	scene The scene, queried for anything blocking the light
+		* @param
+		*	hit The closest hit of the ray
+		* @param
+		*	ray The ray that found the hit
+		* @param
+		*	stats Receives counts of the shadow rays cast
+		* @return
+		*	Color The reflected color
 		*/
-		Color compute(const Object* obj, const Ray& ray);
+		Color compute(const Scene& scene, const HitRecord& hit, const Ray& ray, RayStats& stats) const;
 
 	private:
 		/** Position of the light
@@ -0,0 +1,139 @@
+//*************************************************************************************************
+// Title: Presenter.h
+// Description: Base class for the backends that show a frame while it is being traced. Completed
+//	chunks are coalesced into dirty rectangles and only those are handed to the backend.
+//*************************************************************************************************
+#ifndef __STPRESENTER_H__
+#define __STPRESENTER_H__
+
+#include <vector>
+#include "RenderData.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** Upload statistics for a frame
+	*/
+	struct PresenterStats
+	{
+		PresenterStats()
+			:	numPresents(0), numChunks(0), numRects(0), pixelsUploaded(0)
+		{ }
+
+		/** Number of times dirty rectangles were uploaded
+		*/
+		unsigned int numPresents;
+
+		/** Number of completed chunks received
+		*/
+		unsigned int numChunks;
+
+		/** Number of rectangles uploaded after coalescing
+		*/
+		unsigned int numRects;
+
+		/** Number of pixels uploaded
+		*/
+		unsigned long long pixelsUploaded;
+	};
+
+	class Presenter
+	{
+	public:
+		/** Default constructor
+		*/
+		Presenter();
+
+		/** Destructor
+		*/
+		virtual ~Presenter();
+
+		/** Set the maximum number of uploads per second
+		* @param
+		*	hz The refresh rate, 0 to upload as soon as chunks arrive
+		*/
+		void setMaxRefreshRate(double hz);
+
+		/** Get the minimum time between two uploads
+		* @return
+		*	double The interval in seconds, 0 if uncapped
+		*/
+		double getPresentInterval() const;
+
+		/** Called on the thread that starts a render, before the present thread runs
+		* @param
+		*	width The image width
+		* @param
+		*	height The image height
+		* @param
+		*	pixels The frame buffer, RGB floats stored bottom up
+		*/
+		virtual void begin(unsigned int width, unsigned int height, const float* pixels);
+
+		/** Called on the present thread before its first upload
+		*/
+		virtual void attach();
+
+		/** Called on the present thread once the frame has been fully presented
+		*/
+		virtual void detach();
+
+		/** Mark a completed chunk as dirty, merging it with any rectangle it extends exactly
+		* @param
+		*	data The completed chunk
+		*/
+		void addDirtyRect(const RenderData& data);
+
+		/** Upload every dirty rectangle and clear them
+		*/
+		void present();
+
+		/** Get the upload statistics for the current frame
+		* @return
+		*	const PresenterStats& The statistics
+		*/
+		const PresenterStats& getStats() const;
+
+	protected:
+		/** Upload a rectangle of the frame buffer
+		* @param
+		*	rect The rectangle, in image coordinates with y pointing down
+		*/
+		virtual void uploadRect(const RenderData& rect) = 0;
+
+		/** Called after a batch of rectangles has been uploaded
+		*/
+		virtual void flush();
+
+	protected:
+		/** Image dimensions
+		*/
+		unsigned int _width;
+		unsigned int _height;
+
+		/** The frame buffer being presented
+		*/
+		const float* _pixels;
+
+	private:
+		/** Minimum time between uploads in seconds
+		*/
+		double _presentInterval;
+
+		/** Rectangles waiting to be uploaded, no two of them can be merged without waste
+		*/
+		std::vector<RenderData> _dirtyRects;
+
+		/** Statistics for the current frame
+		*/
+		PresenterStats _stats;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STPRESENTER_H__
@@ -0,0 +1,176 @@
+//*************************************************************************************************
+// Title: Random.h
+// Description: A small PCG32 generator. Each generator owns its state so threads never share or
+//	lock anything, and a generator keyed by pixel, sample and frame returns the same numbers
+//	whichever thread happens to trace that pixel.
+//*************************************************************************************************
+#ifndef __STRANDOM_H__
+#define __STRANDOM_H__
+
+#include "Material.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Math
+	*	@{
+	*/
+
+	/** Scramble a 64 bit value so that nearby inputs give unrelated outputs, used to turn keys
+	*	into seeds (SplitMix64 finalizer)
+	* @param
+	*	value The value to scramble
+	* @return
+	*	unsigned long long The scrambled value
+	*/
+	inline unsigned long long MixBits(unsigned long long value)
+	{
+		value ^= value >> 30;
+		value *= 0xbf58476d1ce4e5b9ull;
+		value ^= value >> 27;
+		value *= 0x94d049bb133111ebull;
+		value ^= value >> 31;
+		return value;
+	}
+
+	class Random
+	{
+	public:
+		/** Constructor
+		* @param
+		*	seed Picks the position in the sequence
+		* @param
+		*	stream Picks one of 2^63 independent sequences
+		*/
+		explicit Random(unsigned long long seed = 0, unsigned long long stream = 0)
+			:	_state(0), _increment((stream << 1) | 1)
+		{
+			nextUInt();
+			_state += seed;
+			nextUInt();
+		}
+
+		/** Create the generator for a pixel sample, the same key always gives the same numbers
+		* @param
+		*	seed The seed of the render
+		* @param
+		*	x The raster column
+		* @param
+		*	y The raster row
+		* @param
+		*	sample The sample within the pixel
+		* @param
+		*	frame The frame being rendered
+		* @return
+		*	Random The generator
+		*/
+		static Random ForPixel(unsigned int seed, unsigned int x, unsigned int y, unsigned int sample, unsigned int frame)
+		{
+			unsigned long long pixel = (static_cast<unsigned long long>(y) << 32) | x;
+			unsigned long long pass = (static_cast<unsigned long long>(frame) << 32) | sample;
+			return Random(MixBits(pass ^ MixBits(seed)), MixBits(pixel));
+		}
+
+		/** Get the next number in the sequence
+		* @return
+		*	unsigned int A uniformly distributed 32 bit value
+		*/
+		unsigned int nextUInt()
+		{
+			unsigned long long old = _state;
+			_state = old * 6364136223846793005ull + _increment;
+
+			// Output permutation XSH RR, a xorshift of the high bits followed by a random rotation
+			unsigned int xorShifted = static_cast<unsigned int>(((old >> 18) ^ old) >> 27);
+			unsigned int rotation = static_cast<unsigned int>(old >> 59);
+			return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+		}
+
+		/** Get a number below a bound without modulo bias
+		* @param
+		*	bound The number of possible values, must not be 0
+		* @return
+		*	unsigned int A value in [0, bound)
+		*/
+		unsigned int nextUInt(unsigned int bound)
+		{
+			// Reject the values at the bottom that would make some results more likely than others
+			unsigned int threshold = (0u - bound) % bound;
+			while(true)
+			{
+				unsigned int value = nextUInt();
+				if(value >= threshold)
+				{
+					return value % bound;
+				}
+			}
+		}
+
+		/** Get a number in [0, 1)
+		* @return
+		*	float The number
+		*/
+		float nextFloat()
+		{
+			// The top 24 bits fill a float's mantissa exactly
+			return static_cast<float>(nextUInt() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		/** Get a number in [min, max)
+		* @param
+		*	min The min value
+		* @param
+		*	max The max value
+		* @return
+		*	float The number
+		*/
+		float nextFloat(float min, float max)
+		{
+			return nextFloat() * (max - min) + min;
+		}
+
+	private:
+		/** Position in the sequence
+		*/
+		unsigned long long _state;
+
+		/** Selects the sequence, always odd
+		*/
+		unsigned long long _increment;
+	};
+
+	/** Draw a color with each channel from 0 - 1, channels are drawn one at a time because the
+	*	order function arguments are evaluated in is up to the compiler
+	* @param
+	*	random The generator to draw from
+	* @param
+	*	w The fourth component
+	* @return
+	*	Vector4 The color
+	*/
+	inline Vector4 RandomColor(Random& random, float w)
+	{
+		float r = random.nextFloat();
+		float g = random.nextFloat();
+		float b = random.nextFloat();
+		return Vector4(r, g, b, w);
+	}
+
+	/** Draw a material with random ambient, diffuse and specular colors and a shininess from 2 - 8
+	* @param
+	*	random The generator to draw from
+	* @return
+	*	Material The material
+	*/
+	inline Material RandomMaterial(Random& random)
+	{
+		Vector4 ambient = RandomColor(random, 1.0f);
+		Vector4 diffuse = RandomColor(random, 1.0f);
+		Vector4 specular = RandomColor(random, random.nextFloat(2.0f, 8.0f));
+		return Material(ambient, diffuse, specular);
+	}
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STRANDOM_H__
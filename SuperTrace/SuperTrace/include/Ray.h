@@ -7,6 +7,7 @@
 #define __STRAY_H__
 
 #include "Vector3.h"
+#include <float.h>
 #include <limits>
 
 namespace SuperTrace
@@ -20,7 +21,8 @@ namespace SuperTrace
 	{
 		RAY_TYPE_UNKNOWN = 0,
 		RAY_TYPE_CAMERA,
-		RAY_TYPE_SHADOW
+		RAY_TYPE_SHADOW,
+		NUM_RAY_TYPES
 	};
 
 	class Ray
@@ -70,7 +72,7 @@ namespace SuperTrace
 		* @param 
 		*	tMin The new tMin value
 		*/
-		void setTMin(float tMin) const;
+		void setTMin(float tMin);
 
 		/** Return the current tMax value
 		* @return
@@ -82,7 +84,7 @@ namespace SuperTrace
 		* @param 
 		*	tMax The new tMax value
 		*/
-		void setTMax(float tMax) const;
+		void setTMax(float tMax);
 
 		/** Get the inverse direction
 		* @return
@@ -111,11 +113,11 @@ namespace SuperTrace
 
 		/** Ray minimum distance
 		*/
-		mutable float _tMin;
+		float _tMin;
 
 		/** Ray maximum distance
 		*/
-		mutable float _tMax;
+		float _tMax;
 
 		/** Inverted direction
 		*/
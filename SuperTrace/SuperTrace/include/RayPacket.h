@@ -0,0 +1,224 @@
+//*************************************************************************************************
+// Title: RayPacket.h
+// Description: Coherent rays traced together, stored one array per component so intersection tests
+//	can run across every lane at once. Lanes outside the active mask always hold a valid ray, a copy
+//	of the last active one, so code that runs over every lane never reads uninitialized data.
+//*************************************************************************************************
+#ifndef __STRAYPACKET_H__
+#define __STRAYPACKET_H__
+
+#include <float.h>
+#include "HitRecord.h"
+#include "PacketMath.h"
+#include "Ray.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	class RayPacket
+	{
+	public:
+		/** Default constructor, the packet holds no rays and every lane an empty one
+		*/
+		RayPacket()
+			:	count(0)
+		{
+			for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+			{
+				setRay(lane, Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f), 0.0f, 0.0f);
+			}
+		}
+
+		/** Set one lane of the packet
+		* @param
+		*	lane The lane to set
+		* @param
+		*	origin The ray origin
+		* @param
+		*	direction The ray direction
+		* @param
+		*	tMin The start of the ray
+		* @param
+		*	tMax The end of the ray
+		*/
+		void setRay(unsigned int lane, const Vector3& origin, const Vector3& direction, float tMin = 0.0f, float tMax = FLT_MAX)
+		{
+			originX[lane] = origin.getX();
+			originY[lane] = origin.getY();
+			originZ[lane] = origin.getZ();
+			directionX[lane] = direction.getX();
+			directionY[lane] = direction.getY();
+			directionZ[lane] = direction.getZ();
+			invDirectionX[lane] = 1.0f / direction.getX();
+			invDirectionY[lane] = 1.0f / direction.getY();
+			invDirectionZ[lane] = 1.0f / direction.getZ();
+			this->tMin[lane] = tMin;
+			this->tMax[lane] = tMax;
+		}
+
+		/** Copy the last active lane into every lane after it, call once count is set
+		*/
+		void padInactiveLanes()
+		{
+			if(count == 0)
+			{
+				return;
+			}
+
+			unsigned int last = count - 1;
+			for(unsigned int lane = count; lane < PacketWidth; ++lane)
+			{
+				originX[lane] = originX[last];
+				originY[lane] = originY[last];
+				originZ[lane] = originZ[last];
+				directionX[lane] = directionX[last];
+				directionY[lane] = directionY[last];
+				directionZ[lane] = directionZ[last];
+				invDirectionX[lane] = invDirectionX[last];
+				invDirectionY[lane] = invDirectionY[last];
+				invDirectionZ[lane] = invDirectionZ[last];
+				tMin[lane] = tMin[last];
+				tMax[lane] = tMax[last];
+			}
+		}
+
+		/** Get one lane of the packet as a single ray
+		* @param
+		*	lane The lane
+		* @param
+		*	type The type of the returned ray
+		* @return
+		*	Ray The ray in that lane
+		*/
+		Ray getRay(unsigned int lane, RayType type = RAY_TYPE_CAMERA) const
+		{
+			return Ray(Vector3(originX[lane], originY[lane], originZ[lane]), Vector3(directionX[lane], directionY[lane], directionZ[lane]),
+				type, tMin[lane], tMax[lane]);
+		}
+
+		/** Get the lanes that hold rays
+		* @return
+		*	unsigned int A bit per lane, set for the first count lanes
+		*/
+		unsigned int getActiveMask() const
+		{
+			return PacketLaneMask(count);
+		}
+
+		/** Ray origins
+		*/
+		float originX[PacketWidth];
+		float originY[PacketWidth];
+		float originZ[PacketWidth];
+
+		/** Ray directions
+		*/
+		float directionX[PacketWidth];
+		float directionY[PacketWidth];
+		float directionZ[PacketWidth];
+
+		/** Reciprocals of the ray directions, for slab tests
+		*/
+		float invDirectionX[PacketWidth];
+		float invDirectionY[PacketWidth];
+		float invDirectionZ[PacketWidth];
+
+		/** Extent of each ray
+		*/
+		float tMin[PacketWidth];
+		float tMax[PacketWidth];
+
+		/** Number of lanes that hold rays, starting from lane 0
+		*/
+		unsigned int count;
+	};
+
+	/** What the intersection tests found for each lane of a packet, laid out like a HitRecord per
+	*	lane
+	*/
+	class HitPacket
+	{
+	public:
+		/** Reset every lane to a miss
+		* @param
+		*	packet The packet about to be traced, each lane only accepts hits within its tMax
+		*/
+		void reset(const RayPacket& packet)
+		{
+			for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+			{
+				t[lane] = packet.tMax[lane];
+				primitive[lane] = HitRecord::InvalidPrimitive;
+				object[lane] = 0;
+			}
+		}
+
+		/** Get one lane as a hit record
+		* @param
+		*	lane The lane
+		* @return
+		*	HitRecord The hit in that lane
+		*/
+		HitRecord getHit(unsigned int lane) const
+		{
+			HitRecord hit(t[lane]);
+			hit.primitive = primitive[lane];
+			hit.object = object[lane];
+			hit.material = material[lane];
+			hit.normal = normal[lane];
+			hit.u = u[lane];
+			hit.v = v[lane];
+			return hit;
+		}
+
+		/** Store a hit record in one lane
+		* @param
+		*	lane The lane
+		* @param
+		*	hit The hit
+		*/
+		void setHit(unsigned int lane, const HitRecord& hit)
+		{
+			t[lane] = hit.t;
+			primitive[lane] = hit.primitive;
+			object[lane] = hit.object;
+			material[lane] = hit.material;
+			normal[lane] = hit.normal;
+			u[lane] = hit.u;
+			v[lane] = hit.v;
+		}
+
+		/** Distance to the closest hit so far in each lane, tests only accept hits nearer than this
+		*/
+		float t[PacketWidth];
+
+		/** Index of the hit primitive in the scene
+		*/
+		unsigned int primitive[PacketWidth];
+
+		/** The object that was hit, 0 if the lane hit nothing
+		*/
+		const Object* object[PacketWidth];
+
+		/** Material of the surface hit in each lane
+		*/
+		const Material* material[PacketWidth];
+
+		/** Unit geometric normal at each hit
+		*/
+		Vector3 normal[PacketWidth];
+
+		/** Surface parameterization of each hit
+		*/
+		float u[PacketWidth];
+		float v[PacketWidth];
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STRAYPACKET_H__
@@ -10,6 +10,8 @@ namespace SuperTrace
 
 		unsigned int _startX;
 		unsigned int _startY;
+		unsigned int _width;
+		unsigned int _height;
 		float* _pixelData;
 	};
 
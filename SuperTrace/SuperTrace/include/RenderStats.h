@@ -0,0 +1,146 @@
+//*************************************************************************************************
+// Title: RenderStats.h
+// Description: Counters of the work done while rendering, kept per thread so counting never
+//	shares a cache line or takes a lock. The counters sit on the hottest paths in the tracer, so
+//	they are only compiled in when ST_ENABLE_STATS is defined, otherwise every count reads 0 and
+//	the counting statements compile to nothing.
+//*************************************************************************************************
+#ifndef __STRENDERSTATS_H__
+#define __STRENDERSTATS_H__
+
+#include "Ray.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** Work done by a thread, a worker or a whole frame
+	*/
+	struct RenderStats
+	{
+		RenderStats()
+			:	numNodeTests(0), numPrimitiveTests(0), numPrimitiveHits(0), numShadingCalls(0), numTiles(0),
+				busySeconds(0.0), idleSeconds(0.0)
+		{
+			for(unsigned int i = 0; i < NUM_RAY_TYPES; ++i)
+			{
+				numRays[i] = 0;
+			}
+		}
+
+		RenderStats& operator+=(const RenderStats& stats)
+		{
+			for(unsigned int i = 0; i < NUM_RAY_TYPES; ++i)
+			{
+				numRays[i] += stats.numRays[i];
+			}
+			numNodeTests += stats.numNodeTests;
+			numPrimitiveTests += stats.numPrimitiveTests;
+			numPrimitiveHits += stats.numPrimitiveHits;
+			numShadingCalls += stats.numShadingCalls;
+			numTiles += stats.numTiles;
+			busySeconds += stats.busySeconds;
+			idleSeconds += stats.idleSeconds;
+			return *this;
+		}
+
+		RenderStats operator-(const RenderStats& stats) const
+		{
+			RenderStats difference;
+			for(unsigned int i = 0; i < NUM_RAY_TYPES; ++i)
+			{
+				difference.numRays[i] = numRays[i] - stats.numRays[i];
+			}
+			difference.numNodeTests = numNodeTests - stats.numNodeTests;
+			difference.numPrimitiveTests = numPrimitiveTests - stats.numPrimitiveTests;
+			difference.numPrimitiveHits = numPrimitiveHits - stats.numPrimitiveHits;
+			difference.numShadingCalls = numShadingCalls - stats.numShadingCalls;
+			difference.numTiles = numTiles - stats.numTiles;
+			difference.busySeconds = busySeconds - stats.busySeconds;
+			difference.idleSeconds = idleSeconds - stats.idleSeconds;
+			return difference;
+		}
+
+		/** Rays traced, by type
+		*/
+		unsigned long long numRays[NUM_RAY_TYPES];
+
+		/** Ray against BVH node bounds tests, in the scene and in objects with a hierarchy of their
+		*	own. A packet counts one test per active lane
+		*/
+		unsigned long long numNodeTests;
+
+		/** Ray against primitive tests, a packet counts one test per active lane
+		*/
+		unsigned long long numPrimitiveTests;
+
+		/** Primitive tests that found a hit nearer than the closest so far, or any blocker for an
+		*	occlusion test
+		*/
+		unsigned long long numPrimitiveHits;
+
+		/** Light evaluations at shaded surfaces
+		*/
+		unsigned long long numShadingCalls;
+
+		/** Tiles traced, counting each split of a tile as a tile of its own. Taken from the worker
+		*	pool rather than counted per thread
+		*/
+		unsigned long long numTiles;
+
+		/** Time spent tracing tiles, taken from the worker pool
+		*/
+		double busySeconds;
+
+		/** Time spent looking for tiles, taken from the worker pool
+		*/
+		double idleSeconds;
+	};
+
+	/** Count the lanes set in a packet mask
+	* @param
+	*	mask A bit per lane
+	* @return
+	*	unsigned int The number of bits set
+	*/
+	inline unsigned int CountLanes(unsigned int mask)
+	{
+		unsigned int count = 0;
+		for(; mask != 0; mask &= mask - 1)
+		{
+			++count;
+		}
+		return count;
+	}
+
+	/** Check whether render statistics are being counted
+	* @return
+	*	bool True when built with ST_ENABLE_STATS
+	*/
+	bool IsRenderStatsEnabled();
+
+	/** Get the work counted by the calling thread since it started
+	* @return
+	*	RenderStats The counts
+	*/
+	RenderStats GetThreadRenderStats();
+
+#ifdef ST_ENABLE_STATS
+	/** The calling thread's counters, only touched through ST_STATS_ADD
+	*/
+	extern thread_local RenderStats ThreadRenderStats;
+
+	// Add to one of the calling thread's counters
+	#define ST_STATS_ADD(counter, amount) (SuperTrace::ThreadRenderStats.counter += (amount))
+#else
+	// Counting is compiled out, the amount is never evaluated
+	#define ST_STATS_ADD(counter, amount) ((void)0)
+#endif
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STRENDERSTATS_H__
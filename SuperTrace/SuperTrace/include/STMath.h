@@ -6,13 +6,40 @@
 #ifndef __STMATH_H__
 #define __STMATH_H__
 
+#include <math.h>
+#include <algorithm>
 #include "Matrix44.h"
 #include "Vector3.h"
 
 namespace SuperTrace
 {
 
+// Some C libraries already define M_PI in math.h
+#ifndef M_PI
 #define M_PI 3.14159265359f
+#endif
+
+	/** Seed the calling thread's generator for Randf, each thread starts from seed 0
+	* @param
+	*	seed The seed
+	*/
+	void SeedRandf(unsigned int seed);
+
+	/** Generate a random number from the calling thread's generator
+	* @return
+	*	float A random number from 0 - 1
+	*/
+	float Randf();
+
+	/** Generate a random number from the calling thread's generator
+	* @param
+	*	min The min value
+	* @param
+	*	max The max value
+	* @return
+	*	float A randon number from min - max
+	*/
+	float Randf(float min, float max);
 
 	/** Transform a vector by a matrix
 	* @param
@@ -22,7 +49,26 @@ namespace SuperTrace
 	* @return
 	*	Vector3 The resultant vector
 	*/
-	Vector3 Vector3TransformPoint(const Vector3& vec, const Matrix44& mat);
+	inline Vector3 Vector3TransformPoint(const Vector3& vec, const Matrix44& mat)
+	{
+		// Perform the multiplicative calculations to transform the vector
+		float x = vec.getX()*mat(0,0) + vec.getY()*mat(1,0) + vec.getZ()*mat(2,0) + mat(3,0);
+		float y = vec.getX()*mat(0,1) + vec.getY()*mat(1,1) + vec.getZ()*mat(2,1) + mat(3,1);
+		float z = vec.getX()*mat(0,2) + vec.getY()*mat(1,2) + vec.getZ()*mat(2,2) + mat(3,2);
+		float w = vec.getX()*mat(0,3) + vec.getY()*mat(1,3) + vec.getZ()*mat(2,3) + mat(3,3);
+
+		// If w is either not 0 or not 1, normalize
+		if(w != 0.0f && w != 1.0f)
+		{
+			w = 1.0f / w;
+			x *= w;
+			y *= w;
+			z *= w;
+		}
+
+		// Return the corresponding vector
+		return Vector3(x, y, z);
+	}
 
 	/** Transform a vector by a matrix
 	* @param
@@ -32,7 +78,16 @@ namespace SuperTrace
 	* @return
 	*	Vector3 The resultant vector
 	*/
-	Vector3 Vector3Transform(const Vector3& vec, const Matrix44& mat);
+	inline Vector3 Vector3Transform(const Vector3& vec, const Matrix44& mat)
+	{
+		// Perform the multiplicative calculations to transform the vector
+		float x = vec.getX()*mat(0,0) + vec.getY()*mat(1,0) + vec.getZ()*mat(2,0);
+		float y = vec.getX()*mat(0,1) + vec.getY()*mat(1,1) + vec.getZ()*mat(2,1);
+		float z = vec.getX()*mat(0,2) + vec.getY()*mat(1,2) + vec.getZ()*mat(2,2);
+
+		// Return the corresponding vector
+		return Vector3(x, y, z);
+	}
 
 	/** Solve a quadratic equation
 	* @param
@@ -42,24 +97,43 @@ namespace SuperTrace
 	* @return
 	*	bool If at least one root is found
 	*/
-	bool SolveQuadratic(float a, float b, float c, float& x0, float& x1);
+	inline bool SolveQuadratic(float a, float b, float c, float& x0, float& x1)
+	{
+		// Find the discriminant
+		float disc = (b * b) - (4.0f * a * c);
+		// No roots
+		if(disc < 0)
+		{
+			return false;
+		}
+		// One root
+		else if(disc == 0)
+		{
+			x0 = x1 = -0.5f * b / a;
+		}
+		// Two roots
+		else
+		{
+			float q = 0.0f;
+			if(b > 0)
+			{
+				q = -0.5f * (b + sqrt(disc));
+			}
+			else
+			{
+				q = -0.5f * (b - sqrt(disc));
+			}
+			x0 = q / a;
+			x1 = c / q;
+		}
 
-	/** Generate a random number
-	* @return
-	*	float A random number from 0 - 1
-	*/
-	float Randf();
+		if(x0 > x1)
+		{
+			std::swap(x0, x1);
+		}
+		return true;
+	}
 
-	/** Generate a random number
-	* @param
-	*	min The min value
-	* @param
-	*	max The max value
-	* @return
-	*	float A randon number from min - max
-	*/
-	float Randf(float min, float max);
-	
 }	// Namespace
 
 #endif // __STMATH_H__
\ No newline at end of file
@@ -6,7 +6,9 @@
 #ifndef __STSCENE_H__
 #define __STSCENE_H__
 
-#include <list>
+#include <vector>
+#include "Arena.h"
+#include "BVH.h"
 
 namespace SuperTrace
 {
@@ -16,9 +18,47 @@ namespace SuperTrace
 
 	// Forward declarations
 	class Camera;
+	class RayPacket;
 	class Color;
+	class HitRecord;
 	class Light;
 	class Object;
+	class Random;
+	class Ray;
+
+	/** Rays cast while tracing, each trace worker counts into its own copy
+	*/
+	struct RayStats
+	{
+		RayStats()
+			:	numCameraRays(0), numShadowRays(0), numOccludedShadowRays(0), numShadingSamples(0)
+		{ }
+
+		RayStats& operator+=(const RayStats& stats)
+		{
+			numCameraRays += stats.numCameraRays;
+			numShadowRays += stats.numShadowRays;
+			numOccludedShadowRays += stats.numOccludedShadowRays;
+			numShadingSamples += stats.numShadingSamples;
+			return *this;
+		}
+
+		/** Number of primary rays traced
+		*/
+		unsigned long long numCameraRays;
+
+		/** Number of occlusion queries made towards lights
+		*/
+		unsigned long long numShadowRays;
+
+		/** Number of those queries that found something in the way
+		*/
+		unsigned long long numOccludedShadowRays;
+
+		/** Number of lights evaluated at surfaces that were hit, one per light per hit
+		*/
+		unsigned long long numShadingSamples;
+	};
 
 	class Scene
 	{
@@ -27,39 +67,165 @@ namespace SuperTrace
 		*/
 		Scene();
 
-		/** Create the scene
+		/** Remove every object, light and the camera and reset the arena, keeping its blocks and the
+		*	containers' capacity so the next scene of the same size is built without the heap
 		*/
-		void createScene();
+		void reset();
+
+		/** Create the scene, the same seed always gives the same scene
+		* @param
+		*	seed The seed for the scene's random layout
+		*/
+		void createScene(unsigned int seed);
+
+		/** Add an object, it must live as long as the scene so it is usually created in the arena
+		* @param
+		*	object The object
+		*/
+		void addObject(Object* object);
+
+		/** Add a light, it must live as long as the scene so it is usually created in the arena
+		* @param
+		*	light The light
+		*/
+		void addLight(Light* light);
+
+		/** Get the number of objects in the scene
+		* @return
+		*	unsigned int The number of objects
+		*/
+		unsigned int getNumObjects() const;
+
+		/** Get the number of lights in the scene
+		* @return
+		*	unsigned int The number of lights
+		*/
+		unsigned int getNumLights() const;
+
+		/** Build the acceleration structure over the scene's objects, call after objects are added
+		*/
+		void buildAccelerationStructure();
+
+		/** Get the statistics of the last acceleration structure build
+		* @return
+		*	const BVHBuildStats& The build statistics
+		*/
+		const BVHBuildStats& getAccelerationStats() const;
+
+		/** Get the arena holding the scene's objects and lights, anything created in it lives as
+		*	long as the scene
+		* @return
+		*	Arena& The scene arena
+		*/
+		Arena& getArena();
 
 		/** Create the camera for the scene
 		*/
 		void setCamera(Camera* camera);
 
+		/** Get the scene camera
+		* @return
+		*	const Camera* The camera, NULL if none has been set
+		*/
+		const Camera* getCamera() const;
+
 		/** Trace a given rasterized position
 		* @param
 		*	x The rasterized x position
 		* @param
 		*	y The rasterized y position
+		* @param
+		*	stats Receives counts of the rays cast
+		*/
+		Color trace(unsigned int x, unsigned int y, RayStats& stats);
+
+		/** Trace a camera ray
+		* @param
+		*	ray The camera ray
+		* @param
+		*	stats Receives counts of the rays cast
+		* @return
+		*	Color The color seen along the ray
+		*/
+		Color trace(const Ray& ray, RayStats& stats);
+
+		/** Trace a packet of camera rays together, visibility runs across the packet and the
+		*	surfaces found are then shaded
+		* @param
+		*	packet The camera rays
+		* @param
+		*	colors Receives the color seen along each ray in the packet
+		* @param
+		*	stats Receives counts of the rays cast
+		*/
+		void tracePacket(const RayPacket& packet, Color* colors, RayStats& stats);
+
+		/** Check whether anything lies along a ray, stopping at the first hit found rather than
+		*	searching for the closest
+		* @param
+		*	ray The ray, only hits within [tMin, tMax] count
+		* @param
+		*	stats Receives counts of the rays cast
+		* @return
+		*	bool True if the ray is blocked
 		*/
-		Color trace(unsigned int x, unsigned int y);
+		bool occluded(const Ray& ray, RayStats& stats) const;
 
 	private:
+		/** Find the closest surface along a ray
+		* @param
+		*	ray The ray
+		* @param
+		*	hit Receives the closest hit
+		* @return
+		*	bool True if the ray hit anything
+		*/
+		bool findClosestHit(const Ray& ray, HitRecord& hit) const;
+
+		/** Shade a surface point with every light in the scene
+		* @param
+		*	hit The closest hit of the ray
+		* @param
+		*	ray The ray that found the hit
+		* @param
+		*	stats Receives counts of the shadow rays cast
+		* @return
+		*	Color The sum of the light contributions
+		*/
+		Color shade(const HitRecord& hit, const Ray& ray, RayStats& stats) const;
+
 		/** Create lights
+		* @param
+		*	random The generator for the scene's layout
 		*/
-		void createLights();
+		void createLights(Random& random);
 
 		/** Add objects to the scene
+		* @param
+		*	random The generator for the scene's layout
 		*/
-		void createObjects();
+		void createObjects(Random& random);
 
 	private:
-		/** List of objects in the scene
+		/** Objects, lights and their materials laid out together, destroyed with the scene
+		*/
+		Arena _arena;
+
+		/** Objects in the scene, indexed by the acceleration structure
+		*/
+		std::vector<Object*> _objects;
+
+		/** Bounds of the objects, kept between acceleration structure builds
+		*/
+		std::vector<AABB> _bounds;
+
+		/** Acceleration structure over the objects
 		*/
-		std::list<Object*> _objects;
+		BVH _bvh;
 
-		/** List of lights in the scene
+		/** Lights in the scene
 		*/
-		std::list<Light*> _lights; 
+		std::vector<Light*> _lights;
 
 		/** Scene camera
 		*/
@@ -0,0 +1,144 @@
+//*************************************************************************************************
+// Title: SceneGenerator.h
+// Description: Procedural scenes of any size for scaling tests. The same settings always give the
+//	same scene, whatever the number of threads it was generated on.
+//*************************************************************************************************
+#ifndef __STSCENEGENERATOR_H__
+#define __STSCENEGENERATOR_H__
+
+#include "Vector3.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	// Forward declarations
+	class Scene;
+
+	/** How generated primitives are spread through the bounds
+	*/
+	enum SceneDistribution
+	{
+		SCENE_DISTRIBUTION_UNIFORM = 0,		// Anywhere in the bounds with equal chance
+		SCENE_DISTRIBUTION_CLUSTERED,		// Gathered around a few random centers
+		SCENE_DISTRIBUTION_GRID,			// On a regular lattice filling the bounds
+		NUM_SCENE_DISTRIBUTIONS
+	};
+
+	/** What each generated primitive is
+	*/
+	enum ScenePrimitive
+	{
+		SCENE_PRIMITIVE_PARTICLES = 0,		// Spheres held by a single sphere set
+		SCENE_PRIMITIVE_SPHERES,			// A sphere object each
+		SCENE_PRIMITIVE_BOXES,				// A box object each
+		NUM_SCENE_PRIMITIVES
+	};
+
+	/** What to generate
+	*/
+	struct SceneGeneratorSettings
+	{
+		SceneGeneratorSettings()
+			:	seed(1), numObjects(10000), numLights(8), distribution(SCENE_DISTRIBUTION_UNIFORM), primitive(SCENE_PRIMITIVE_PARTICLES),
+				minSize(0.1f), maxSize(0.5f), boundsMin(-40.0f, -30.0f, 20.0f), boundsMax(40.0f, 30.0f, 100.0f), numClusters(16),
+				clusterRadius(6.0f), numMaterials(16), numThreads(0)
+		{ }
+
+		/** Seed for everything drawn at random
+		*/
+		unsigned int seed;
+
+		/** Number of primitives
+		*/
+		unsigned int numObjects;
+
+		/** Number of point lights, spread uniformly through the bounds whatever the distribution
+		*/
+		unsigned int numLights;
+
+		/** How the primitives are spread through the bounds
+		*/
+		SceneDistribution distribution;
+
+		/** What each primitive is
+		*/
+		ScenePrimitive primitive;
+
+		/** Range of sphere radii, or of box half extents drawn per axis
+		*/
+		float minSize;
+		float maxSize;
+
+		/** Box holding the primitive centers and the lights, the default fills the view of the
+		*	renderer's camera from 20 units out
+		*/
+		Vector3 boundsMin;
+		Vector3 boundsMax;
+
+		/** Number of cluster centers, and the radius primitives gather within, for a clustered
+		*	distribution
+		*/
+		unsigned int numClusters;
+		float clusterRadius;
+
+		/** Number of random materials the primitives pick from
+		*/
+		unsigned int numMaterials;
+
+		/** Threads to generate on, 0 for one per hardware thread
+		*/
+		unsigned int numThreads;
+	};
+
+	/** Get the name of a distribution
+	* @param
+	*	distribution The distribution
+	* @return
+	*	const char* The name, as parsed by SceneDistributionFromName
+	*/
+	const char* GetSceneDistributionName(SceneDistribution distribution);
+
+	/** Find a distribution by name
+	* @param
+	*	name uniform, clustered or grid
+	* @return
+	*	SceneDistribution The distribution, NUM_SCENE_DISTRIBUTIONS if the name is unknown
+	*/
+	SceneDistribution SceneDistributionFromName(const char* name);
+
+	/** Get the name of a primitive type
+	* @param
+	*	primitive The primitive type
+	* @return
+	*	const char* The name, as parsed by ScenePrimitiveFromName
+	*/
+	const char* GetScenePrimitiveName(ScenePrimitive primitive);
+
+	/** Find a primitive type by name
+	* @param
+	*	name particles, spheres or boxes
+	* @return
+	*	ScenePrimitive The primitive type, NUM_SCENE_PRIMITIVES if the name is unknown
+	*/
+	ScenePrimitive ScenePrimitiveFromName(const char* name);
+
+	/** Fill a scene with generated primitives and lights. Placements are drawn in parallel in
+	*	fixed blocks, each from a generator of its own, so the scene does not depend on the thread
+	*	count. Particles are written straight into their sphere set from every thread, sphere and
+	*	box objects are created in the scene arena on the calling thread once placed. Call
+	*	Scene::buildAccelerationStructure afterwards, as SceneRenderer does for a scene builder
+	* @param
+	*	scene The scene to add to
+	* @param
+	*	settings What to generate
+	*/
+	void GenerateScene(Scene& scene, const SceneGeneratorSettings& settings);
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STSCENEGENERATOR_H__
@@ -7,9 +7,23 @@
 #ifndef __STSCENERENDERER_H__
 #define __STSCENERENDERER_H__
 
-#include <windows.h>
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AllocationTracker.h"
+#include "Arena.h"
 #include "Camera.h"
+#include "MPMCQueue.h"
+#include "RenderData.h"
+#include "RenderStats.h"
+#include "Scene.h"
+#include "TileProfile.h"
+#include "WorkerPool.h"
 
 namespace SuperTrace
 {
@@ -18,12 +32,90 @@ namespace SuperTrace
 	*/
 
 	class ChunkData;
-	class RenderData;
-	class Scene;
+	class Presenter;
+
+	// How the image is split into chunks
+	enum TilingMode
+	{
+		TILING_CHUNK_COUNT = 0,		// A fixed number of chunks along each axis
+		TILING_ADAPTIVE,			// Tile size chosen from the worker count and cache budget
+		TILING_FIXED_SIZE			// Tiles of a fixed size in pixels
+	};
+
+	/** The tiling chosen for a render
+	*/
+	struct TilingStats
+	{
+		TilingStats()
+			:	mode(TILING_ADAPTIVE), tileWidth(0), tileHeight(0), tilesX(0), tilesY(0), numSplits(0)
+		{ }
+
+		/** The tiling mode used
+		*/
+		TilingMode mode;
+
+		/** Size of a full tile in pixels, tiles along the right and bottom edges may be smaller
+		*/
+		unsigned int tileWidth;
+		unsigned int tileHeight;
+
+		/** Number of tiles along each axis
+		*/
+		unsigned int tilesX;
+		unsigned int tilesY;
+
+		/** Number of expensive tiles that were subdivided while they were being traced
+		*/
+		unsigned int numSplits;
+	};
+
+	/** Where the time of a render went, every time is measured from the call to render
+	*/
+	struct FrameTimings
+	{
+		FrameTimings()
+			:	setupSeconds(0.0), firstTileSeconds(0.0), frameSeconds(0.0)
+		{ }
+
+		/** Until the workers start, building the scene, its acceleration structure and the queues
+		*/
+		double setupSeconds;
+
+		/** Until the first tile is in the frame buffer
+		*/
+		double firstTileSeconds;
+
+		/** Until the last tile is in the frame buffer
+		*/
+		double frameSeconds;
+	};
+
+	/** Heap allocations made during a render, all zero unless built with ST_TRACK_ALLOCATIONS
+	*/
+	struct RenderAllocationStats
+	{
+		/** Made by render itself, building the scene and its acceleration structure, the frame
+		*	buffer and starting the threads
+		*/
+		AllocationCount setup;
+
+		/** Made by the trace workers while tracing tiles, none are expected
+		*/
+		AllocationCount trace;
+
+		/** Made by the render processor while presenting completed tiles
+		*/
+		AllocationCount present;
+	};
 
 	class SceneRenderer
 	{
 	public:
+		/** Fills an empty scene with objects and lights from a seed, the renderer builds the
+		*	acceleration structure afterwards
+		*/
+		typedef std::function<void(Scene& scene, unsigned int seed)> SceneBuilder;
+
 		/** Default constructor
 		*/
 		SceneRenderer();
@@ -32,13 +124,13 @@ namespace SuperTrace
 		*/
 		~SceneRenderer();
 
-		/** Set the number of chunks
+		/** Set the number of chunks along each axis, this selects TILING_CHUNK_COUNT
 		* @param
 		*   numChunks The number of chunks
 		*/
 		void setNumChunks(unsigned int numChunks);
 
-		/** Calculate the optimal number of chunks for the given dimensions
+		/** Calculate the optimal tiling for the given dimensions, this selects TILING_ADAPTIVE
 		* @param
 		*   width The window width
 		* @param
@@ -46,44 +138,211 @@ namespace SuperTrace
 		*/
 		void calcOptimalChunks(unsigned int width, unsigned int height);
 
+		/** Set a fixed tile size in pixels, this selects TILING_FIXED_SIZE
+		* @param
+		*   tileWidth The tile width
+		* @param
+		*   tileHeight The tile height
+		*/
+		void setTileSize(unsigned int tileWidth, unsigned int tileHeight);
+
+		/** Set the number of tiles each worker should receive when picking an adaptive tile size
+		* @param
+		*   tilesPerWorker The target number of tiles per worker
+		*/
+		void setTargetTilesPerWorker(unsigned int tilesPerWorker);
+
+		/** Set the maximum number of bytes of pixel data a single adaptive tile may cover
+		* @param
+		*   bytes The cache budget per tile
+		*/
+		void setTileCacheBudget(unsigned int bytes);
+
+		/** Set the time after which a tile that is still being traced is split so idle workers can
+		*   steal the rest of it. Only adaptive tiling splits, fixed size and chunk count tiling
+		*   always trace the tiles they were given
+		* @param
+		*   seconds The split threshold, 0 disables splitting
+		*/
+		void setTileSplitTime(double seconds);
+
+		/** Set whether camera rays are traced in packets along each row rather than one at a time,
+		*   on by default when packets use SIMD
+		* @param
+		*   packetTracing True to trace packets
+		*/
+		void setPacketTracing(bool packetTracing);
+
+		/** Get whether camera rays are traced in packets
+		* @return
+		*   bool True if packets are traced
+		*/
+		bool getPacketTracing() const;
+
+		/** Set whether each worker traces a tile into its own buffer and copies it to the frame buffer
+		*   once the tile is done, rather than writing every pixel straight to the frame buffer where
+		*   workers on neighbouring tiles share cache lines, on by default
+		* @param
+		*   tileBuffers True to trace into tile buffers
+		*/
+		void setTileBuffers(bool tileBuffers);
+
+		/** Get whether workers trace into tile buffers
+		* @return
+		*   bool True if tile buffers are used
+		*/
+		bool getTileBuffers() const;
+
+		/** Set whether tiles are handed out most expensive first, judged by what they cost in the
+		*   last render over the same tile grid, so the slowest tiles do not start last and hold up
+		*   the end of the frame. On by default, the first render and any render after the grid
+		*   changes go in raster order
+		* @param
+		*   costOrdering True to order tiles by their last cost
+		*/
+		void setTileCostOrdering(bool costOrdering);
+
+		/** Get whether tiles are handed out most expensive first
+		* @return
+		*   bool True if tiles are ordered by cost
+		*/
+		bool getTileCostOrdering() const;
+
+		/** Set the seed the scene is created from, the same seed gives the same image whatever the
+		*   number of workers
+		* @param
+		*   seed The scene seed
+		*/
+		void setSceneSeed(unsigned int seed);
+
+		/** Get the seed the scene is created from
+		* @return
+		*   unsigned int The scene seed
+		*/
+		unsigned int getSceneSeed() const;
+
+		/** Set the function that fills each new scene
+		* @param
+		*   builder The scene builder, empty for the default scene
+		*/
+		void setSceneBuilder(const SceneBuilder& builder);
+
+		/** Get the tiling used by the last render, the split count is final once the workers finish
+		* @return
+		*   TilingStats The tiling statistics
+		*/
+		TilingStats getTilingStats() const;
+
+		/** Set the number of trace workers
+		* @param
+		*   numWorkers The number of workers, 0 to use the hardware concurrency
+		*/
+		void setNumWorkers(unsigned int numWorkers);
+
+		/** Get the number of trace workers
+		* @return
+		*   unsigned int The number of workers
+		*/
+		unsigned int getNumWorkers() const;
+
+		/** Get the load balance statistics for a trace worker, valid once the workers have finished
+		* @param
+		*   worker The worker index
+		* @return
+		*   const WorkerStats& The worker statistics
+		*/
+		const WorkerStats& getWorkerStats(unsigned int worker) const;
+
+		/** Get the rays cast by all trace workers during the last render, valid once the workers
+		*	have finished
+		* @return
+		*   RayStats The ray counts
+		*/
+		RayStats getRayStats() const;
+
+		/** Get the work done by all trace workers during the last render, valid once the workers
+		*	have finished. The counters read 0 unless built with ST_ENABLE_STATS, the tiles and
+		*	times are always filled in
+		* @return
+		*   RenderStats The work counts
+		*/
+		RenderStats getRenderStats() const;
+
+		/** Get the work done by one trace worker during the last render, valid once the workers
+		*	have finished
+		* @param
+		*   worker The index of the worker
+		* @return
+		*   RenderStats The work counts
+		*/
+		RenderStats getWorkerRenderStats(unsigned int worker) const;
+
+		/** Get the cost of every tile traced in the last render, valid once the workers have
+		*	finished
+		* @param
+		*   records Receives a record per tile, grouped by worker
+		*/
+		void getTileRecords(std::vector<TileRecord>& records) const;
+
+		/** Get where the time of the last render went, valid once the workers have finished
+		* @return
+		*   FrameTimings The timings
+		*/
+		FrameTimings getFrameTimings() const;
+
+		/** Get the heap allocations made during the last render, valid once the workers have
+		*	finished
+		* @return
+		*   RenderAllocationStats The allocation counts
+		*/
+		RenderAllocationStats getAllocationStats() const;
+
+		/** Wait for the trace workers and the render processor to finish the current render
+		*/
+		void waitForWorkers();
+
+		/** Get the frame buffer of the last render, complete once the frame future is ready
+		* @return
+		*   const float* RGB floats stored bottom up, 0 before the first render
+		*/
+		const float* getPixelData() const;
+
+		/** Get the scene of the last render
+		* @return
+		*   const Scene* The scene, 0 before the first render
+		*/
+		const Scene* getScene() const;
+
 		/** Render the scene
 		* @param
 		*   width The viewport width
 		* @param
 		*   height The viewport height
+		* @return
+		*   std::shared_future<void> Becomes ready the moment the last chunk has been traced
 		*/
-		void render(unsigned int width, unsigned int height);
+		std::shared_future<void> render(unsigned int width, unsigned int height);
 
-		/** Render a chunk
+		/** Render a chunk, splitting it if it turns out to be expensive
 		* @param
-		*   startX The starting x index
+		*   chunk The chunk to trace
 		* @param
-		*   startY The starting y index
+		*   worker The index of the worker tracing the chunk
 		*/
-		void traceChunk(unsigned int startX, unsigned int startY);
+		void traceChunk(const ChunkData& chunk, unsigned int worker);
 
-		/** Set context
+		/** Set the presenter that shows chunks as they complete, it must outlive any render using it
+		* @param
+		*   presenter The presenter, 0 to trace without presenting
 		*/
-		void setContext(HDC hDC, HGLRC hRC);
+		void setPresenter(Presenter* presenter);
 
 		/** Get isSceneComplete
 		*/
 		bool getIsSceneComplete();
 
-		// Enqueue a chunk
-		void addTraceableChunk(ChunkData* chunk);
-
-		// Dequeue a chunk
-		ChunkData* getTraceableChunk();
-
-		// Get a piece of render data
-		RenderData* getRenderData();
-
-		// Acquire the render context
-		void acquireContext();
-
-		// Draw a scene
-		void drawToScreen(RenderData* data);
+		// Wait for a piece of render data, returns false once the scene is complete and the queue is drained
+		bool getRenderData(RenderData& data);
 
 	private:
 		/** Calculate the chunk dimensions
@@ -94,49 +353,185 @@ namespace SuperTrace
 		*/
 		void getChunkDimensions(unsigned int tWidth, unsigned int tHeight);
 
-		// Decrement the number of jobs left to handle
-		void decrementJobCount();
+		/** Total up the tile costs of the last render per grid cell, when it used the same grid as
+		*   the render being set up, and clear the records for the new render
+		*/
+		void updateTileCosts();
+
+		/** Submit every chunk of the image to the trace workers
+		*/
+		void submitChunks();
+
+		/** Copy a traced tile from a worker's tile buffer to the frame buffer
+		* @param
+		*   chunk The rows of the tile that were traced
+		* @param
+		*   tile The pixels, rows packed at the tile's width
+		*/
+		void commitTile(const ChunkData& chunk, const float* tile);
+
+		// Count a traced chunk and signal the frame once none remain
+		void completeTile();
 
 		// Add to the render data list
-		void addRenderData(unsigned int startX, unsigned int startY, float* renderData);
+		void addRenderData(const ChunkData& chunk, float* renderData);
+
+		// Present completed chunks as dirty rectangles at the presenter's refresh rate until the scene is complete
+		void presentFrame();
 
 	private:
+		/** State of a trace worker that lasts for one render, carved from the frame arena
+		*/
+		struct TraceScratch
+		{
+			/** Camera rays for one row of a tile, as wide as the widest tile
+			*/
+			Vector3* origins;
+			Vector3* directions;
+
+			/** Pixels of the tile being traced, as big as the largest tile, 0 when tile buffers are off
+			*/
+			float* tile;
+
+			/** Heap allocations made while tracing tiles
+			*/
+			AllocationCount allocations;
+		};
+
 		/** The number of chunks/jobs we want to split the render job into
 		*/
 		unsigned int _numChunks;
 
-		/** The number of threads we will launch
+		/** How the image is split into chunks
+		*/
+		TilingMode _tilingMode;
+
+		/** Target number of tiles per worker for adaptive tiling
 		*/
-		unsigned int _numWorkers;
+		unsigned int _targetTilesPerWorker;
 
-		/** Worker threads
+		/** Cache budget per adaptive tile in bytes
 		*/
-		HANDLE* _workers;
+		unsigned int _tileCacheBudget;
 
-		/** Mutex
+		/** Time after which a tile being traced is split
 		*/
-		CRITICAL_SECTION _renderMutex;
+		double _tileSplitTime;
 
-		/** Job mutex
+		/** Whether camera rays are traced in packets
 		*/
-		CRITICAL_SECTION _jobMutex;
+		bool _packetTracing;
 
-		/** Number of jobs to handle total
+		/** Whether workers trace into tile buffers
 		*/
-		unsigned int _numJobs;
+		bool _tileBuffers;
 
-		/** Array of chunk data
+		/** Whether tiles are handed out most expensive first
 		*/
-		std::queue<ChunkData*> _chunkQueue;
+		bool _tileCostOrdering;
 
-		/** Array of render data
+		/** Seed the scene is created from
 		*/
-		std::queue<RenderData*> _renderQueue;
+		unsigned int _sceneSeed;
 
-		/** Render context values
+		/** Fills each new scene, empty for the default scene
 		*/
-		HDC _hDC;
-		HGLRC _hRC;
+		SceneBuilder _sceneBuilder;
+
+		/** When the current render started
+		*/
+		std::chrono::high_resolution_clock::time_point _renderStart;
+
+		/** Set by the first tile to finish in the current render
+		*/
+		std::atomic<bool> _firstTileDone;
+
+		/** Timings of the current render, each written once by whichever thread reaches that point
+		*/
+		FrameTimings _frameTimings;
+
+		/** Number of tiles split during the current render
+		*/
+		std::atomic<unsigned int> _numSplits;
+
+		/** Rays cast by each trace worker, a worker adds its counts once per chunk
+		*/
+		std::vector<RayStats> _rayStats;
+
+		/** Work counted by each trace worker, a worker adds its thread's counts once per chunk
+		*/
+		std::vector<RenderStats> _renderStats;
+
+		/** Tiles traced by each trace worker, reserved before the render so recording never
+		*	allocates
+		*/
+		std::vector<std::vector<TileRecord> > _tileRecords;
+
+		/** Seconds each cell of the tile grid took in the last render, empty when the grid has
+		*	changed since
+		*/
+		std::vector<double> _tileCosts;
+
+		/** Order the grid cells are submitted in, kept between renders to reuse its memory
+		*/
+		std::vector<unsigned int> _tileOrder;
+
+		/** Frame and tile size the current tile records were made with
+		*/
+		unsigned int _recordedWidth;
+		unsigned int _recordedHeight;
+		unsigned int _recordedTileWidth;
+		unsigned int _recordedTileHeight;
+
+		/** Memory that lives for one render, reset at the start of the next so a render the same
+		*	size as the last takes nothing from the heap
+		*/
+		Arena _frameArena;
+
+		/** Scratch for each trace worker, allocated from the frame arena
+		*/
+		TraceScratch* _traceScratch;
+
+		/** Heap allocations made by render and by the render processor during the last render
+		*/
+		AllocationCount _setupAllocations;
+		AllocationCount _presentAllocations;
+
+		/** Trace workers
+		*/
+		WorkerPool _workerPool;
+
+		/** Render processor thread
+		*/
+		std::thread _renderWorker;
+
+		/** Only taken to put the render processor to sleep and wake it, never to touch the queue
+		*/
+		std::mutex _renderMutex;
+
+		/** Wakes the render processor when render data arrives or the scene completes
+		*/
+		std::condition_variable _renderCondition;
+
+		/** Set while the render processor is asleep or about to sleep, producers only notify then
+		*/
+		std::atomic<bool> _presenterWaiting;
+
+		/** Number of chunks left to trace in the current render
+		*/
+		std::atomic<unsigned int> _remainingTiles;
+
+		/** Fulfilled when the last chunk of the current render has been traced
+		*/
+		std::promise<void> _framePromise;
+
+		/** Traced chunks waiting to be drawn
+		*/
+		MPMCQueue<RenderData> _renderQueue;
+
+		/** Shows completed chunks, may be 0
+		*/
+		Presenter* _presenter;
 
 		/** The chunk width
 		*/
@@ -146,6 +541,11 @@ namespace SuperTrace
 		*/
 		unsigned int _cHeight;
 
+		/** Image dimensions
+		*/
+		unsigned int _width;
+		unsigned int _height;
+
 		/** Global buffer
 		*/
 		float* _pixelData;
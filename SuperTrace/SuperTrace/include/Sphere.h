@@ -20,7 +20,35 @@ namespace SuperTrace
 	public:
 		Sphere(const Matrix44& world, const Vector3& center, float radius);
 
-		bool intersect(const Ray& ray) const;
+		/** Test for an intersection between a ray and this sphere
+		* @param
+		*	ray The ray to test against intersection
+		* @param
+		*	hit The closest hit so far, overwritten if the sphere is hit nearer than hit.t
+		* @return
+		*	bool True if intersection is found, false otherwise
+		*/
+		bool intersect(const Ray& ray, HitRecord& hit) const;
+
+		/** Test the active lanes of a ray packet for intersection
+		* @param
+		*	packet The rays to test
+		* @param
+		*	mask The lanes to test, a bit per lane
+		* @param
+		*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+		* @return
+		*	unsigned int The lanes whose hit was overwritten
+		*/
+		unsigned int intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const;
+
+		/** Any hit test, skips the normal and surface parameterization
+		* @param
+		*	ray The ray to test, only hits within [tMin, tMax] count
+		* @return
+		*	bool True if the sphere blocks the ray
+		*/
+		bool occludes(const Ray& ray) const;
 
 		/** Calculate the surface normal for a given contact point
 		* @param
@@ -30,6 +58,23 @@ namespace SuperTrace
 		*/
 		Vector3 getSurfaceNormal(const Vector3& surfacePoint) const;
 
+		/** Get the world space bounds of the sphere
+		* @return
+		*	AABB A box containing the whole sphere
+		*/
+		AABB getBounds() const;
+
+	private:
+		/** Fill in a hit record for a point on the surface
+		* @param
+		*	contact The point on the surface
+		* @param
+		*	t The distance along the ray to the point
+		* @param
+		*	hit Receives the hit
+		*/
+		void setHit(const Vector3& contact, float t, HitRecord& hit) const;
+
 	private:
 		Vector3 _center;
 
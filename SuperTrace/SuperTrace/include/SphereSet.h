@@ -0,0 +1,218 @@
+//*************************************************************************************************
+// Title: SphereSet.h
+// Description: Many spheres held by a single object, for particle data. Centers and radii are
+//	stored one array per component in the order of the set's own BVH, so each leaf is a contiguous
+//	run that is tested a packet of spheres at a time.
+//*************************************************************************************************
+#ifndef __STSPHERESET_H__
+#define __STSPHERESET_H__
+
+#include <vector>
+#include "BVH.h"
+#include "Object.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Object
+	*	@{
+	*/
+
+	class SphereSet : public Object
+	{
+	public:
+		/** Constructor
+		* @param
+		*	world The world matrix
+		*/
+		SphereSet(const Matrix44& world);
+
+		/** Reserve room for spheres before adding them
+		* @param
+		*	numSpheres The number of spheres
+		*/
+		void reserve(unsigned int numSpheres);
+
+		/** Add a material spheres can refer to
+		* @param
+		*	material The material
+		* @return
+		*	unsigned int The index to pass to addSphere
+		*/
+		unsigned int addMaterial(const Material& material);
+
+		/** Add a sphere, call build once every sphere is added
+		* @param
+		*	center The center
+		* @param
+		*	radius The radius
+		* @param
+		*	material Index of the sphere's material from addMaterial
+		*/
+		void addSphere(const Vector3& center, float radius, unsigned int material);
+
+		/** Set the number of spheres, spheres past the old count are left empty until set. Meant
+		*	for filling a large set from several threads, call build once every sphere is set
+		* @param
+		*	numSpheres The number of spheres
+		*/
+		void resize(unsigned int numSpheres);
+
+		/** Set a sphere added by resize, different spheres may be set from different threads at once
+		* @param
+		*	sphere Index of the sphere
+		* @param
+		*	center The center
+		* @param
+		*	radius The radius
+		* @param
+		*	material Index of the sphere's material from addMaterial
+		*/
+		void setSphere(unsigned int sphere, const Vector3& center, float radius, unsigned int material);
+
+		/** Build the hierarchy over the spheres, which reorders them into leaf order
+		*/
+		void build();
+
+		/** Get the number of spheres
+		* @return
+		*	unsigned int The number of spheres
+		*/
+		unsigned int getNumSpheres() const;
+
+		/** Get the center of a sphere
+		* @param
+		*	sphere Index of the sphere in leaf order
+		* @return
+		*	Vector3 The center
+		*/
+		Vector3 getCenter(unsigned int sphere) const;
+
+		/** Get the radius of a sphere
+		* @param
+		*	sphere Index of the sphere in leaf order
+		* @return
+		*	float The radius
+		*/
+		float getRadius(unsigned int sphere) const;
+
+		/** Find the nearest sphere along a ray
+		* @param
+		*	ray The ray, only hits within [tMin, tMax] count
+		* @param
+		*	t The nearest distance accepted so far, receives the distance to the sphere found
+		* @return
+		*	unsigned int Index of the nearest sphere in leaf order, HitRecord::InvalidPrimitive if
+		*	no sphere is nearer than t
+		*/
+		unsigned int findNearest(const Ray& ray, float& t) const;
+
+		/** Test for an intersection between a ray and the spheres
+		* @param
+		*	ray The ray to test against intersection
+		* @param
+		*	hit The closest hit so far, overwritten if a sphere is hit nearer than hit.t
+		* @return
+		*	bool True if intersection is found, false otherwise
+		*/
+		bool intersect(const Ray& ray, HitRecord& hit) const;
+
+		/** Test the active lanes of a ray packet for intersection
+		* @param
+		*	packet The rays to test
+		* @param
+		*	mask The lanes to test, a bit per lane
+		* @param
+		*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+		* @return
+		*	unsigned int The lanes whose hit was overwritten
+		*/
+		unsigned int intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const;
+
+		/** Any hit test, skips the normal and surface parameterization
+		* @param
+		*	ray The ray to test, only hits within [tMin, tMax] count
+		* @return
+		*	bool True if any sphere blocks the ray
+		*/
+		bool occludes(const Ray& ray) const;
+
+		/** Calculate the surface normal for a given contact point, searches every sphere for the
+		*	one whose surface is nearest the point so hits should use their own normal instead
+		* @param
+		*	surfacePoint The surface point at which to construct a normal
+		* @return
+		*	Vector3 A vector representing a surface normal
+		*/
+		Vector3 getSurfaceNormal(const Vector3& surfacePoint) const;
+
+		/** Get the world space bounds of the set
+		* @return
+		*	AABB A box containing every sphere
+		*/
+		AABB getBounds() const;
+
+		/** Get the bytes used per sphere for its geometry and material index, not counting the
+		*	hierarchy
+		* @return
+		*	unsigned int The bytes per sphere
+		*/
+		static unsigned int getBytesPerSphere();
+
+	private:
+		/** Test a run of spheres against a ray, a packet of spheres at a time
+		* @param
+		*	first The first sphere
+		* @param
+		*	count The number of spheres
+		* @param
+		*	ray The ray
+		* @param
+		*	t The nearest distance accepted so far, shortened by any nearer hit
+		* @return
+		*	unsigned int Index of the nearest sphere hit, HitRecord::InvalidPrimitive if none
+		*/
+		unsigned int intersectRun(unsigned int first, unsigned int count, const Ray& ray, float& t) const;
+
+		/** Fill in a hit record for a point on a sphere
+		* @param
+		*	sphere The sphere that was hit
+		* @param
+		*	contact The point on the surface
+		* @param
+		*	t The distance along the ray to the point
+		* @param
+		*	hit Receives the hit
+		*/
+		void setHit(unsigned int sphere, const Vector3& contact, float t, HitRecord& hit) const;
+
+	private:
+		/** Sphere centers and radii, padded past the last sphere so a packet load never reads out
+		*	of bounds
+		*/
+		std::vector<float> _centerX;
+		std::vector<float> _centerY;
+		std::vector<float> _centerZ;
+		std::vector<float> _radius;
+
+		/** Material index of each sphere
+		*/
+		std::vector<unsigned int> _materialIndices;
+
+		/** Materials the spheres refer to
+		*/
+		std::vector<Material> _materials;
+
+		/** Number of spheres, the arrays above hold padding past it
+		*/
+		unsigned int _numSpheres;
+
+		/** Hierarchy over the spheres, each leaf covers a run of them
+		*/
+		BVH _bvh;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STSPHERESET_H__
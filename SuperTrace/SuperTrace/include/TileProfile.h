@@ -0,0 +1,78 @@
+//*************************************************************************************************
+// Title: TileProfile.h
+// Description: What each traced tile cost, and ways to look at it: a heatmap the size of the
+//	frame and a CSV with a row per tile.
+//*************************************************************************************************
+#ifndef __STTILEPROFILE_H__
+#define __STTILEPROFILE_H__
+
+#include <vector>
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** The cost of one traced tile. A tile split while it was traced gives a record for the
+	*	rows kept and one for each piece handed off
+	*/
+	struct TileRecord
+	{
+		TileRecord()
+			:	startX(0), startY(0), width(0), height(0), worker(0), seconds(0.0), numRays(0)
+		{ }
+
+		TileRecord(unsigned int inStartX, unsigned int inStartY, unsigned int inWidth, unsigned int inHeight, unsigned int inWorker,
+			double inSeconds, unsigned long long inNumRays)
+			:	startX(inStartX), startY(inStartY), width(inWidth), height(inHeight), worker(inWorker), seconds(inSeconds), numRays(inNumRays)
+		{ }
+
+		/** Pixels covered, in raster coordinates
+		*/
+		unsigned int startX;
+		unsigned int startY;
+		unsigned int width;
+		unsigned int height;
+
+		/** The worker that traced the tile
+		*/
+		unsigned int worker;
+
+		/** Wall time from picking the tile up to handing it to the frame buffer
+		*/
+		double seconds;
+
+		/** Camera and shadow rays cast for the tile
+		*/
+		unsigned long long numRays;
+	};
+
+	/** Paint each tile's time per pixel over the frame, from black through red and yellow to
+	*	white at the most expensive tile, with tile edges darkened so the grid stays visible
+	* @param
+	*	records The tiles of a frame
+	* @param
+	*	width The frame width
+	* @param
+	*	height The frame height
+	* @param
+	*	pixels Receives width * height RGB floats stored bottom up, like the frame buffer
+	*/
+	void BuildTileHeatmap(const std::vector<TileRecord>& records, unsigned int width, unsigned int height, float* pixels);
+
+	/** Write the tiles of a frame as CSV, a row per tile
+	* @param
+	*	path The file to write
+	* @param
+	*	records The tiles
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteTileCsv(const char* path, const std::vector<TileRecord>& records);
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STTILEPROFILE_H__
@@ -0,0 +1,190 @@
+//*************************************************************************************************
+// Title: Timeline.h
+// Description: A timeline of what each thread was doing while rendering, written as Chrome
+//	trace-event JSON to open in a trace viewer such as chrome://tracing or Perfetto. Every thread
+//	records spans into a ring of its own, so recording takes no lock and shares no cache line.
+//	Spans are only compiled in when ST_ENABLE_TIMELINE is defined, otherwise they compile to
+//	nothing and the timeline is always empty.
+//*************************************************************************************************
+#ifndef __STTIMELINE_H__
+#define __STTIMELINE_H__
+
+#ifdef ST_ENABLE_TIMELINE
+#include <atomic>
+#endif
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** Rows of the timeline for the threads the renderer owns, worker n takes the row
+	*	TIMELINE_THREAD_WORKER + n
+	*/
+	enum TimelineThread
+	{
+		TIMELINE_THREAD_MAIN = 0,
+		TIMELINE_THREAD_PRESENTER,
+		TIMELINE_THREAD_WORKER
+	};
+
+	/** Check whether timeline spans are compiled in
+	* @return
+	*	bool True when built with ST_ENABLE_TIMELINE
+	*/
+	bool IsTimelineEnabled();
+
+	/** Start recording spans, dropping whatever was recorded before. Call while no render is in
+	*	flight
+	*/
+	void StartTimelineCapture();
+
+	/** Stop recording spans, what was recorded is kept until the next capture starts
+	*/
+	void StopTimelineCapture();
+
+	/** Give the calling thread a row of the timeline. A thread that records a span without one is
+	*	given a row of its own, which is handed on to another such thread once it exits. A row may
+	*	only be held by one running thread at a time
+	* @param
+	*	thread The row, threads that come and go under the same role share one across frames
+	* @param
+	*	name The name shown for the row
+	*/
+	void BindTimelineThread(unsigned int thread, const char* name);
+
+	/** Give the calling thread the row of a trace worker
+	* @param
+	*	worker The worker index
+	*/
+	void BindTimelineWorker(unsigned int worker);
+
+	/** Write the spans of the last capture as Chrome trace-event JSON. Call once the render has
+	*	finished, spans recorded while writing may be torn
+	* @param
+	*	path The file to write
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteTimeline(const char* path);
+
+#ifdef ST_ENABLE_TIMELINE
+	/** Set while a capture is running, spans started outside a capture record nothing
+	*/
+	extern std::atomic<bool> TimelineCapturing;
+
+	/** Get the time spans are measured in
+	* @return
+	*	long long Nanoseconds since the process started
+	*/
+	long long GetTimelineTime();
+
+	/** Add a span to the calling thread's ring, overwriting the oldest once the ring is full
+	* @param
+	*	name The span name, must outlive the capture
+	* @param
+	*	start The start time from GetTimelineTime
+	* @param
+	*	end The end time from GetTimelineTime
+	* @param
+	*	x, y, width, height The tile the span worked on, a width of 0 for none
+	*/
+	void RecordTimelineSpan(const char* name, long long start, long long end, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+	/** A span of the timeline, recorded when it ends or goes out of scope
+	*/
+	class TimelineSpan
+	{
+	public:
+		/** Start a span that is only recorded once it is ended with a name
+		*/
+		TimelineSpan()
+			:	_name(0), _x(0), _y(0), _width(0), _height(0)
+		{
+			restart();
+		}
+
+		/** Start a span, recorded when it goes out of scope
+		* @param
+		*	name The span name, must outlive the capture
+		*/
+		explicit TimelineSpan(const char* name)
+			:	_name(0), _x(0), _y(0), _width(0), _height(0)
+		{
+			restart();
+			_name = _start >= 0 ? name : 0;
+		}
+
+		/** Start a span over a tile, recorded when it goes out of scope
+		* @param
+		*	name The span name, must outlive the capture
+		* @param
+		*	x, y, width, height The tile
+		*/
+		TimelineSpan(const char* name, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+			:	_name(0), _x(x), _y(y), _width(width), _height(height)
+		{
+			restart();
+			_name = _start >= 0 ? name : 0;
+		}
+
+		/** Record the span if it has not been ended
+		*/
+		~TimelineSpan()
+		{
+			if(_name != 0)
+			{
+				RecordTimelineSpan(_name, _start, GetTimelineTime(), _x, _y, _width, _height);
+			}
+		}
+
+		/** Start the span again from now without recording it
+		*/
+		void restart()
+		{
+			_name = 0;
+			_start = TimelineCapturing.load(std::memory_order_relaxed) == true ? GetTimelineTime() : -1;
+		}
+
+		/** Record the span up to now under a name and tile chosen at the end
+		* @param
+		*	name The span name, must outlive the capture
+		* @param
+		*	x, y, width, height The tile
+		*/
+		void end(const char* name, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+		{
+			if(_start >= 0)
+			{
+				RecordTimelineSpan(name, _start, GetTimelineTime(), x, y, width, height);
+			}
+			_name = 0;
+		}
+
+	private:
+		const char* _name;
+		long long _start;
+		unsigned int _x;
+		unsigned int _y;
+		unsigned int _width;
+		unsigned int _height;
+	};
+#else
+	// Spans are compiled out, every member is empty and the arguments are never stored
+	class TimelineSpan
+	{
+	public:
+		TimelineSpan() { }
+		explicit TimelineSpan(const char*) { }
+		TimelineSpan(const char*, unsigned int, unsigned int, unsigned int, unsigned int) { }
+		void restart() { }
+		void end(const char*, unsigned int, unsigned int, unsigned int, unsigned int) { }
+	};
+#endif
+
+	/** @} */
+
+}	// Namespace
+
+#endif // __STTIMELINE_H__
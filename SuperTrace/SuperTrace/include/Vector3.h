@@ -6,6 +6,10 @@
 #ifndef __STVECTOR3_H__
 #define __STVECTOR3_H__
 
+#include <assert.h>
+#include <math.h>
+#include "MathKernels.h"
+
 namespace SuperTrace
 {
 	/** \addtogroup Math
@@ -17,7 +21,7 @@ namespace SuperTrace
 	public:
 		/** Default constructor
 		*/
-		Vector3();
+		constexpr Vector3();
 
 		/** Constructor
 		* @param
@@ -27,7 +31,7 @@ namespace SuperTrace
 		* @param
 		*   z The z coordinate
 		*/
-		Vector3(float x, float y, float z);
+		constexpr Vector3(float x, float y, float z);
 
 		/** Constructor
 		* @param
@@ -35,18 +39,6 @@ namespace SuperTrace
 		*/
 		Vector3(float* v);
 
-		/** Copy constructor
-		*/
-		Vector3(const Vector3& v);
-
-		/** Destructor
-		*/
-		~Vector3();
-
-		/** Assignment operator
-		*/
-		Vector3& operator=(const Vector3& v);
-
 		/** Equivalence operator
 		*/
 		bool operator==(const Vector3& v) const;
@@ -203,19 +195,19 @@ namespace SuperTrace
 		* @return
 		*	float The x value of the vector
 		*/
-		float getX() const;
+		constexpr float getX() const;
 
 		/** Get the y value
 		* @return
 		*	float The y value of the vector
 		*/
-		float getY() const;
+		constexpr float getY() const;
 
 		/** Get the z value
 		* @return
 		*	float The z value of the vector
 		*/
-		float getZ() const;
+		constexpr float getZ() const;
 
 		/** Get a value from the vector by index
 		* @param
@@ -234,7 +226,8 @@ namespace SuperTrace
 		float operator[](int i) const;
 
 	private:
-		// The definition of the data
+		// The definition of the data, padded to four floats so the kernels can load it whole. The
+		// padding is always 0
 		union
 		{
 			struct
@@ -242,13 +235,336 @@ namespace SuperTrace
 				float _x;
 				float _y;
 				float _z;
+				float _w;
 			};
-			float _f[3];
+			float _f[4];
 		};
 	};
 
+	/** Default constructor
+	*/
+	constexpr Vector3::Vector3()
+		:	_x(0.0f),
+			_y(0.0f),
+			_z(0.0f),
+			_w(0.0f)
+	{ }
+
+	/** Constructor
+	* @param
+	*   x The x coordinate
+	* @param
+	*   y The y coordinate
+	* @param
+	*   z The z coordinate
+	*/
+	constexpr Vector3::Vector3(float x, float y, float z)
+		:	_x(x),
+			_y(y),
+			_z(z),
+			_w(0.0f)
+	{ }
+
+	/** Constructor
+	* @param
+	*	v An array of three floats
+	*/
+	inline Vector3::Vector3(float* v)
+		:	_x(v[0]),
+			_y(v[1]),
+			_z(v[2]),
+			_w(0.0f)
+	{ }
+
+	/** Equivalence operator
+	*/
+	inline bool Vector3::operator==(const Vector3& v) const
+	{
+		return _x == v._x && _y == v._y && _z == v._z;
+	}
+
+	/** Non equivalence operator
+	*/
+	inline bool Vector3::operator!=(const Vector3& v) const
+	{
+		return _x != v._x || _y != v._y || _z != v._z;
+	}
+
+	/** Addition operator
+	* @param
+	*   vec The vector to add
+	* @return
+	*   Vector3 The sum of two vectors
+	*/
+	inline Vector3 Vector3::operator+(const Vector3& v) const
+	{
+		return Vector3(_x + v._x, _y + v._y, _z + v._z);
+	}
+
+	/** Addition operator
+	* @param
+	*   vec The vector to add
+	* @return
+	*   Vector3& The sum of two vectors
+	*/
+	inline Vector3& Vector3::operator+=(const Vector3& v)
+	{
+		_x += v._x;
+		_y += v._y;
+		_z += v._z;
+		return *this;
+	}
+
+	/** Negate the vector
+	* @return
+	*	Vector3 The negated vector
+	*/
+	inline Vector3 Vector3::operator-() const
+	{
+		return Vector3(-_x, -_y, -_z);
+	}
+
+	/** Subtraction operator
+	* @param
+	*   vec The vector to subtract
+	* @return
+	*   Vector3 The difference of two vectors
+	*/
+	inline Vector3 Vector3::operator-(const Vector3& v) const
+	{
+		return Vector3(_x - v._x, _y - v._y, _z - v._z);
+	}
+
+	/** Subtraction operator
+	* @param
+	*   vec The vector to subtract
+	* @return
+	*   Vector3& The difference of two vectors
+	*/
+	inline Vector3& Vector3::operator-=(const Vector3& v)
+	{
+		_x -= v._x;
+		_y -= v._y;
+		_z -= v._z;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3 The scaled vector
+	*/
+	inline Vector3 Vector3::operator*(float scale) const
+	{
+		return Vector3(_x * scale, _y * scale, _z * scale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @param
+	*	vec The vector to scale
+	* @return
+	*	Vector3 The scaled vector
+	*/
+	inline Vector3 operator*(float scale, const Vector3& v)
+	{
+		return Vector3(v._x * scale, v._y * scale, v._z * scale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3& The scaled vector
+	*/
+	inline Vector3& Vector3::operator*=(float scale)
+	{
+		_x *= scale;
+		_y *= scale;
+		_z *= scale;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3 The scaled vector
+	*/
+	inline Vector3 Vector3::operator/(float scale) const
+	{
+		float mScale = 1.0f / scale;
+		return Vector3(_x * mScale, _y * mScale, _z * mScale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3& The scaled vector
+	*/
+	inline Vector3& Vector3::operator/=(float scale)
+	{
+		float mScale = 1.0f / scale;
+		_x *= mScale;
+		_y *= mScale;
+		_z *= mScale;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3 The scaled vector
+	*/
+	inline Vector3 Vector3::operator/(const Vector3& scale) const
+	{
+		return Vector3(_x / scale._x, _y / scale._y, _z / scale._z);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3& The scaled vector
+	*/
+	inline Vector3& Vector3::operator/=(const Vector3& scale)
+	{
+		_x /= scale._x;
+		_y /= scale._y;
+		_z /= scale._z;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	base The base value (identical across vector)
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector3 The scaled vector
+	*/
+	inline Vector3 operator/(float base, const Vector3& scale)
+	{
+		return Vector3(base / scale._x, base / scale._y, base / scale._z);
+	}
+
+	/** Dot product
+	* @param
+	*	v The vector with which to take the dot product
+	* @return 
+	*	float The dot product
+	*/
+	inline float Vector3::dot(const Vector3& v) const
+	{
+		return MathKernels::Dot3(_f, v._f);
+	}
+
+	/** Cross product
+	* @param
+	*	v The vector with which to cross
+	* @return
+	*	Vector3 The cross product
+	*/
+	inline Vector3 Vector3::cross(const Vector3& v) const
+	{
+		Vector3 r;
+		MathKernels::Cross3(_f, v._f, r._f);
+		return r;
+	}
+
+	/** The squared length of the vector
+	* @return
+	*	float The squared length of the vector
+	*/
+	inline float Vector3::lengthSqr() const
+	{
+		return MathKernels::Dot3(_f, _f);
+	}
+
+	/** The length of the vector
+	* @return
+	*	float The length of the vector
+	*/
+	inline float Vector3::length() const
+	{
+		return sqrtf(MathKernels::Dot3(_f, _f));
+	}
+
+	/** Normalize the vector
+	*/
+	inline void Vector3::normalize()
+	{
+		MathKernels::Normalize3(_f);
+	}
+
+	/** Return a normalized version of the vector
+	* @return
+	*	Vector3 A normalized copy of this vector
+	*/
+	inline Vector3 Vector3::normal() const
+	{
+		Vector3 v = *this;
+		v.normalize();
+		return v;
+	}
+
+	/** Get the x value
+	* @return
+	*	float The x value of the vector
+	*/
+	constexpr float Vector3::getX() const
+	{
+		return _x;
+	}
+
+	/** Get the y value
+	* @return
+	*	float The y value of the vector
+	*/
+	constexpr float Vector3::getY() const
+	{
+		return _y;
+	}
+
+	/** Get the z value
+	* @return
+	*	float The z value of the vector
+	*/
+	constexpr float Vector3::getZ() const
+	{
+		return _z;
+	}
+
+	/** Get a value from the vector by index
+	* @param
+	*	index The index of the desired value, in the order 0=>x, 1=>y, 2=>z
+	* @return
+	*	float The value corresponding to the specified index
+	*/
+	inline float Vector3::operator[](unsigned int i) const
+	{
+		assert(i < 3);
+		return _f[i];
+	}
+
+	/** Get a value from the vector by index
+	* @param
+	*	index The index of the desired value, in the order 0=>x, 1=>y, 2=>z
+	* @return
+	*	float The value corresponding to the specified index
+	*/
+	inline float Vector3::operator[](int i) const
+	{
+		assert(i < 3 && i > -1);
+		return _f[i];
+	}
+
 	/** @} */
 
-}   // Namespace
+}	// Namespace
 
 #endif // __STVECTOR3_H__
@@ -6,6 +6,10 @@
 #ifndef __STVECTOR4_H__
 #define __STVECTOR4_H__
 
+#include <assert.h>
+#include <math.h>
+#include "MathKernels.h"
+
 namespace SuperTrace
 {
 	/** \addtogroup Math
@@ -17,7 +21,7 @@ namespace SuperTrace
 	public:
 		/** Default constructor
 		*/
-		Vector4();
+		constexpr Vector4();
 
 		/** Constructor
 		* @param
@@ -29,7 +33,7 @@ namespace SuperTrace
 		* @param
 		*	w The w coordinate
 		*/
-		Vector4(float x, float y, float z, float w);
+		constexpr Vector4(float x, float y, float z, float w);
 
 		/** Constructor
 		* @param
@@ -37,18 +41,6 @@ namespace SuperTrace
 		*/
 		Vector4(float* v);
 
-		/** Copy constructor
-		*/
-		Vector4(const Vector4& v);
-
-		/** Destructor
-		*/
-		~Vector4();
-
-		/** Assignment operator
-		*/
-		Vector4& operator=(const Vector4& v);
-
 		/** Equivalence operator
 		*/
 		bool operator==(const Vector4& v) const;
@@ -199,25 +191,25 @@ namespace SuperTrace
 		* @return
 		*	float The x value of the vector
 		*/
-		float getX() const;
+		constexpr float getX() const;
 
 		/** Get the y value
 		* @return
 		*	float The y value of the vector
 		*/
-		float getY() const;
+		constexpr float getY() const;
 
 		/** Get the z value
 		* @return
 		*	float The z value of the vector
 		*/
-		float getZ() const;
+		constexpr float getZ() const;
 
 		/** Get the w value
 		* @return
 		*	float The w value of the vector
 		*/
-		float getW() const;
+		constexpr float getW() const;
 
 		/** Get a value from the vector by index
 		* @param
@@ -250,8 +242,335 @@ namespace SuperTrace
 		};
 	};
 
+	/** Default constructor
+	*/
+	constexpr Vector4::Vector4()
+		:	_x(0.0f),
+			_y(0.0f),
+			_z(0.0f),
+			_w(0.0f)
+	{ }
+
+	/** Constructor
+	* @param
+	*   x The x coordinate
+	* @param
+	*   y The y coordinate
+	* @param
+	*   z The z coordinate
+	* @param
+	*	w The w coordinate
+	*/
+	constexpr Vector4::Vector4(float x, float y, float z, float w)
+		:	_x(x),
+			_y(y),
+			_z(z),
+			_w(w)
+	{ }
+
+	/** Constructor
+	* @param
+	*	v An array of three floats
+	*/
+	inline Vector4::Vector4(float* v)
+		:	_x(v[0]),
+			_y(v[1]),
+			_z(v[2]),
+			_w(v[3])
+	{ }
+
+	/** Equivalence operator
+	*/
+	inline bool Vector4::operator==(const Vector4& v) const
+	{
+		return _x == v._x && _y == v._y && _z == v._z && _w == v._w;
+	}
+
+	/** Non equivalence operator
+	*/
+	inline bool Vector4::operator!=(const Vector4& v) const
+	{
+		return _x != v._x || _y != v._y || _z != v._z || _w != v._w;
+	}
+
+	/** Addition operator
+	* @param
+	*   vec The vector to add
+	* @return
+	*   Vector4 The sum of two vectors
+	*/
+	inline Vector4 Vector4::operator+(const Vector4& v) const
+	{
+		return Vector4(_x + v._x, _y + v._y, _z + v._z, _w + v._w);
+	}
+
+	/** Addition operator
+	* @param
+	*   vec The vector to add
+	* @return
+	*   Vector4& The sum of two vectors
+	*/
+	inline Vector4& Vector4::operator+=(const Vector4& v)
+	{
+		_x += v._x;
+		_y += v._y;
+		_z += v._z;
+		_w += v._w;
+		return *this;
+	}
+
+	/** Subtraction operator
+	* @param
+	*   vec The vector to subtract
+	* @return
+	*   Vector4 The difference of two vectors
+	*/
+	inline Vector4 Vector4::operator-(const Vector4& v) const
+	{
+		return Vector4(_x - v._x, _y - v._y, _z - v._z, _w - v._w);
+	}
+
+	/** Subtraction operator
+	* @param
+	*   vec The vector to subtract
+	* @return
+	*   Vector4& The difference of two vectors
+	*/
+	inline Vector4& Vector4::operator-=(const Vector4& v)
+	{
+		_x -= v._x;
+		_y -= v._y;
+		_z -= v._z;
+		_w -= v._w;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 Vector4::operator*(const Vector4& scale) const
+	{
+		return Vector4(_x * scale._x, _y * scale._y, _z * scale._z, _w * scale._w);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 Vector4::operator*(float scale) const
+	{
+		return Vector4(_x * scale, _y * scale, _z * scale, _w * scale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @param
+	*	vec The vector to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 operator*(float scale, const Vector4& v)
+	{
+		return Vector4(v._x * scale, v._y * scale, v._z * scale, v._w * scale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4& The scaled vector
+	*/
+	inline Vector4& Vector4::operator*=(float scale)
+	{
+		_x *= scale;
+		_y *= scale;
+		_z *= scale;
+		_w *= scale;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 Vector4::operator/(float scale) const
+	{
+		float mScale = 1.0f / scale;
+		return Vector4(_x * mScale, _y * mScale, _z * mScale, _w * mScale);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4& The scaled vector
+	*/
+	inline Vector4& Vector4::operator/=(float scale)
+	{
+		float mScale = 1.0f / scale;
+		_x *= mScale;
+		_y *= mScale;
+		_z *= mScale;
+		_w *= mScale;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 Vector4::operator/(const Vector4& scale) const
+	{
+		return Vector4(_x / scale._x, _y / scale._y, _z / scale._z, _w / scale._w);
+	}
+
+	/** Scale operator
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4& The scaled vector
+	*/
+	inline Vector4& Vector4::operator/=(const Vector4& scale)
+	{
+		_x /= scale._x;
+		_y /= scale._y;
+		_z /= scale._z;
+		_w /= scale._w;
+		return *this;
+	}
+
+	/** Scale operator
+	* @param
+	*	base The base value (identical across vector)
+	* @param
+	*	scale The value by which to scale
+	* @return
+	*	Vector4 The scaled vector
+	*/
+	inline Vector4 operator/(float base, const Vector4& scale)
+	{
+		return Vector4(base / scale._x, base / scale._y, base / scale._z, base / scale._w);
+	}
+
+	/** Dot product
+	* @param
+	*	v The vector with which to take the dot product
+	* @return 
+	*	float The dot product
+	*/
+	inline float Vector4::dot(const Vector4& v) const
+	{
+		return MathKernels::Dot4(_f, v._f);
+	}
+
+	/** The squared length of the vector
+	* @return
+	*	float The squared length of the vector
+	*/
+	inline float Vector4::lengthSqr() const
+	{
+		return MathKernels::Dot4(_f, _f);
+	}
+
+	/** The length of the vector
+	* @return
+	*	float The length of the vector
+	*/
+	inline float Vector4::length() const
+	{
+		return sqrtf(MathKernels::Dot4(_f, _f));
+	}
+
+	/** Normalize the vector
+	*/
+	inline void Vector4::normalize()
+	{
+		MathKernels::Normalize4(_f);
+	}
+
+	/** Return a normalized version of the vector
+	* @return
+	*	Vector4 A normalized copy of this vector
+	*/
+	inline Vector4 Vector4::normal() const
+	{
+		Vector4 v = *this;
+		v.normalize();
+		return v;
+	}
+
+	/** Get the x value
+	* @return
+	*	float The x value of the vector
+	*/
+	constexpr float Vector4::getX() const
+	{
+		return _x;
+	}
+
+	/** Get the y value
+	* @return
+	*	float The y value of the vector
+	*/
+	constexpr float Vector4::getY() const
+	{
+		return _y;
+	}
+
+	/** Get the z value
+	* @return
+	*	float The z value of the vector
+	*/
+	constexpr float Vector4::getZ() const
+	{
+		return _z;
+	}
+
+	/** Get the w value
+	* @return
+	*	float The w value of the vector
+	*/
+	constexpr float Vector4::getW() const
+	{
+		return _w;
+	}
+
+	/** Get a value from the vector by index
+	* @param
+	*	index The index of the desired value, in the order 0=>x, 1=>y, 2=>z
+	* @return
+	*	float The value corresponding to the specified index
+	*/
+	inline float Vector4::operator[](unsigned int i) const
+	{
+		assert(i < 4);
+		return _f[i];
+	}
+
+	/** Get a value from the vector by index
+	* @param
+	*	index The index of the desired value, in the order 0=>x, 1=>y, 2=>z
+	* @return
+	*	float The value corresponding to the specified index
+	*/
+	inline float Vector4::operator[](int i) const
+	{
+		assert(i < 4 && i > -1);
+		return _f[i];
+	}
+
 	/** @} */
 
-}   // Namespace
+}	// Namespace
 
 #endif // __STVECTOR4_H__
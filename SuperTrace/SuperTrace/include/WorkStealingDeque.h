@@ -0,0 +1,246 @@
+//*************************************************************************************************
+// Title: WorkStealingDeque.h
+// Description: A bounded lock-free work-stealing deque (Chase-Lev, with the memory orderings of
+//	Le et al. 2013). The owning thread pushes and pops at the bottom, newest first, while other
+//	threads steal from the top, the end furthest from what the owner is working on.
+//*************************************************************************************************
+#ifndef __STWORKSTEALINGDEQUE_H__
+#define __STWORKSTEALINGDEQUE_H__
+
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	template <typename T>
+	class WorkStealingDeque
+	{
+		// Elements are copied through the cells a word at a time
+		static_assert(std::is_trivially_copyable<T>::value == true, "WorkStealingDeque elements must be trivially copyable");
+
+	public:
+		/** Default constructor, the deque has no capacity until reset is called
+		*/
+		WorkStealingDeque()
+			:	_cells(0), _mask(0), _top(0), _bottom(0)
+		{ }
+
+		/** Destructor
+		*/
+		~WorkStealingDeque()
+		{
+			delete[] _cells;
+		}
+
+		/** Empty the deque and resize it, must not be called while other threads use the deque
+		* @param
+		*	capacity The minimum number of elements the deque can hold, rounded up to a power of two
+		*/
+		void reset(size_t capacity)
+		{
+			size_t size = 2;
+			while(size < capacity)
+			{
+				size <<= 1;
+			}
+
+			if(size != _mask + 1)
+			{
+				delete[] _cells;
+				_cells = new Cell[size];
+				_mask = size - 1;
+			}
+			_top.store(0, std::memory_order_relaxed);
+			_bottom.store(0, std::memory_order_relaxed);
+		}
+
+		/** Push an element at the top, behind everything already queued. Only for filling the deque
+		*	before any other thread uses it
+		* @param
+		*	value The element to push
+		* @return
+		*	bool False if the deque is full
+		*/
+		bool pushTop(const T& value)
+		{
+			ptrdiff_t t = _top.load(std::memory_order_relaxed);
+			if(_cells == 0 || _bottom.load(std::memory_order_relaxed) - t > static_cast<ptrdiff_t>(_mask))
+			{
+				return false;
+			}
+			--t;
+
+			// Indices run below zero as the top grows, the mask still wraps them into the ring
+			_cells[static_cast<size_t>(t) & _mask].store(value);
+			_top.store(t, std::memory_order_relaxed);
+			return true;
+		}
+
+		/** Push an element at the bottom, only called by the owning thread
+		* @param
+		*	value The element to push
+		* @return
+		*	bool False if the deque is full
+		*/
+		bool push(const T& value)
+		{
+			ptrdiff_t b = _bottom.load(std::memory_order_relaxed);
+			ptrdiff_t t = _top.load(std::memory_order_acquire);
+			if(_cells == 0 || b - t > static_cast<ptrdiff_t>(_mask))
+			{
+				return false;
+			}
+
+			_cells[static_cast<size_t>(b) & _mask].store(value);
+
+			// Publish the element with the new bottom, thieves read the bottom before the cell
+			_bottom.store(b + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Pop the newest element from the bottom, only called by the owning thread
+		* @param
+		*	value Receives the popped element
+		* @return
+		*	bool False if the deque is empty or a thief took the last element first
+		*/
+		bool pop(T& value)
+		{
+			ptrdiff_t b = _bottom.load(std::memory_order_relaxed) - 1;
+			_bottom.store(b, std::memory_order_relaxed);
+
+			// Reserve the bottom element before looking at the top, thieves do the opposite
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			ptrdiff_t t = _top.load(std::memory_order_relaxed);
+			if(t > b)
+			{
+				// Empty, put the bottom back
+				_bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			value = _cells[static_cast<size_t>(b) & _mask].load();
+			if(t < b)
+			{
+				// More than one element left, no thief can reach this one
+				return true;
+			}
+
+			// The last element, race the thieves for it through the top
+			bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			_bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+
+		/** Steal the element at the top, called by any thread but the owner
+		* @param
+		*	value Receives the stolen element
+		* @return
+		*	bool False if the deque is empty or another thread took the element first
+		*/
+		bool steal(T& value)
+		{
+			ptrdiff_t t = _top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			ptrdiff_t b = _bottom.load(std::memory_order_acquire);
+			if(t >= b)
+			{
+				return false;
+			}
+
+			// Read before claiming, once the top moves the owner may reuse the cell. A copy read while
+			// the cell is reused is thrown away because the claim then fails
+			T stolen = _cells[static_cast<size_t>(t) & _mask].load();
+			if(_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed) == false)
+			{
+				return false;
+			}
+
+			value = stolen;
+			return true;
+		}
+
+		/** Check whether the deque looks empty, exact only when no other thread is using it
+		* @return
+		*	bool True if no element was found between the top and the bottom
+		*/
+		bool isEmpty() const
+		{
+			return _top.load(std::memory_order_acquire) >= _bottom.load(std::memory_order_acquire);
+		}
+
+	private:
+		// Copying would duplicate the ring
+		WorkStealingDeque(const WorkStealingDeque&);
+		WorkStealingDeque& operator=(const WorkStealingDeque&);
+
+		/** A slot in the ring. A thief may read a slot while the owner reuses it, so the element is
+		*	copied in and out with relaxed atomic words rather than plain stores
+		*/
+		struct Cell
+		{
+			static const size_t NumWords = (sizeof(T) + sizeof(unsigned int) - 1) / sizeof(unsigned int);
+
+			void store(const T& value)
+			{
+				unsigned int copy[NumWords] = { 0 };
+				memcpy(copy, &value, sizeof(T));
+				for(size_t i = 0; i < NumWords; ++i)
+				{
+					words[i].store(copy[i], std::memory_order_relaxed);
+				}
+			}
+
+			T load() const
+			{
+				unsigned int copy[NumWords];
+				for(size_t i = 0; i < NumWords; ++i)
+				{
+					copy[i] = words[i].load(std::memory_order_relaxed);
+				}
+
+				T value;
+				memcpy(&value, copy, sizeof(T));
+				return value;
+			}
+
+			std::atomic<unsigned int> words[NumWords];
+		};
+
+		// Keep the thieves' end and the owner's end on separate cache lines
+		static const size_t CacheLineSize = 64;
+
+		/** The ring of elements, the live ones run from the top up to the bottom
+		*/
+		Cell* _cells;
+
+		/** The ring size minus one
+		*/
+		size_t _mask;
+
+		char _pad0[CacheLineSize];
+
+		/** Index of the oldest element, advanced by thieves and by the owner taking the last element
+		*/
+		std::atomic<ptrdiff_t> _top;
+
+		char _pad1[CacheLineSize - sizeof(std::atomic<ptrdiff_t>)];
+
+		/** Index one past the newest element, only written by the owner
+		*/
+		std::atomic<ptrdiff_t> _bottom;
+
+		char _pad2[CacheLineSize - sizeof(std::atomic<ptrdiff_t>)];
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STWORKSTEALINGDEQUE_H__
@@ -0,0 +1,229 @@
+//*************************************************************************************************
+// Title: WorkerPool.h
+// Description: A portable pool of tile workers. Each worker owns a lock-free deque of chunks,
+//	taking its own tiles from the bottom, and steals from the top of the other workers' deques when
+//	its own runs dry.
+//*************************************************************************************************
+#ifndef __STWORKERPOOL_H__
+#define __STWORKERPOOL_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ChunkData.h"
+#include "WorkStealingDeque.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Scene
+	*	@{
+	*/
+
+	/** Load balance statistics gathered by a single worker
+	*/
+	struct WorkerStats
+	{
+		WorkerStats()
+			:	busySeconds(0.0), idleSeconds(0.0), tilesExecuted(0), tilesStolen(0)
+		{ }
+
+		/** Time spent executing tiles
+		*/
+		double busySeconds;
+
+		/** Time spent looking for work
+		*/
+		double idleSeconds;
+
+		/** Number of tiles executed by the worker
+		*/
+		unsigned int tilesExecuted;
+
+		/** Number of those tiles that were stolen from another worker
+		*/
+		unsigned int tilesStolen;
+	};
+
+	class WorkerPool
+	{
+	public:
+		/** Function executed for each tile, receives the tile and the index of the executing worker
+		*/
+		typedef std::function<void(const ChunkData&, unsigned int)> TileFunction;
+
+		/** Default constructor
+		*/
+		WorkerPool();
+
+		/** Destructor
+		*/
+		~WorkerPool();
+
+		/** Set the number of workers used by the next call to start
+		* @param
+		*	numWorkers The number of workers, 0 to size the pool from the hardware concurrency
+		*/
+		void setNumWorkers(unsigned int numWorkers);
+
+		/** Get the number of workers the pool will run with
+		* @return
+		*	unsigned int The number of workers
+		*/
+		unsigned int getNumWorkers() const;
+
+		/** Empty the worker deques and size them for a render, must be called before submitting
+		* @param
+		*	numTiles The number of tiles that will be submitted
+		* @param
+		*	spareTiles Extra room per worker for tiles pushed while the pool runs
+		*/
+		void reserve(unsigned int numTiles, unsigned int spareTiles);
+
+		/** Submit a tile before the pool is started, tiles are distributed round robin and each
+		*	worker takes its share in the order it was submitted
+		* @param
+		*	chunk The tile to submit
+		*/
+		void submit(const ChunkData& chunk);
+
+		/** Push a tile onto the bottom of a worker's own deque from within a running tile function,
+		*	the worker takes it next unless a thief gets to it first
+		* @param
+		*	worker The index of the calling worker
+		* @param
+		*	chunk The tile to push
+		* @return
+		*	bool False if the worker's deque is full, the caller keeps the work
+		*/
+		bool push(unsigned int worker, const ChunkData& chunk);
+
+		/** Start the workers, they exit once every submitted and pushed tile has been executed
+		* @param
+		*	tileFunction The function to execute for each tile
+		*/
+		void start(const TileFunction& tileFunction);
+
+		/** Wait for all workers to exit
+		*/
+		void join();
+
+		/** Get the statistics for a worker, only valid once the pool has been joined
+		* @param
+		*	worker The worker index
+		* @return
+		*	const WorkerStats& The statistics for the worker
+		*/
+		const WorkerStats& getWorkerStats(unsigned int worker) const;
+
+	private:
+		/** The state owned by a single worker
+		*/
+		struct Worker
+		{
+			/** Tiles owned by this worker, the owner works from the bottom and thieves from the top
+			*/
+			WorkStealingDeque<ChunkData> deque;
+
+			/** The worker thread
+			*/
+			std::thread thread;
+
+			/** Load balance statistics
+			*/
+			WorkerStats stats;
+		};
+
+		/** Allocate the workers if the requested count changed
+		*/
+		void allocateWorkers();
+
+		/** Main loop for a worker thread
+		* @param
+		*	index The worker index
+		*/
+		void workerLoop(unsigned int index);
+
+		/** Pop the newest tile from the bottom of the worker's own deque
+		* @param
+		*	index The worker index
+		* @param
+		*	chunk The popped tile
+		* @return
+		*	bool True if a tile was found
+		*/
+		bool popLocal(unsigned int index, ChunkData& chunk);
+
+		/** Steal a tile from the top of another worker's deque
+		* @param
+		*	index The index of the stealing worker
+		* @param
+		*	chunk The stolen tile
+		* @return
+		*	bool True if a tile was found
+		*/
+		bool steal(unsigned int index, ChunkData& chunk);
+
+		/** Check whether any worker's deque holds a tile
+		* @return
+		*	bool True if a tile was found
+		*/
+		bool hasQueuedTiles() const;
+
+		/** Block an idle worker until a tile is pushed or the last tile is done
+		*/
+		void waitForWork();
+
+		/** Wake every blocked worker
+		*/
+		void wakeIdleWorkers();
+
+	private:
+		/** The requested number of workers, 0 for hardware concurrency
+		*/
+		unsigned int _requestedWorkers;
+
+		/** The number of allocated workers
+		*/
+		unsigned int _numWorkers;
+
+		/** Worker state
+		*/
+		Worker* _workers;
+
+		/** Next worker to receive a submitted tile
+		*/
+		unsigned int _nextSubmit;
+
+		/** Number of tiles that have been submitted or pushed and not yet executed
+		*/
+		std::atomic<unsigned int> _pending;
+
+		/** Number of workers blocked in waitForWork
+		*/
+		std::atomic<unsigned int> _numIdle;
+
+		/** Bumped every time the idle workers are woken, guarded by _idleMutex
+		*/
+		unsigned int _idleEpoch;
+
+		/** Guards the idle workers' wait
+		*/
+		std::mutex _idleMutex;
+
+		/** Signalled when a tile is pushed while workers are idle, or the last tile is done
+		*/
+		std::condition_variable _idleCondition;
+
+		/** The function executed for each tile
+		*/
+		TileFunction _tileFunction;
+	};
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STWORKERPOOL_H__
@@ -76,7 +76,7 @@ namespace SuperTrace
 	* @param 
 	*	tMin The new tMin value
 	*/
-	void Ray::setTMin(float tMin) const
+	void Ray::setTMin(float tMin)
 	{
 		_tMin = tMin;
 	}
@@ -94,7 +94,7 @@ namespace SuperTrace
 	* @param 
 	*	tMax The new tMax value
 	*/
-	void Ray::setTMax(float tMax) const
+	void Ray::setTMax(float tMax)
 	{
 		_tMax = tMax;
 	}
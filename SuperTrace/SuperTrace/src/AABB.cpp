@@ -0,0 +1,103 @@
+//*************************************************************************************************
+// Title: AABB.cpp
+// Description: An axis aligned bounding box, used to bound objects for the acceleration structure.
+//*************************************************************************************************
+#include "AABB.h"
+#include <float.h>
+#include <algorithm>
+
+namespace SuperTrace
+{
+	/** Default constructor, the box is empty until it is grown
+	*/
+	AABB::AABB()
+		:	_min(FLT_MAX, FLT_MAX, FLT_MAX), _max(-FLT_MAX, -FLT_MAX, -FLT_MAX)
+	{ }
+
+	/** Constructor
+	* @param
+	*	min The minimum corner
+	* @param
+	*	max The maximum corner
+	*/
+	AABB::AABB(const Vector3& min, const Vector3& max)
+		:	_min(min), _max(max)
+	{ }
+
+	/** Grow the box to contain a point
+	* @param
+	*	point The point to contain
+	*/
+	void AABB::grow(const Vector3& point)
+	{
+		_min = Vector3(std::min(_min.getX(), point.getX()), std::min(_min.getY(), point.getY()), std::min(_min.getZ(), point.getZ()));
+		_max = Vector3(std::max(_max.getX(), point.getX()), std::max(_max.getY(), point.getY()), std::max(_max.getZ(), point.getZ()));
+	}
+
+	/** Grow the box to contain another box
+	* @param
+	*	box The box to contain
+	*/
+	void AABB::grow(const AABB& box)
+	{
+		if(box.isEmpty() == true)
+		{
+			return;
+		}
+
+		grow(box._min);
+		grow(box._max);
+	}
+
+	/** Get the minimum corner
+	* @return
+	*	const Vector3& The minimum corner
+	*/
+	const Vector3& AABB::getMin() const
+	{
+		return _min;
+	}
+
+	/** Get the maximum corner
+	* @return
+	*	const Vector3& The maximum corner
+	*/
+	const Vector3& AABB::getMax() const
+	{
+		return _max;
+	}
+
+	/** Get the center of the box
+	* @return
+	*	Vector3 The center
+	*/
+	Vector3 AABB::getCenter() const
+	{
+		return (_min + _max) * 0.5f;
+	}
+
+	/** Get the surface area of the box
+	* @return
+	*	float The surface area, 0 for an empty box
+	*/
+	float AABB::getSurfaceArea() const
+	{
+		if(isEmpty() == true)
+		{
+			return 0.0f;
+		}
+
+		Vector3 extent = _max - _min;
+		return 2.0f * (extent.getX() * extent.getY() + extent.getY() * extent.getZ() + extent.getZ() * extent.getX());
+	}
+
+	/** Check whether the box contains nothing
+	* @return
+	*	bool True if the box has never been grown
+	*/
+	bool AABB::isEmpty() const
+	{
+		return _min.getX() > _max.getX() || _min.getY() > _max.getY() || _min.getZ() > _max.getZ();
+	}
+
+}	// Namespace
@@ -0,0 +1,133 @@
+//*************************************************************************************************
+// Title: AllocationTracker.cpp
+// Description: Counts heap allocations made through operator new. Counting replaces the global
+//	operator new and delete, so it is only compiled in when ST_TRACK_ALLOCATIONS is defined,
+//	otherwise every count reads 0.
+//*************************************************************************************************
+#include "AllocationTracker.h"
+
+#ifdef ST_TRACK_ALLOCATIONS
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace
+{
+	// Each thread counts its own allocations, the process totals are shared
+	thread_local unsigned long long ThreadAllocations = 0;
+	thread_local unsigned long long ThreadBytes = 0;
+	std::atomic<unsigned long long> ProcessAllocations(0);
+	std::atomic<unsigned long long> ProcessBytes(0);
+
+	/** Count an allocation and take the memory from malloc
+	*/
+	void* TrackedAllocate(size_t size)
+	{
+		++ThreadAllocations;
+		ThreadBytes += size;
+		ProcessAllocations.fetch_add(1, std::memory_order_relaxed);
+		ProcessBytes.fetch_add(size, std::memory_order_relaxed);
+		return malloc(size > 0 ? size : 1);
+	}
+}
+
+void* operator new(size_t size)
+{
+	void* p = TrackedAllocate(size);
+	if(p == 0)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return TrackedAllocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+#endif
+
+namespace SuperTrace
+{
+	/** Check whether allocations are being counted
+	* @return
+	*	bool True when built with ST_TRACK_ALLOCATIONS
+	*/
+	bool IsAllocationTrackingEnabled()
+	{
+#ifdef ST_TRACK_ALLOCATIONS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** Get the allocations made by the calling thread since it started
+	* @return
+	*	AllocationCount The allocations
+	*/
+	AllocationCount GetThreadAllocations()
+	{
+		AllocationCount count;
+#ifdef ST_TRACK_ALLOCATIONS
+		count.numAllocations = ThreadAllocations;
+		count.numBytes = ThreadBytes;
+#endif
+		return count;
+	}
+
+	/** Get the allocations made by every thread since the process started
+	* @return
+	*	AllocationCount The allocations
+	*/
+	AllocationCount GetProcessAllocations()
+	{
+		AllocationCount count;
+#ifdef ST_TRACK_ALLOCATIONS
+		count.numAllocations = ProcessAllocations.load(std::memory_order_relaxed);
+		count.numBytes = ProcessBytes.load(std::memory_order_relaxed);
+#endif
+		return count;
+	}
+
+}	// Namespace
@@ -0,0 +1,177 @@
+//*************************************************************************************************
+// Title: Arena.cpp
+// Description: A bump allocator that hands out memory from large blocks. Everything allocated is
+//	released at once by reset, which keeps the blocks so a frame that fits in the last frame's
+//	blocks never touches the heap.
+//*************************************************************************************************
+#include "Arena.h"
+#include <assert.h>
+#include <stdint.h>
+
+namespace SuperTrace
+{
+	/** Round a pointer up to an alignment
+	*/
+	static char* AlignUp(char* p, size_t alignment)
+	{
+		uintptr_t address = reinterpret_cast<uintptr_t>(p);
+		return reinterpret_cast<char*>((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+	}
+
+	/** Constructor, no memory is taken until the first allocation
+	* @param
+	*	blockSize The size of each block in bytes, larger allocations get a block of their own
+	*/
+	Arena::Arena(size_t blockSize)
+		:	_blockSize(blockSize), _first(0), _current(0), _next(0), _end(0), _bytesBeforeCurrent(0),
+			_bytesReserved(0), _numBlocks(0), _finalizers(0)
+	{ }
+
+	/** Destructor, destroys every object created in the arena and frees the blocks
+	*/
+	Arena::~Arena()
+	{
+		reset();
+
+		Block* block = _first;
+		while(block != 0)
+		{
+			Block* next = block->next;
+			::operator delete(block);
+			block = next;
+		}
+	}
+
+	/** Allocate raw memory, valid until the next reset
+	* @param
+	*	size The number of bytes
+	* @param
+	*	alignment The alignment, a power of two
+	* @return
+	*	void* The memory
+	*/
+	void* Arena::allocate(size_t size, size_t alignment)
+	{
+		assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+		char* p = AlignUp(_next, alignment);
+		if(_current == 0 || p + size > _end)
+		{
+			nextBlock(size, alignment);
+			p = AlignUp(_next, alignment);
+		}
+
+		_next = p + size;
+		return p;
+	}
+
+	/** Destroy every object created since the last reset and rewind to the first block, the
+	*	blocks are kept for reuse
+	*/
+	void Arena::reset()
+	{
+		// Objects are destroyed newest first, so an object may still use anything created before it
+		while(_finalizers != 0)
+		{
+			Finalizer* finalizer = _finalizers;
+			_finalizers = finalizer->next;
+			finalizer->destroy(finalizer->object);
+		}
+
+		_current = _first;
+		_next = _first != 0 ? BlockBegin(_first) : 0;
+		_end = _first != 0 ? _next + _first->size : 0;
+		_bytesBeforeCurrent = 0;
+	}
+
+	/** Get the bytes handed out since the last reset, including alignment padding
+	* @return
+	*	size_t The bytes in use
+	*/
+	size_t Arena::getBytesUsed() const
+	{
+		return _current != 0 ? _bytesBeforeCurrent + (_next - BlockBegin(_current)) : 0;
+	}
+
+	/** Get the bytes held in blocks
+	* @return
+	*	size_t The bytes reserved
+	*/
+	size_t Arena::getBytesReserved() const
+	{
+		return _bytesReserved;
+	}
+
+	/** Get the number of blocks taken from the heap over the arena's lifetime
+	* @return
+	*	unsigned int The number of blocks
+	*/
+	unsigned int Arena::getNumBlocks() const
+	{
+		return _numBlocks;
+	}
+
+	/** Record a destructor to run on reset
+	* @param
+	*	destroy The function that destroys the object
+	* @param
+	*	object The object
+	*/
+	void Arena::addFinalizer(void (*destroy)(void*), void* object)
+	{
+		Finalizer* finalizer = static_cast<Finalizer*>(allocate(sizeof(Finalizer), alignof(Finalizer)));
+		finalizer->destroy = destroy;
+		finalizer->object = object;
+		finalizer->next = _finalizers;
+		_finalizers = finalizer;
+	}
+
+	/** Make the next block that can hold an allocation current, taking a new one if none fits
+	* @param
+	*	size The number of bytes
+	* @param
+	*	alignment The alignment
+	*/
+	void Arena::nextBlock(size_t size, size_t alignment)
+	{
+		// Enough room for the allocation wherever the block happens to start
+		size_t needed = size + alignment - 1;
+
+		// Reuse the block kept from an earlier frame when it is big enough
+		Block* next = _current != 0 ? _current->next : _first;
+		if(next == 0 || next->size < needed)
+		{
+			size_t blockSize = needed > _blockSize ? needed : _blockSize;
+			Block* block = static_cast<Block*>(::operator new(sizeof(Block) + blockSize));
+			block->size = blockSize;
+			block->next = next;
+			if(_current != 0)
+			{
+				_current->next = block;
+			}
+			else
+			{
+				_first = block;
+			}
+			_bytesReserved += blockSize;
+			++_numBlocks;
+			next = block;
+		}
+
+		if(_current != 0)
+		{
+			_bytesBeforeCurrent += _next - BlockBegin(_current);
+		}
+		_current = next;
+		_next = BlockBegin(next);
+		_end = _next + next->size;
+	}
+
+	/** Get the first usable byte of a block
+	*/
+	char* Arena::BlockBegin(Block* block)
+	{
+		return reinterpret_cast<char*>(block + 1);
+	}
+
+}	// Namespace
@@ -0,0 +1,803 @@
+//*************************************************************************************************
+// Title: BVH.cpp
+// Description: A bounding volume hierarchy built with the surface area heuristic. The hierarchy
+//	only knows primitive bounds, the caller intersects the primitives in each leaf it reaches.
+//*************************************************************************************************
+#include "BVH.h"
+#include "ParallelFor.h"
+#include "Timeline.h"
+#include <float.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace SuperTrace
+{
+	// Cost of stepping through a node, primitive tests are priced relative to it
+	static const float TraversalCost = 1.0f;
+
+	// Nodes with at least this many primitives are split by all build threads together, smaller
+	// ones become subtrees that each thread builds on its own
+	static const unsigned int ParallelSplitSize = 1 << 14;
+
+	// Smallest range of primitives handed to a thread in a parallel pass
+	static const unsigned int MinSliceSize = 4096;
+
+	/** Bounds and centroid of a primitive in a form that is cheap to bin
+	*/
+	struct BuildPrimitive
+	{
+		float min[3];
+		float max[3];
+		float center[3];
+	};
+
+	/** A plain float box used while building
+	*/
+	struct BuildBox
+	{
+		BuildBox()
+		{
+			min[0] = min[1] = min[2] = FLT_MAX;
+			max[0] = max[1] = max[2] = -FLT_MAX;
+		}
+
+		void grow(const float* lo, const float* hi)
+		{
+			for(unsigned int i = 0; i < 3; ++i)
+			{
+				min[i] = std::min(min[i], lo[i]);
+				max[i] = std::max(max[i], hi[i]);
+			}
+		}
+
+		void grow(const BuildBox& box)
+		{
+			grow(box.min, box.max);
+		}
+
+		float getSurfaceArea() const
+		{
+			if(min[0] > max[0])
+			{
+				return 0.0f;
+			}
+			float x = max[0] - min[0];
+			float y = max[1] - min[1];
+			float z = max[2] - min[2];
+			return 2.0f * (x * y + y * z + z * x);
+		}
+
+		float min[3];
+		float max[3];
+	};
+
+	/** A bin of the SAH sweep
+	*/
+	struct Bin
+	{
+		Bin()
+			:	count(0)
+		{ }
+
+		BuildBox bounds;
+		unsigned int count;
+	};
+
+	/** The bins of all three axes
+	*/
+	struct BinSet
+	{
+		/** Empty the bins in use, so the set can be filled again for the next node
+		* @param
+		*	numBins The bins in use on each axis
+		*/
+		void reset(unsigned int numBins)
+		{
+			for(unsigned int axis = 0; axis < 3; ++axis)
+			{
+				for(unsigned int b = 0; b < numBins; ++b)
+				{
+					bins[axis][b] = Bin();
+				}
+			}
+		}
+
+		Bin bins[3][BVH::MaxBins];
+	};
+
+	/** A node waiting to be subdivided
+	*/
+	struct BuildTask
+	{
+		unsigned int node;
+		unsigned int depth;
+	};
+
+	/** The cheapest split plane found for a node
+	*/
+	struct Split
+	{
+		Split()
+			:	cost(FLT_MAX), axis(0), bin(0)
+		{ }
+
+		float cost;
+		unsigned int axis;
+		unsigned int bin;
+	};
+
+	/** Storage one building thread reuses from node to node, so splitting a node allocates nothing
+	*	once the storage has grown to fit
+	*/
+	struct BuildScratch
+	{
+		/** Make room for numThreads threads to bound and bin one node together
+		* @param
+		*	numThreads The threads cooperating on the node
+		* @param
+		*	numBins The bins in use on each axis
+		*/
+		void reset(unsigned int numThreads, unsigned int numBins)
+		{
+			if(binSets.size() < numThreads)
+			{
+				binSets.resize(numThreads);
+				boxes.resize(numThreads);
+				centerBoxes.resize(numThreads);
+			}
+
+			for(unsigned int i = 0; i < numThreads; ++i)
+			{
+				binSets[i].reset(numBins);
+				boxes[i] = BuildBox();
+				centerBoxes[i] = BuildBox();
+			}
+		}
+
+		std::vector<BinSet> binSets;
+		std::vector<BuildBox> boxes;
+		std::vector<BuildBox> centerBoxes;
+		std::vector<BuildTask> tasks;
+	};
+
+	/** Subdivides nodes, either with all threads cooperating on one node or one thread per subtree
+	*/
+	class BVHBuilder
+	{
+	public:
+		BVHBuilder(const std::vector<BuildPrimitive>& primitives, std::vector<unsigned int>& indices,
+			unsigned int maxLeafSize, float intersectionCost, unsigned int numBins, unsigned int maxDepth)
+			:	_primitives(primitives), _indices(indices), _maxLeafSize(maxLeafSize), _intersectionCost(intersectionCost),
+				_numBins(numBins), _maxDepth(maxDepth)
+		{ }
+
+		/** Bound a node and decide whether and where to split it, appending its children if it splits
+		* @param
+		*	nodes The node array the task refers to
+		* @param
+		*	task The node to subdivide
+		* @param
+		*	numThreads The threads that may cooperate on this node
+		* @param
+		*	scratch The calling thread's storage, only holds one set of bins per thread when the node
+		*	is large enough to be cut into slices
+		* @param
+		*	children Receives the tasks for the two children
+		* @return
+		*	bool False if the node became a leaf
+		*/
+		bool splitNode(std::vector<BVHNode>& nodes, const BuildTask& task, unsigned int numThreads, BuildScratch& scratch, BuildTask* children)
+		{
+			unsigned int first = nodes[task.node].leftFirst;
+			unsigned int count = nodes[task.node].count;
+
+			// Only the threads that will actually get a slice need storage
+			numThreads = std::max(std::min(numThreads, count / MinSliceSize), 1u);
+			scratch.reset(numThreads, _numBins);
+			std::vector<BuildBox>& boxes = scratch.boxes;
+			std::vector<BuildBox>& centerBoxes = scratch.centerBoxes;
+
+			// Bound the node and its centroids
+			unsigned int numSlices = ParallelFor(numThreads, first, count, MinSliceSize, [&](unsigned int slice, unsigned int begin, unsigned int end)
+			{
+				for(unsigned int i = begin; i < end; ++i)
+				{
+					const BuildPrimitive& p = _primitives[_indices[i]];
+					boxes[slice].grow(p.min, p.max);
+					centerBoxes[slice].grow(p.center, p.center);
+				}
+			});
+			BuildBox box;
+			BuildBox centers;
+			for(unsigned int i = 0; i < numSlices; ++i)
+			{
+				box.grow(boxes[i]);
+				centers.grow(centerBoxes[i]);
+			}
+
+			BVHNode& node = nodes[task.node];
+			for(unsigned int axis = 0; axis < 3; ++axis)
+			{
+				node.min[axis] = box.min[axis];
+				node.max[axis] = box.max[axis];
+			}
+
+			if(count == 1 || task.depth >= _maxDepth)
+			{
+				return false;
+			}
+
+			// Bin the centroids of every axis, each slice into its own set
+			std::vector<BinSet>& binSets = scratch.binSets;
+			numSlices = ParallelFor(numThreads, first, count, MinSliceSize, [&](unsigned int slice, unsigned int begin, unsigned int end)
+			{
+				for(unsigned int axis = 0; axis < 3; ++axis)
+				{
+					float extent = centers.max[axis] - centers.min[axis];
+					if(extent <= 0.0f)
+					{
+						continue;
+					}
+
+					Bin* bins = binSets[slice].bins[axis];
+					for(unsigned int i = begin; i < end; ++i)
+					{
+						const BuildPrimitive& p = _primitives[_indices[i]];
+						unsigned int b = getBin(p.center[axis], centers.min[axis], extent);
+						bins[b].bounds.grow(p.min, p.max);
+						++bins[b].count;
+					}
+				}
+			});
+			for(unsigned int i = 1; i < numSlices; ++i)
+			{
+				for(unsigned int axis = 0; axis < 3; ++axis)
+				{
+					for(unsigned int b = 0; b < _numBins; ++b)
+					{
+						binSets[0].bins[axis][b].bounds.grow(binSets[i].bins[axis][b].bounds);
+						binSets[0].bins[axis][b].count += binSets[i].bins[axis][b].count;
+					}
+				}
+			}
+
+			Split split = findSplit(binSets[0], centers);
+
+			// Compare the split with keeping the node as a leaf
+			float area = box.getSurfaceArea();
+			float splitCost = split.cost < FLT_MAX && area > 0.0f ? TraversalCost + _intersectionCost * split.cost / area : FLT_MAX;
+			float leafCost = _intersectionCost * count;
+			if(count <= _maxLeafSize && leafCost <= splitCost)
+			{
+				return false;
+			}
+
+			unsigned int leftCount;
+			if(split.cost < FLT_MAX)
+			{
+				leftCount = partition(first, count, centers, split, numThreads);
+			}
+			else
+			{
+				// Every centroid coincides, no plane separates them so split the range in half
+				leftCount = count / 2;
+			}
+
+			BVHNode child;
+			child.leftFirst = first;
+			child.count = leftCount;
+			unsigned int leftIndex = static_cast<unsigned int>(nodes.size());
+			nodes.push_back(child);
+			child.leftFirst = first + leftCount;
+			child.count = count - leftCount;
+			nodes.push_back(child);
+
+			// The push may have moved the nodes, so node is not used past this point
+			nodes[task.node].leftFirst = leftIndex;
+			nodes[task.node].count = 0;
+
+			children[0].node = leftIndex;
+			children[0].depth = task.depth + 1;
+			children[1].node = leftIndex + 1;
+			children[1].depth = task.depth + 1;
+			return true;
+		}
+
+		/** Build a whole subtree on the calling thread
+		* @param
+		*	nodes The node array, the subtree root must already be in it
+		* @param
+		*	root The subtree root
+		* @param
+		*	scratch The calling thread's storage, kept for every subtree the thread builds
+		*/
+		void buildSubtree(std::vector<BVHNode>& nodes, const BuildTask& root, BuildScratch& scratch)
+		{
+			std::vector<BuildTask>& tasks = scratch.tasks;
+			tasks.push_back(root);
+			while(tasks.empty() == false)
+			{
+				BuildTask task = tasks.back();
+				tasks.pop_back();
+
+				BuildTask children[2];
+				if(splitNode(nodes, task, 1, scratch, children) == true)
+				{
+					tasks.push_back(children[1]);
+					tasks.push_back(children[0]);
+				}
+			}
+		}
+
+	private:
+		/** Get the bin a centroid falls in
+		*/
+		unsigned int getBin(float center, float minCenter, float extent) const
+		{
+			return std::min(static_cast<unsigned int>((center - minCenter) * (_numBins / extent)), _numBins - 1);
+		}
+
+		/** Sweep the bins of every axis for the cheapest split
+		* @param
+		*	binSet The filled bins
+		* @param
+		*	centers The centroid bounds the bins span
+		* @return
+		*	Split The cheapest split, with a cost of FLT_MAX if no plane separates the centroids
+		*/
+		Split findSplit(const BinSet& binSet, const BuildBox& centers) const
+		{
+			Split best;
+			for(unsigned int axis = 0; axis < 3; ++axis)
+			{
+				if(centers.max[axis] - centers.min[axis] <= 0.0f)
+				{
+					continue;
+				}
+
+				const Bin* bins = binSet.bins[axis];
+
+				// Right to left pass stores the area and count to the right of each plane
+				float rightArea[BVH::MaxBins];
+				unsigned int rightCount[BVH::MaxBins];
+				BuildBox right;
+				unsigned int rightSum = 0;
+				for(unsigned int b = _numBins - 1; b > 0; --b)
+				{
+					right.grow(bins[b].bounds);
+					rightSum += bins[b].count;
+					rightArea[b - 1] = right.getSurfaceArea();
+					rightCount[b - 1] = rightSum;
+				}
+
+				BuildBox left;
+				unsigned int leftSum = 0;
+				for(unsigned int b = 0; b < _numBins - 1; ++b)
+				{
+					left.grow(bins[b].bounds);
+					leftSum += bins[b].count;
+					if(leftSum == 0 || rightCount[b] == 0)
+					{
+						continue;
+					}
+
+					float cost = left.getSurfaceArea() * leftSum + rightArea[b] * rightCount[b];
+					if(cost < best.cost)
+					{
+						best.cost = cost;
+						best.axis = axis;
+						best.bin = b;
+					}
+				}
+			}
+			return best;
+		}
+
+		/** Reorder a range so primitives left of the split come first
+		* @return
+		*	unsigned int The number of primitives left of the split
+		*/
+		unsigned int partition(unsigned int first, unsigned int count, const BuildBox& centers, const Split& split, unsigned int numThreads)
+		{
+			unsigned int axis = split.axis;
+			float minCenter = centers.min[axis];
+			float extent = centers.max[axis] - centers.min[axis];
+
+			if(numThreads <= 1 || count < 2 * MinSliceSize)
+			{
+				unsigned int* begin = &_indices[first];
+				unsigned int* middle = std::partition(begin, begin + count, [&](unsigned int index)
+				{
+					return getBin(_primitives[index].center[axis], minCenter, extent) <= split.bin;
+				});
+				return static_cast<unsigned int>(middle - begin);
+			}
+
+			// Count each slice's left side, then scatter every slice into its place in a copy
+			std::vector<unsigned int> leftCounts(numThreads, 0);
+			std::vector<unsigned int> sliceBegins(numThreads, 0);
+			unsigned int numSlices = ParallelFor(numThreads, first, count, MinSliceSize, [&](unsigned int slice, unsigned int begin, unsigned int end)
+			{
+				sliceBegins[slice] = begin;
+				for(unsigned int i = begin; i < end; ++i)
+				{
+					if(getBin(_primitives[_indices[i]].center[axis], minCenter, extent) <= split.bin)
+					{
+						++leftCounts[slice];
+					}
+				}
+			});
+
+			std::vector<unsigned int> leftOffsets(numSlices);
+			std::vector<unsigned int> rightOffsets(numSlices);
+			unsigned int leftTotal = 0;
+			for(unsigned int i = 0; i < numSlices; ++i)
+			{
+				leftOffsets[i] = leftTotal;
+				leftTotal += leftCounts[i];
+			}
+			unsigned int rightTotal = leftTotal;
+			for(unsigned int i = 0; i < numSlices; ++i)
+			{
+				rightOffsets[i] = rightTotal;
+				rightTotal += (i + 1 < numSlices ? sliceBegins[i + 1] : first + count) - sliceBegins[i] - leftCounts[i];
+			}
+
+			std::vector<unsigned int> scattered(count);
+			ParallelFor(numThreads, first, count, MinSliceSize, [&](unsigned int slice, unsigned int begin, unsigned int end)
+			{
+				unsigned int l = leftOffsets[slice];
+				unsigned int r = rightOffsets[slice];
+				for(unsigned int i = begin; i < end; ++i)
+				{
+					unsigned int index = _indices[i];
+					if(getBin(_primitives[index].center[axis], minCenter, extent) <= split.bin)
+					{
+						scattered[l++] = index;
+					}
+					else
+					{
+						scattered[r++] = index;
+					}
+				}
+			});
+			std::copy(scattered.begin(), scattered.end(), _indices.begin() + first);
+
+			return leftTotal;
+		}
+
+	private:
+		const std::vector<BuildPrimitive>& _primitives;
+		std::vector<unsigned int>& _indices;
+		unsigned int _maxLeafSize;
+		float _intersectionCost;
+		unsigned int _numBins;
+		unsigned int _maxDepth;
+	};
+
+	/** Working storage kept between builds, every container keeps the capacity it grew to
+	*/
+	struct BVH::BuildStorage
+	{
+		std::vector<BuildPrimitive> primitives;
+
+		/** Nodes left to split with every thread, then the stack of the tree measurement
+		*/
+		std::vector<BuildTask> large;
+
+		/** Roots of the subtrees built one per thread, and the nodes of each
+		*/
+		std::vector<BuildTask> subtrees;
+		std::vector<std::vector<BVHNode> > subtreeNodes;
+
+		/** Scratch for each build thread, the first also serves the shared splits
+		*/
+		std::vector<BuildScratch> scratch;
+	};
+
+	/** Default constructor
+	*/
+	BVH::BVH()
+		:	_maxLeafSize(4), _intersectionCost(1.0f), _numBins(16), _numBuildThreads(0), _buildStorage(0)
+	{ }
+
+	/** Destructor
+	*/
+	BVH::~BVH()
+	{
+		delete _buildStorage;
+	}
+
+	/** Set the largest number of primitives a leaf may hold
+	* @param
+	*	maxLeafSize The maximum leaf size
+	*/
+	void BVH::setMaxLeafSize(unsigned int maxLeafSize)
+	{
+		_maxLeafSize = std::max(maxLeafSize, 1u);
+	}
+
+	/** Set the cost of intersecting one primitive relative to stepping through a node, lower it
+	*	for primitives that are tested several at a time so leaves fill up
+	* @param
+	*	cost The relative cost of a primitive test, 1 by default
+	*/
+	void BVH::setIntersectionCost(float cost)
+	{
+		_intersectionCost = cost;
+	}
+
+	/** Set the number of bins the SAH sweep uses per axis, fewer builds faster, more finds
+	*	better splits
+	* @param
+	*	numBins The bin count, clamped to [2, MaxBins]
+	*/
+	void BVH::setNumBins(unsigned int numBins)
+	{
+		// Clamp by value, std::min takes references and MaxBins has no definition to bind them to
+		unsigned int maxBins = MaxBins;
+		_numBins = std::min(std::max(numBins, 2u), maxBins);
+	}
+
+	/** Set the number of threads used to build
+	* @param
+	*	numThreads The number of threads, 0 to use the hardware concurrency
+	*/
+	void BVH::setNumBuildThreads(unsigned int numThreads)
+	{
+		_numBuildThreads = numThreads;
+	}
+
+	/** Build the hierarchy, replacing any previous one
+	* @param
+	*	bounds The bounds of each primitive, primitives are referred to by their index
+	*/
+	void BVH::build(const std::vector<AABB>& bounds)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		TimelineSpan buildSpan("Build BVH");
+
+		clear();
+
+		unsigned int numThreads = _numBuildThreads;
+		if(numThreads == 0)
+		{
+			numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		_buildStats.numThreads = numThreads;
+
+		unsigned int numPrimitives = static_cast<unsigned int>(bounds.size());
+		if(numPrimitives == 0)
+		{
+			return;
+		}
+
+		if(_buildStorage == 0)
+		{
+			_buildStorage = new BuildStorage();
+		}
+		BuildStorage& storage = *_buildStorage;
+		storage.scratch.resize(std::max<size_t>(storage.scratch.size(), numThreads));
+
+		// Flatten the bounds once, binning reads them many times
+		std::vector<BuildPrimitive>& primitives = storage.primitives;
+		primitives.resize(numPrimitives);
+		_indices.resize(numPrimitives);
+		ParallelFor(numThreads, 0, numPrimitives, MinSliceSize, [&](unsigned int, unsigned int begin, unsigned int end)
+		{
+			for(unsigned int i = begin; i < end; ++i)
+			{
+				const Vector3& lo = bounds[i].getMin();
+				const Vector3& hi = bounds[i].getMax();
+				BuildPrimitive& p = primitives[i];
+				for(unsigned int axis = 0; axis < 3; ++axis)
+				{
+					p.min[axis] = lo[axis];
+					p.max[axis] = hi[axis];
+					p.center[axis] = (lo[axis] + hi[axis]) * 0.5f;
+				}
+				_indices[i] = i;
+			}
+		});
+
+		BVHBuilder builder(primitives, _indices, _maxLeafSize, _intersectionCost, _numBins, MaxDepth);
+
+		// A binary tree with one primitive per leaf has 2n - 1 nodes
+		_nodes.reserve(2 * numPrimitives);
+
+		BVHNode root;
+		root.leftFirst = 0;
+		root.count = numPrimitives;
+		_nodes.push_back(root);
+
+		// Split the top of the tree with every thread working on the same node, until the nodes are
+		// small enough that there are plenty of independent subtrees to go around
+		std::vector<BuildTask>& large = storage.large;
+		std::vector<BuildTask>& subtrees = storage.subtrees;
+		large.clear();
+		subtrees.clear();
+		BuildTask rootTask = { 0, 1 };
+		large.push_back(rootTask);
+		while(large.empty() == false)
+		{
+			BuildTask task = large.back();
+			large.pop_back();
+
+			if(numThreads == 1 || _nodes[task.node].count < ParallelSplitSize)
+			{
+				subtrees.push_back(task);
+				continue;
+			}
+
+			BuildTask children[2];
+			if(builder.splitNode(_nodes, task, numThreads, storage.scratch[0], children) == true)
+			{
+				large.push_back(children[1]);
+				large.push_back(children[0]);
+			}
+		}
+
+		// Build the subtrees independently, largest first so the stragglers are small, each worker
+		// takes the next subtree as it finishes one
+		std::sort(subtrees.begin(), subtrees.end(), [this](const BuildTask& a, const BuildTask& b)
+		{
+			return _nodes[a.node].count > _nodes[b.node].count;
+		});
+
+		std::vector<std::vector<BVHNode> >& subtreeNodes = storage.subtreeNodes;
+		if(subtreeNodes.size() < subtrees.size())
+		{
+			subtreeNodes.resize(subtrees.size());
+		}
+		std::atomic<unsigned int> nextSubtree(0);
+		unsigned int numSubtreeThreads = std::max(std::min(numThreads, static_cast<unsigned int>(subtrees.size())), 1u);
+		RunWorkers(numSubtreeThreads, [&](unsigned int worker)
+		{
+			BuildScratch& threadScratch = storage.scratch[worker];
+			unsigned int i;
+			while((i = nextSubtree.fetch_add(1)) < subtrees.size())
+			{
+				std::vector<BVHNode>& nodes = subtreeNodes[i];
+				nodes.clear();
+				nodes.reserve(2 * _nodes[subtrees[i].node].count);
+				nodes.push_back(_nodes[subtrees[i].node]);
+
+				BuildTask localRoot = { 0, subtrees[i].depth };
+				builder.buildSubtree(nodes, localRoot, threadScratch);
+			}
+		});
+
+		// Splice each subtree in, its root replaces the placeholder and the rest is appended
+		for(unsigned int i = 0; i < subtrees.size(); ++i)
+		{
+			const std::vector<BVHNode>& nodes = subtreeNodes[i];
+			unsigned int base = static_cast<unsigned int>(_nodes.size()) - 1;
+			for(unsigned int j = 0; j < nodes.size(); ++j)
+			{
+				BVHNode node = nodes[j];
+				if(node.count == 0)
+				{
+					node.leftFirst += base;
+				}
+
+				if(j == 0)
+				{
+					_nodes[subtrees[i].node] = node;
+				}
+				else
+				{
+					_nodes.push_back(node);
+				}
+			}
+		}
+
+		measureTree();
+		_buildStats.buildSeconds = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	/** Measure the SAH cost, leaf count and depth of the built tree
+	*/
+	void BVH::measureTree()
+	{
+		_buildStats.numNodes = static_cast<unsigned int>(_nodes.size());
+		_buildStats.numLeaves = 0;
+		_buildStats.maxDepth = 0;
+		_buildStats.sahCost = 0.0f;
+
+		if(_nodes.empty() == true)
+		{
+			return;
+		}
+
+		float rootArea = getBounds().getSurfaceArea();
+		double cost = 0.0;
+
+		// The build is done with the large node stack, walk the tree with it
+		std::vector<BuildTask>& stack = _buildStorage->large;
+		stack.clear();
+		BuildTask root = { 0, 1 };
+		stack.push_back(root);
+		while(stack.empty() == false)
+		{
+			BuildTask task = stack.back();
+			stack.pop_back();
+
+			const BVHNode& node = _nodes[task.node];
+			BuildBox box;
+			box.grow(node.min, node.max);
+			float area = box.getSurfaceArea();
+
+			if(node.count > 0)
+			{
+				cost += _intersectionCost * node.count * area;
+				++_buildStats.numLeaves;
+				_buildStats.maxDepth = std::max(_buildStats.maxDepth, task.depth);
+			}
+			else
+			{
+				cost += TraversalCost * area;
+				BuildTask left = { node.leftFirst, task.depth + 1 };
+				BuildTask right = { node.leftFirst + 1, task.depth + 1 };
+				stack.push_back(left);
+				stack.push_back(right);
+			}
+		}
+
+		// Probability of visiting a node is its area over the root's
+		_buildStats.sahCost = rootArea > 0.0f ? static_cast<float>(cost / rootArea) : 0.0f;
+	}
+
+	/** Release the hierarchy
+	*/
+	void BVH::clear()
+	{
+		_nodes.clear();
+		_indices.clear();
+		_buildStats = BVHBuildStats();
+	}
+
+	/** Get the number of nodes
+	* @return
+	*	unsigned int The number of nodes, 0 if nothing has been built
+	*/
+	unsigned int BVH::getNumNodes() const
+	{
+		return static_cast<unsigned int>(_nodes.size());
+	}
+
+	/** Get the bounds of everything in the hierarchy
+	* @return
+	*	AABB The root bounds
+	*/
+	AABB BVH::getBounds() const
+	{
+		if(_nodes.empty() == true)
+		{
+			return AABB();
+		}
+
+		const BVHNode& root = _nodes[0];
+		return AABB(Vector3(root.min[0], root.min[1], root.min[2]), Vector3(root.max[0], root.max[1], root.max[2]));
+	}
+
+	/** Get the statistics of the last build
+	* @return
+	*	const BVHBuildStats& The build statistics
+	*/
+	const BVHBuildStats& BVH::getBuildStats() const
+	{
+		return _buildStats;
+	}
+
+	/** Get the primitive indices in leaf order, a leaf covers a contiguous range of them
+	* @return
+	*	const std::vector<unsigned int>& The primitive indices
+	*/
+	const std::vector<unsigned int>& BVH::getIndices() const
+	{
+		return _indices;
+	}
+
+}	// Namespace
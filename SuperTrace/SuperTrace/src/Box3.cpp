@@ -4,7 +4,12 @@
 // Description: Describes a simple axis aligned box
 //*************************************************************************************************
 #include "Box3.h"
+#include "HitRecord.h"
 #include "Ray.h"
+#include "RayPacket.h"
+#include "RenderStats.h"
+#include <float.h>
+#include <math.h>
 
 namespace SuperTrace
 {
@@ -20,13 +25,20 @@ namespace SuperTrace
 	/** Test for an intersection between a ray and this box
 	* @param
 	*	ray The ray to test against intersection
+	* @param
+	*	hit The closest hit so far, overwritten if the box is hit nearer than hit.t
 	* @return
 	*	bool True if intersection is found, false otherwise
 	*/
-	bool Box3::intersect(const Ray& ray) const
+	bool Box3::intersect(const Ray& ray, HitRecord& hit) const
 	{
 		float tMin, tMax, tyMin, tyMax, tzMin, tzMax;
 
+		// Axes of the slabs the ray enters and leaves the box through
+		unsigned int minAxis = 0;
+		unsigned int maxAxis = 0;
+
+		ST_STATS_ADD(numPrimitiveTests, 1);
 		tMin = (_bounds[ray.getSign()[0]].getX() - ray.getOrigin().getX()) * ray.getInvDirection().getX();
 		tMax = (_bounds[1 - ray.getSign()[0]].getX() - ray.getOrigin().getX()) * ray.getInvDirection().getX();
 		tyMin = (_bounds[ray.getSign()[1]].getY() - ray.getOrigin().getY()) * ray.getInvDirection().getY();
@@ -42,10 +54,12 @@ namespace SuperTrace
 		if(tyMin > tMin)
 		{
 			tMin = tyMin;
+			minAxis = 1;
 		}
 		if(tyMax < tMax)
 		{
 			tMax = tyMax;
+			maxAxis = 1;
 		}
 
 		// Calculate tzmin and max
@@ -61,22 +75,151 @@ namespace SuperTrace
 		if(tzMin > tMin)
 		{
 			tMin = tzMin;
+			minAxis = 2;
 		}
 		if(tzMax < tMax)
 		{
 			tMax = tzMax;
+			maxAxis = 2;
 		}
 
-		// Check tMin and tMax against the ray's distances
-		if(tMin > ray.getTMin())
+		// The ray hits where it enters the box, or where it leaves if it starts inside
+		float t = tMin;
+		unsigned int axis = minAxis;
+		float normalSign = ray.getSign()[minAxis] == 1 ? 1.0f : -1.0f;
+		if(t < ray.getTMin())
 		{
-			ray.setTMin(tMin);
+			t = tMax;
+			axis = maxAxis;
+			normalSign = ray.getSign()[maxAxis] == 1 ? -1.0f : 1.0f;
 		}
-		if(tMax < ray.getTMax())
+
+		// Check t against the ray and the closest hit so far
+		if(t < ray.getTMin() || t >= hit.t)
 		{
-			ray.setTMax(tMax);
+			return false;
 		}
+
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		normal[axis] = normalSign;
+
+		// Position across the hit face, measured along the two other axes
+		Vector3 point = ray(t);
+		unsigned int uAxis = (axis + 1) % 3;
+		unsigned int vAxis = (axis + 2) % 3;
+
+		hit.t = t;
+		hit.object = this;
+		hit.material = &_material;
+		hit.normal = Vector3(normal[0], normal[1], normal[2]);
+		hit.u = (point[uAxis] - _bounds[0][uAxis]) / (_bounds[1][uAxis] - _bounds[0][uAxis]);
+		hit.v = (point[vAxis] - _bounds[0][vAxis]) / (_bounds[1][vAxis] - _bounds[0][vAxis]);
+		ST_STATS_ADD(numPrimitiveHits, 1);
 		return true;
 	}
 
+	/** Test the active lanes of a ray packet for intersection
+	* @param
+	*	packet The rays to test
+	* @param
+	*	mask The lanes to test, a bit per lane
+	* @param
+	*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+	* @return
+	*	unsigned int The lanes whose hit was overwritten
+	*/
+	unsigned int Box3::intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const
+	{
+		// Slab test across the lanes, the entry distance is the latest slab entry and the exit
+		// distance the earliest slab exit
+		const float* origins[3] = { packet.originX, packet.originY, packet.originZ };
+		const float* invDirections[3] = { packet.invDirectionX, packet.invDirectionY, packet.invDirectionZ };
+		PacketFloat tEnter = PacketSplat(-FLT_MAX);
+		PacketFloat tExit = PacketSplat(FLT_MAX);
+		for(unsigned int axis = 0; axis < 3; ++axis)
+		{
+			PacketFloat origin = PacketLoad(origins[axis]);
+			PacketFloat invDirection = PacketLoad(invDirections[axis]);
+			PacketFloat t0 = (PacketSplat(_bounds[0][axis]) - origin) * invDirection;
+			PacketFloat t1 = (PacketSplat(_bounds[1][axis]) - origin) * invDirection;
+			tEnter = PacketMax(tEnter, PacketMin(t0, t1));
+			tExit = PacketMin(tExit, PacketMax(t0, t1));
+		}
+
+		// The ray hits where it enters the box, or where it leaves if it starts inside
+		PacketFloat tMin = PacketLoad(packet.tMin);
+		PacketFloat t = PacketSelect(PacketLess(tEnter, tMin), tExit, tEnter);
+		PacketFloat valid = PacketLessEqual(tEnter, tExit);
+		valid = PacketAnd(valid, PacketLessEqual(tMin, t));
+		valid = PacketAnd(valid, PacketLess(t, PacketLoad(hits.t)));
+
+		// Hits are rare next to misses, so the lanes that hit rerun the single ray test to find the
+		// face, normal and parameterization
+		unsigned int passed = mask & PacketMoveMask(valid);
+
+		// The lanes that pass are counted again by intersect
+		ST_STATS_ADD(numPrimitiveTests, CountLanes(mask) - CountLanes(passed));
+		mask = passed;
+		unsigned int updated = 0;
+		for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+		{
+			if((mask & (1u << lane)) == 0)
+			{
+				continue;
+			}
+
+			HitRecord hit = hits.getHit(lane);
+			if(intersect(packet.getRay(lane), hit) == true)
+			{
+				hits.setHit(lane, hit);
+				updated |= 1u << lane;
+			}
+		}
+		return updated;
+	}
+
+	/** Calculate the surface normal for a given contact point
+	* @param
+	*	surfacePoint The surface point at which to construct a normal
+	* @return
+	*	Vector3 The normal of the face nearest to the point
+	*/
+	Vector3 Box3::getSurfaceNormal(const Vector3& surfacePoint) const
+	{
+		// The contact point lies on the face it is closest to
+		float bestDistance = fabs(surfacePoint[0] - _bounds[0][0]);
+		unsigned int bestAxis = 0;
+		float bestSign = -1.0f;
+		for(unsigned int axis = 0; axis < 3; ++axis)
+		{
+			float toMin = fabs(surfacePoint[axis] - _bounds[0][axis]);
+			float toMax = fabs(surfacePoint[axis] - _bounds[1][axis]);
+			if(toMin < bestDistance)
+			{
+				bestDistance = toMin;
+				bestAxis = axis;
+				bestSign = -1.0f;
+			}
+			if(toMax < bestDistance)
+			{
+				bestDistance = toMax;
+				bestAxis = axis;
+				bestSign = 1.0f;
+			}
+		}
+
+		float n[3] = { 0.0f, 0.0f, 0.0f };
+		n[bestAxis] = bestSign;
+		return Vector3(n[0], n[1], n[2]);
+	}
+
+	/** Get the world space bounds of the box
+	* @return
+	*	AABB The box itself
+	*/
+	AABB Box3::getBounds() const
+	{
+		return AABB(_bounds[0], _bounds[1]);
+	}
+
 }	// Namespace
\ No newline at end of file
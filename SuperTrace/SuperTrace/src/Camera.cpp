@@ -11,8 +11,8 @@ namespace SuperTrace
 	/** Constructor
 	*/
 	Camera::Camera()
-		:	_width(0), _height(0), _aspectRatio(0.0f), _fov(0.0f), 
-			_position(Vector3()), _forward(Vector3(0.0f, 0.0f, -1.0f))
+		:	_width(0), _height(0), _aspectRatio(0.0f), _fov(0.0f),
+			_position(Vector3()), _forward(Vector3(0.0f, 0.0f, 1.0f)), _up(Vector3(0.0f, 1.0f, 0.0f))
 	{ }
 
 	/** Constructor
@@ -21,13 +21,14 @@ namespace SuperTrace
 	* @param
 	*	height The view plane height
 	* @param
-	*	fov The viewing angle for this camera
+	*	fov The tangent of half the vertical viewing angle
 	*/
 	Camera::Camera(unsigned int width, unsigned int height, float fov)
 		:	_width(width), _height(height), _fov(fov),
-			_position(Vector3()), _forward(Vector3(0.0f, 0.0f, -1.0f))
+			_position(Vector3()), _forward(Vector3(0.0f, 0.0f, 1.0f)), _up(Vector3(0.0f, 1.0f, 0.0f))
 	{
 		_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+		updateRasterMapping();
 	}
 
 	/** Set the position of the camera
@@ -55,6 +56,7 @@ namespace SuperTrace
 	void Camera::setForward(const Vector3& v)
 	{
 		_forward = v;
+		updateRasterMapping();
 	}
 
 	/** Get the forward for the camera
@@ -66,6 +68,44 @@ namespace SuperTrace
 		return _forward;
 	}
 
+	/** Set the up direction of the camera, it need not be perpendicular to the forward
+	* @param
+	*	v The new up direction
+	*/
+	void Camera::setUp(const Vector3& v)
+	{
+		_up = v;
+		updateRasterMapping();
+	}
+
+	/** Get the up direction of the camera
+	* @return
+	*	Vector3 The up direction
+	*/
+	const Vector3& Camera::getUp() const
+	{
+		return _up;
+	}
+
+	/** Set the field of view
+	* @param
+	*	fov The tangent of half the vertical viewing angle
+	*/
+	void Camera::setFieldOfView(float fov)
+	{
+		_fov = fov;
+		updateRasterMapping();
+	}
+
+	/** Get the field of view
+	* @return
+	*	float The tangent of half the vertical viewing angle
+	*/
+	float Camera::getFieldOfView() const
+	{
+		return _fov;
+	}
+
 	/** Given a raster position on the screen, return a view ray
 	* @param
 	*	x The x raster position
@@ -76,51 +116,90 @@ namespace SuperTrace
 	*/
 	Ray Camera::rasterToRay(unsigned int x, unsigned int y) const
 	{
-		// First, remap from raster space to screen space
-		float fX = static_cast<float>(x);
-		float fY = static_cast<float>(y);
-		float fWidth = static_cast<float>(_width);
-		float fHeight = static_cast<float>(_height);
-
-		// First map fX and fY from raster space to NDC space
-		float sX = (fX + 0.5f) / fWidth;
-		float sY = (fY + 0.5f) / fHeight;
-
-		// Next, map from NDC to screen space
-		sX = (2.0f * sX) - 1.0f;
-		sY = 1.0f - (2.0f * sY);
-
-		// Apply aspect ratio to X coordinate
-		sX *= _aspectRatio;
-
-		// TEST - y aspect ratio
-		// As y deviates from the center line, scale it by a fraction of the inverse aspect ratio
-		//float invAspect = 1.0f / _aspectRatio;
-		//sY *= invAspect;
-		// END TEST
-
-		// Multiply by field of view
-		sX *= _fov;
-		sY *= _fov;
-
-		// Now we can get the position of the point in camera space as (sX, sY, -1)
-		Vector3 pCamera = Vector3(sX, sY, -1.0f);
-		Vector3 rayDirection = pCamera - _position;
-		
-		// Build the perspective matrix
-		float f = 1.0f / _fov;
-		float near = 1.0f;
-		float far = 1000.0f;
-		Matrix44 persp = Matrix44(
-			f, 0.0f, 0.0f, 0.0f,
-			0.0f, f, 0.0f, 0.0f,
-			0.0f, 0.0f, far/(far-near), 1.0f,
-			0.0f, 0.0f, -(far*near)/(far-near), 0.0f);
-		rayDirection = Vector3Transform(rayDirection, persp);
-		
-		rayDirection.normalize();
-
-		return Ray(_position, rayDirection);
+		Vector3 direction = _rasterOrigin + _rasterDy * static_cast<float>(y) + _rasterDx * static_cast<float>(x);
+		direction.normalize();
+		return Ray(_position, direction, RAY_TYPE_CAMERA);
+	}
+
+	/** Generate the view rays of a block of pixels, row by row
+	* @param
+	*	x The raster x of the first pixel
+	* @param
+	*	y The raster y of the first pixel
+	* @param
+	*	width The number of pixels in each row
+	* @param
+	*	height The number of rows
+	* @param
+	*	origins Receives width * height ray origins, row major
+	* @param
+	*	directions Receives width * height normalized ray directions, row major
+	*/
+	void Camera::generateRays(unsigned int x, unsigned int y, unsigned int width, unsigned int height, Vector3* origins, Vector3* directions) const
+	{
+		for(unsigned int row = 0; row < height; ++row)
+		{
+			// Each pixel is offset from the start of its row rather than from its neighbour, so
+			// rounding does not build up along the row and every path gives the same rays
+			Vector3 rowStart = _rasterOrigin + _rasterDy * static_cast<float>(y + row);
+			for(unsigned int column = 0; column < width; ++column)
+			{
+				Vector3 direction = rowStart + _rasterDx * static_cast<float>(x + column);
+				direction.normalize();
+				origins[column] = _position;
+				directions[column] = direction;
+			}
+			origins += width;
+			directions += width;
+		}
+	}
+
+	/** Generate a packet of view rays for consecutive pixels along a row
+	* @param
+	*	x The raster x of the first pixel
+	* @param
+	*	y The raster y of the row
+	* @param
+	*	count The number of pixels, at most PacketWidth
+	* @param
+	*	packet Receives the rays in lanes 0 to count - 1, the lanes after them repeat the last ray
+	*/
+	void Camera::generatePacket(unsigned int x, unsigned int y, unsigned int count, RayPacket& packet) const
+	{
+		Vector3 rowStart = _rasterOrigin + _rasterDy * static_cast<float>(y);
+		for(unsigned int lane = 0; lane < count; ++lane)
+		{
+			Vector3 direction = rowStart + _rasterDx * static_cast<float>(x + lane);
+			direction.normalize();
+			packet.setRay(lane, _position, direction);
+		}
+		packet.count = count;
+		packet.padInactiveLanes();
+	}
+
+	/** Recompute the raster to world mapping, called whenever the view changes
+	*/
+	void Camera::updateRasterMapping()
+	{
+		if(_width == 0 || _height == 0)
+		{
+			return;
+		}
+
+		// Left handed basis like the world, x right, y up and z forward
+		Vector3 forward = _forward.normal();
+		Vector3 right = _up.cross(forward).normal();
+		Vector3 up = forward.cross(right);
+
+		// The view plane sits at distance 1, pixel centers span it with y running down the screen
+		float halfHeight = _fov;
+		float halfWidth = _fov * _aspectRatio;
+		float invWidth = 1.0f / static_cast<float>(_width);
+		float invHeight = 1.0f / static_cast<float>(_height);
+
+		_rasterDx = right * (2.0f * halfWidth * invWidth);
+		_rasterDy = up * (-2.0f * halfHeight * invHeight);
+		_rasterOrigin = forward + right * (halfWidth * (invWidth - 1.0f)) + up * (halfHeight * (1.0f - invHeight));
 	}
 
 }	// Namespace
\ No newline at end of file
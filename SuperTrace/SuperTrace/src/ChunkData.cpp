@@ -7,16 +7,28 @@ namespace SuperTrace
     */
     ChunkData::ChunkData()
     :   _startX(0),
-        _startY(0)
+        _startY(0),
+        _width(0),
+        _height(0)
     {
 
     }
 
     /** Constructor
+    * @param
+    *   startX The first raster column of the chunk
+    * @param
+    *   startY The first raster row of the chunk
+    * @param
+    *   width The width of the chunk in pixels
+    * @param
+    *   height The height of the chunk in pixels
     */
-    ChunkData::ChunkData(unsigned int startX, unsigned int startY)
+    ChunkData::ChunkData(unsigned int startX, unsigned int startY, unsigned int width, unsigned int height)
 	:   _startX(startX),
-        _startY(startY)
+        _startY(startY),
+        _width(width),
+        _height(height)
     {
 
     }
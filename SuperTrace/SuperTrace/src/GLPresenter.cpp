@@ -0,0 +1,83 @@
+//*************************************************************************************************
+// Title: GLPresenter.cpp
+// Description: Presents dirty rectangles of the frame to a WGL window with glDrawPixels.
+//*************************************************************************************************
+#include "GLPresenter.h"
+#include <gl/GL.h>
+
+namespace SuperTrace
+{
+	/** Constructor
+	* @param
+	*	hDC The device context of the window
+	* @param
+	*	hRC The GL context, it is made current on the present thread while a frame is shown
+	*/
+	GLPresenter::GLPresenter(HDC hDC, HGLRC hRC)
+		:	_hDC(hDC), _hRC(hRC)
+	{ }
+
+	/** Called on the thread that starts a render, before the present thread runs
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels The frame buffer, RGB floats stored bottom up
+	*/
+	void GLPresenter::begin(unsigned int width, unsigned int height, const float* pixels)
+	{
+		Presenter::begin(width, height, pixels);
+
+		// A context can only be current on one thread, hand it over to the present thread
+		wglMakeCurrent(NULL, NULL);
+	}
+
+	/** Make the GL context current on the present thread
+	*/
+	void GLPresenter::attach()
+	{
+		wglMakeCurrent(_hDC, _hRC);
+
+		// Rows are read straight out of the frame buffer, which is tightly packed floats
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, _width);
+	}
+
+	/** Release the GL context so the next render can claim it
+	*/
+	void GLPresenter::detach()
+	{
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		glFinish();
+
+		wglMakeCurrent(NULL, NULL);
+	}
+
+	/** Upload a rectangle of the frame buffer
+	* @param
+	*	rect The rectangle, in image coordinates with y pointing down
+	*/
+	void GLPresenter::uploadRect(const RenderData& rect)
+	{
+		// The frame buffer is stored bottom up like the window
+		unsigned int row = _height - rect._startY - rect._height;
+
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect._startX);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, row);
+
+		// Map the rectangle corner into normalized device coordinates, the matrices are identity
+		glRasterPos2f(2.0f * rect._startX / _width - 1.0f, 2.0f * row / _height - 1.0f);
+		glDrawPixels(rect._width, rect._height, GL_RGB, GL_FLOAT, _pixels);
+	}
+
+	/** Submit the uploads to the driver
+	*/
+	void GLPresenter::flush()
+	{
+		glFlush();
+	}
+
+}	// Namespace
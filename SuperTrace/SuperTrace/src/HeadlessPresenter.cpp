@@ -0,0 +1,59 @@
+//*************************************************************************************************
+// Title: HeadlessPresenter.cpp
+// Description: Presents dirty rectangles into a frame buffer in memory, for running without a
+//	window or GPU.
+//*************************************************************************************************
+#include "HeadlessPresenter.h"
+#include <string.h>
+
+namespace SuperTrace
+{
+	/** Default constructor
+	*/
+	HeadlessPresenter::HeadlessPresenter()
+	{ }
+
+	/** Called on the thread that starts a render, before the present thread runs
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels The frame buffer, RGB floats stored bottom up
+	*/
+	void HeadlessPresenter::begin(unsigned int width, unsigned int height, const float* pixels)
+	{
+		Presenter::begin(width, height, pixels);
+
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		_frame.assign(width * height * 3, 0.0f);
+	}
+
+	/** Copy what has been presented so far, safe to call while the frame is being presented
+	* @param
+	*	pixels Receives the presented RGB floats, stored bottom up
+	*/
+	void HeadlessPresenter::copyFrame(std::vector<float>& pixels)
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+		pixels = _frame;
+	}
+
+	/** Copy a rectangle of the frame buffer into the presented frame
+	* @param
+	*	rect The rectangle, in image coordinates with y pointing down
+	*/
+	void HeadlessPresenter::uploadRect(const RenderData& rect)
+	{
+		std::lock_guard<std::mutex> lock(_frameMutex);
+
+		// The frame buffer is stored bottom up
+		unsigned int firstRow = _height - rect._startY - rect._height;
+		for(unsigned int i = 0; i < rect._height; ++i)
+		{
+			unsigned int offset = ((firstRow + i) * _width + rect._startX) * 3;
+			memcpy(&_frame[offset], _pixels + offset, rect._width * 3 * sizeof(float));
+		}
+	}
+
+}	// Namespace
@@ -0,0 +1,333 @@
+//*************************************************************************************************
+// Title: ImageWriter.cpp
+// Description: Writes a rendered frame to disk. Frames are RGB floats stored bottom up, the way
+//	SceneRenderer fills them.
+//*************************************************************************************************
+#include "ImageWriter.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	/** Convert a color channel to 8 bits
+	* @param
+	*	value The channel value
+	* @return
+	*	unsigned char The value clamped to [0, 1] and scaled to [0, 255]
+	*/
+	static unsigned char ToByte(float value)
+	{
+		if(value <= 0.0f)
+		{
+			return 0;
+		}
+		if(value >= 1.0f)
+		{
+			return 255;
+		}
+		return static_cast<unsigned char>(value * 255.0f + 0.5f);
+	}
+
+	/** Convert the frame to 8 bit rows stored top down
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @param
+	*	bytes Receives the converted rows
+	*/
+	static void ToBytes(unsigned int width, unsigned int height, const float* pixels, std::vector<unsigned char>& bytes)
+	{
+		bytes.resize(width * height * 3);
+		for(unsigned int y = 0; y < height; ++y)
+		{
+			const float* src = pixels + (height - 1 - y) * width * 3;
+			unsigned char* dst = &bytes[y * width * 3];
+			for(unsigned int i = 0; i < width * 3; ++i)
+			{
+				dst[i] = ToByte(src[i]);
+			}
+		}
+	}
+
+	/** Write a buffer to a file and close it
+	* @param
+	*	file The open file
+	* @param
+	*	data The data to write
+	* @param
+	*	size The number of bytes
+	* @return
+	*	bool False if the write or the close failed
+	*/
+	static bool WriteAndClose(FILE* file, const void* data, size_t size)
+	{
+		bool success = size == 0 || fwrite(data, 1, size, file) == size;
+		if(fclose(file) != 0)
+		{
+			success = false;
+		}
+		return success;
+	}
+
+	/** Append a big endian 32 bit value
+	*/
+	static void PutU32(std::vector<unsigned char>& out, unsigned int value)
+	{
+		out.push_back(static_cast<unsigned char>(value >> 24));
+		out.push_back(static_cast<unsigned char>(value >> 16));
+		out.push_back(static_cast<unsigned char>(value >> 8));
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	/** Compute the CRC-32 used by PNG chunks
+	* @param
+	*	data The bytes to checksum
+	* @param
+	*	size The number of bytes
+	* @return
+	*	unsigned int The checksum
+	*/
+	static unsigned int Crc32(const unsigned char* data, size_t size)
+	{
+		// The table is cheap next to the image data, so it is rebuilt rather than shared between threads
+		unsigned int table[256];
+		for(unsigned int n = 0; n < 256; ++n)
+		{
+			unsigned int c = n;
+			for(unsigned int k = 0; k < 8; ++k)
+			{
+				c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table[n] = c;
+		}
+
+		unsigned int crc = 0xFFFFFFFFu;
+		for(size_t i = 0; i < size; ++i)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	/** Append a PNG chunk
+	* @param
+	*	out The file contents
+	* @param
+	*	type The four character chunk type
+	* @param
+	*	data The chunk data
+	*/
+	static void PutChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data)
+	{
+		PutU32(out, static_cast<unsigned int>(data.size()));
+
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+
+		PutU32(out, Crc32(&out[start], out.size() - start));
+	}
+
+	/** Pick an image format from a file name
+	* @param
+	*	path The file name
+	* @return
+	*	ImageFormat The format matching the extension, IMAGE_FORMAT_UNKNOWN if none does
+	*/
+	ImageFormat ImageFormatFromPath(const char* path)
+	{
+		const char* dot = strrchr(path, '.');
+		if(dot == 0)
+		{
+			return IMAGE_FORMAT_UNKNOWN;
+		}
+
+		char ext[8] = { 0 };
+		for(unsigned int i = 0; i < sizeof(ext) - 1 && dot[i + 1] != '\0'; ++i)
+		{
+			char c = dot[i + 1];
+			ext[i] = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		}
+
+		if(strcmp(ext, "ppm") == 0)
+		{
+			return IMAGE_FORMAT_PPM;
+		}
+		if(strcmp(ext, "pfm") == 0)
+		{
+			return IMAGE_FORMAT_PFM;
+		}
+		if(strcmp(ext, "png") == 0)
+		{
+			return IMAGE_FORMAT_PNG;
+		}
+		return IMAGE_FORMAT_UNKNOWN;
+	}
+
+	/** Write a frame in the given format
+	* @param
+	*	path The file to write
+	* @param
+	*	format The image format
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteImage(const char* path, ImageFormat format, unsigned int width, unsigned int height, const float* pixels)
+	{
+		switch(format)
+		{
+		case IMAGE_FORMAT_PPM:
+			return WritePPM(path, width, height, pixels);
+		case IMAGE_FORMAT_PFM:
+			return WritePFM(path, width, height, pixels);
+		case IMAGE_FORMAT_PNG:
+			return WritePNG(path, width, height, pixels);
+		default:
+			return false;
+		}
+	}
+
+	/** Write a frame as a binary PPM, colors are clamped to [0, 1]
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePPM(const char* path, unsigned int width, unsigned int height, const float* pixels)
+	{
+		FILE* file = fopen(path, "wb");
+		if(file == 0)
+		{
+			return false;
+		}
+
+		std::vector<unsigned char> bytes;
+		ToBytes(width, height, pixels, bytes);
+
+		fprintf(file, "P6\n%u %u\n255\n", width, height);
+		return WriteAndClose(file, bytes.empty() == false ? &bytes[0] : 0, bytes.size());
+	}
+
+	/** Write a frame as a PFM, keeping the full float range
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePFM(const char* path, unsigned int width, unsigned int height, const float* pixels)
+	{
+		FILE* file = fopen(path, "wb");
+		if(file == 0)
+		{
+			return false;
+		}
+
+		// PFM stores rows bottom up like the frame, so it is written as is. The negative scale marks
+		// the floats as little endian, which every platform we build for is
+		fprintf(file, "PF\n%u %u\n-1.0\n", width, height);
+		return WriteAndClose(file, pixels, width * height * 3 * sizeof(float));
+	}
+
+	/** Write a frame as an uncompressed PNG, colors are clamped to [0, 1]
+	* @param
+	*	path The file to write
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels RGB floats stored bottom up
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WritePNG(const char* path, unsigned int width, unsigned int height, const float* pixels)
+	{
+		FILE* file = fopen(path, "wb");
+		if(file == 0)
+		{
+			return false;
+		}
+
+		std::vector<unsigned char> bytes;
+		ToBytes(width, height, pixels, bytes);
+
+		// Every scanline starts with filter type 0
+		unsigned int stride = width * 3;
+		std::vector<unsigned char> raw;
+		raw.reserve((stride + 1) * height);
+		for(unsigned int y = 0; y < height; ++y)
+		{
+			raw.push_back(0);
+			raw.insert(raw.end(), bytes.begin() + y * stride, bytes.begin() + (y + 1) * stride);
+		}
+
+		// Wrap the scanlines in a zlib stream of stored deflate blocks, which avoids pulling in zlib
+		// at the cost of file size
+		std::vector<unsigned char> idat;
+		idat.push_back(0x78);
+		idat.push_back(0x01);
+		size_t offset = 0;
+		do
+		{
+			size_t blockSize = raw.size() - offset < 65535 ? raw.size() - offset : 65535;
+			bool last = offset + blockSize == raw.size();
+			idat.push_back(last == true ? 1 : 0);
+			idat.push_back(static_cast<unsigned char>(blockSize));
+			idat.push_back(static_cast<unsigned char>(blockSize >> 8));
+			idat.push_back(static_cast<unsigned char>(~blockSize));
+			idat.push_back(static_cast<unsigned char>(~blockSize >> 8));
+			idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+			offset += blockSize;
+		} while(offset < raw.size());
+
+		// Adler-32 of the uncompressed data closes the zlib stream
+		unsigned int a = 1;
+		unsigned int b = 0;
+		for(size_t i = 0; i < raw.size(); ++i)
+		{
+			a = (a + raw[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		PutU32(idat, (b << 16) | a);
+
+		std::vector<unsigned char> header;
+		PutU32(header, width);
+		PutU32(header, height);
+		header.push_back(8);		// Bit depth
+		header.push_back(2);		// Truecolor
+		header.push_back(0);		// Deflate
+		header.push_back(0);		// Adaptive filtering
+		header.push_back(0);		// No interlace
+
+		static const unsigned char Signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		std::vector<unsigned char> png(Signature, Signature + sizeof(Signature));
+		PutChunk(png, "IHDR", header);
+		PutChunk(png, "IDAT", idat);
+		PutChunk(png, "IEND", std::vector<unsigned char>());
+
+		return WriteAndClose(file, &png[0], png.size());
+	}
+
+}	// Namespace
@@ -1,6 +1,7 @@
 #include <windows.h>
 #include <gl/GL.h>
 #include <math.h>
+#include "GLPresenter.h"
 #include "SceneRenderer.h"
 
 using namespace SuperTrace;
@@ -99,8 +100,9 @@ int WINAPI WinMain(HINSTANCE hInstance,
 				glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 				glClear(GL_COLOR_BUFFER_BIT);
 
-				// Set the scene context values
-				sceneRenderer->setContext(hDC, hRC);
+				// Present completed chunks to the window
+				GLPresenter* presenter = new GLPresenter(hDC, hRC);
+				sceneRenderer->setPresenter(presenter);
 
 				sceneRenderer->render(width, height);
 
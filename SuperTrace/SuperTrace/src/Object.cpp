@@ -4,7 +4,9 @@
 // Description: A basic object from which other obects can inheric
 //*************************************************************************************************
 #include "Object.h"
-#include <random>
+#include "HitRecord.h"
+#include "Ray.h"
+#include "RayPacket.h"
 
 namespace SuperTrace
 {
@@ -13,12 +15,9 @@ namespace SuperTrace
 	*	world The world matrix
 	*/
 	Object::Object(const Matrix44& world)
-		:	_world(world)
+		:	_world(world), _color(1.0f, 1.0f, 1.0f)
 	{
-		// Get random colors
-		_color = Color(	static_cast<float>(rand()) / static_cast<float>(RAND_MAX),
-							static_cast<float>(rand()) / static_cast<float>(RAND_MAX),
-							static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+		// Objects may be constructed on any thread, so nothing here may draw from a shared generator
 	}
 
 	/** Destructor
@@ -27,6 +26,50 @@ namespace SuperTrace
 	{
 	}
 
+	/** Any hit test, cheaper than intersect when only visibility matters
+	* @param
+	*	ray The ray to test, only hits within [tMin, tMax] count
+	* @return
+	*	bool True if the object blocks the ray
+	*/
+	bool Object::occludes(const Ray& ray) const
+	{
+		// Objects without a cheaper test fall back to a closest hit limited to the ray
+		HitRecord hit(ray.getTMax());
+		return intersect(ray, hit);
+	}
+
+	/** Test the active lanes of a ray packet for intersection
+	* @param
+	*	packet The rays to test
+	* @param
+	*	mask The lanes to test, a bit per lane
+	* @param
+	*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+	* @return
+	*	unsigned int The lanes whose hit was overwritten
+	*/
+	unsigned int Object::intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const
+	{
+		// Objects without a packet test fall back to testing each lane on its own
+		unsigned int updated = 0;
+		for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+		{
+			if((mask & (1u << lane)) == 0)
+			{
+				continue;
+			}
+
+			HitRecord hit = hits.getHit(lane);
+			if(intersect(packet.getRay(lane), hit) == true)
+			{
+				hits.setHit(lane, hit);
+				updated |= 1u << lane;
+			}
+		}
+		return updated;
+	}
+
 	/** Get the color
 	* @return
 	*	Vector3 The color vector for this object
@@ -3,12 +3,19 @@
 //*************************************************************************************************
 #include "PointLight.h"
 #include "Color.h"
+#include "HitRecord.h"
 #include "Object.h"
 #include "Ray.h"
+#include "RenderStats.h"
+#include "Scene.h"
 #include <algorithm>
+#include <math.h>
 
 namespace SuperTrace
 {
+	// Distance shadow rays start off the surface, keeps them from hitting the surface they leave
+	static const float ShadowBias = 1.0e-3f;
+
 	/** Constructor
 	*/
 	PointLight::PointLight()
@@ -34,21 +41,31 @@ namespace SuperTrace
 	PointLight::~PointLight()
 	{ }
 
-	/** Determine the color based on the object's properties
+	/** Determine the light's contribution to a surface point
+	* @param
+	*	scene The scene, queried for anything blocking the light
+	* @param
+	*	hit The closest hit of the ray
+	* @param
+	*	ray The ray that found the hit
+	* @param
+	*	stats Receives counts of the shadow rays cast
+	* @return
+	*	Color The reflected color
 	*/
-	Color PointLight::compute(const Object* obj, const Ray& ray)
+	Color PointLight::compute(const Scene& scene, const HitRecord& hit, const Ray& ray, RayStats& stats) const
 	{
+		ST_STATS_ADD(numShadingCalls, 1);
+
 		// Default the color to black
 		Color color;
 
-		// Calculate the intersection point
-		Vector3 contactPoint = ray(ray.getTMax());
-
-		// Get the surface normal for the given ray.
-		Vector3 normal = obj->getSurfaceNormal(contactPoint);
+		// Calculate the intersection point, the normal comes with the hit
+		Vector3 contactPoint = ray(hit.t);
+		const Vector3& normal = hit.normal;
 
 		// Calculate the "eye" position
-		Vector3 toEye = ray.getOrigin() - contactPoint;
+		Vector3 toEye = -ray.getDirection();
 		toEye.normalize();
 
 		// Vector from contact point to light source
@@ -65,8 +82,8 @@ namespace SuperTrace
 		// Normalize the light vector
 		lightDirection.normalize();
 
-		// Get the object's material
-		const Material& m = obj->getMaterial();
+		// Get the material of the surface that was hit
+		const Material& m = *hit.material;
 
 		// Calculate ambient term
 		Vector4 ambient = m.getAmbient() * _ambient;
@@ -76,6 +93,18 @@ namespace SuperTrace
 		// Calculate diffuse term
 		float diffuseFactor = lightDirection.dot(normal);
 
+		// Only a surface facing the light can be lit by it, so only then is a shadow ray worth casting
+		if(diffuseFactor > 0.0f)
+		{
+			// Start just off the surface so the ray cannot find the surface itself, and stop short of
+			// the light
+			Ray shadowRay(contactPoint + normal * ShadowBias, lightDirection, RAY_TYPE_SHADOW, 0.0f, distance - ShadowBias);
+			if(scene.occluded(shadowRay, stats) == true)
+			{
+				diffuseFactor = 0.0f;
+			}
+		}
+
 		if(diffuseFactor > 0.0f)
 		{
 			// Calculate the diffuse value
@@ -0,0 +1,159 @@
+//*************************************************************************************************
+// Title: Presenter.cpp
+// Description: Base class for the backends that show a frame while it is being traced. Completed
+//	chunks are coalesced into dirty rectangles and only those are handed to the backend.
+//*************************************************************************************************
+#include "Presenter.h"
+#include <algorithm>
+
+namespace SuperTrace
+{
+	/** Check whether two rectangles together form a rectangle with no pixels to spare
+	* @param
+	*	a The first rectangle
+	* @param
+	*	b The second rectangle
+	* @return
+	*	bool True if the rectangles share a full edge
+	*/
+	static bool CanMerge(const RenderData& a, const RenderData& b)
+	{
+		if(a._startX == b._startX && a._width == b._width)
+		{
+			return a._startY + a._height == b._startY || b._startY + b._height == a._startY;
+		}
+		if(a._startY == b._startY && a._height == b._height)
+		{
+			return a._startX + a._width == b._startX || b._startX + b._width == a._startX;
+		}
+		return false;
+	}
+
+	/** Default constructor
+	*/
+	Presenter::Presenter()
+		:	_width(0), _height(0), _pixels(0), _presentInterval(1.0 / 60.0)
+	{ }
+
+	/** Destructor
+	*/
+	Presenter::~Presenter()
+	{ }
+
+	/** Set the maximum number of uploads per second
+	* @param
+	*	hz The refresh rate, 0 to upload as soon as chunks arrive
+	*/
+	void Presenter::setMaxRefreshRate(double hz)
+	{
+		_presentInterval = hz > 0.0 ? 1.0 / hz : 0.0;
+	}
+
+	/** Get the minimum time between two uploads
+	* @return
+	*	double The interval in seconds, 0 if uncapped
+	*/
+	double Presenter::getPresentInterval() const
+	{
+		return _presentInterval;
+	}
+
+	/** Called on the thread that starts a render, before the present thread runs
+	* @param
+	*	width The image width
+	* @param
+	*	height The image height
+	* @param
+	*	pixels The frame buffer, RGB floats stored bottom up
+	*/
+	void Presenter::begin(unsigned int width, unsigned int height, const float* pixels)
+	{
+		_width = width;
+		_height = height;
+		_pixels = pixels;
+		_dirtyRects.clear();
+		_stats = PresenterStats();
+	}
+
+	/** Called on the present thread before its first upload
+	*/
+	void Presenter::attach()
+	{ }
+
+	/** Called on the present thread once the frame has been fully presented
+	*/
+	void Presenter::detach()
+	{ }
+
+	/** Mark a completed chunk as dirty, merging it with any rectangle it extends exactly
+	* @param
+	*	data The completed chunk
+	*/
+	void Presenter::addDirtyRect(const RenderData& data)
+	{
+		++_stats.numChunks;
+
+		// Grow the chunk for as long as it completes another dirty rectangle, rows of tiles become
+		// strips and neighbouring strips become larger blocks
+		RenderData rect = data;
+		for(unsigned int i = 0; i < _dirtyRects.size(); )
+		{
+			const RenderData& other = _dirtyRects[i];
+			if(CanMerge(rect, other) == false)
+			{
+				++i;
+				continue;
+			}
+
+			unsigned int right = std::max(rect._startX + rect._width, other._startX + other._width);
+			unsigned int bottom = std::max(rect._startY + rect._height, other._startY + other._height);
+			rect._startX = std::min(rect._startX, other._startX);
+			rect._startY = std::min(rect._startY, other._startY);
+			rect._width = right - rect._startX;
+			rect._height = bottom - rect._startY;
+
+			// The merged rectangle may now line up with one that was skipped, so start over
+			_dirtyRects[i] = _dirtyRects.back();
+			_dirtyRects.pop_back();
+			i = 0;
+		}
+
+		_dirtyRects.push_back(rect);
+	}
+
+	/** Upload every dirty rectangle and clear them
+	*/
+	void Presenter::present()
+	{
+		if(_dirtyRects.empty() == true)
+		{
+			return;
+		}
+
+		for(unsigned int i = 0; i < _dirtyRects.size(); ++i)
+		{
+			uploadRect(_dirtyRects[i]);
+			_stats.pixelsUploaded += static_cast<unsigned long long>(_dirtyRects[i]._width) * _dirtyRects[i]._height;
+		}
+		flush();
+
+		++_stats.numPresents;
+		_stats.numRects += static_cast<unsigned int>(_dirtyRects.size());
+		_dirtyRects.clear();
+	}
+
+	/** Get the upload statistics for the current frame
+	* @return
+	*	const PresenterStats& The statistics
+	*/
+	const PresenterStats& Presenter::getStats() const
+	{
+		return _stats;
+	}
+
+	/** Called after a batch of rectangles has been uploaded
+	*/
+	void Presenter::flush()
+	{ }
+
+}	// Namespace
@@ -0,0 +1,42 @@
+//*************************************************************************************************
+// Title: RenderStats.cpp
+// Description: Counters of the work done while rendering, kept per thread. Only compiled in when
+//	ST_ENABLE_STATS is defined, otherwise every count reads 0.
+//*************************************************************************************************
+#include "RenderStats.h"
+
+namespace SuperTrace
+{
+#ifdef ST_ENABLE_STATS
+	// Each thread counts into its own copy, nothing is shared until a worker folds its counts
+	// into its slot at the end of a tile
+	thread_local RenderStats ThreadRenderStats;
+#endif
+
+	/** Check whether render statistics are being counted
+	* @return
+	*	bool True when built with ST_ENABLE_STATS
+	*/
+	bool IsRenderStatsEnabled()
+	{
+#ifdef ST_ENABLE_STATS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** Get the work counted by the calling thread since it started
+	* @return
+	*	RenderStats The counts
+	*/
+	RenderStats GetThreadRenderStats()
+	{
+#ifdef ST_ENABLE_STATS
+		return ThreadRenderStats;
+#else
+		return RenderStats();
+#endif
+	}
+
+}	// Namespace
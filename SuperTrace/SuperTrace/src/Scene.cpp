@@ -7,30 +7,117 @@
 
 #include "Material.h"
 #include "Camera.h"
+#include "RayPacket.h"
 #include "Color.h"
+#include "HitRecord.h"
 #include "Object.h"
 #include "Ray.h"
 #include "Sphere.h"
 #include "STMath.h"
 #include "PointLight.h"
-#include <ctime>
+#include "Random.h"
+#include "RenderStats.h"
 
 namespace SuperTrace
 {
+	/** Draw a point inside a box, one axis at a time
+	*/
+	static Vector3 RandomPoint(Random& random, const Vector3& min, const Vector3& max)
+	{
+		float x = random.nextFloat(min.getX(), max.getX());
+		float y = random.nextFloat(min.getY(), max.getY());
+		float z = random.nextFloat(min.getZ(), max.getZ());
+		return Vector3(x, y, z);
+	}
+
+	// Lights and objects are scattered through this box
+	static const Vector3 SceneMin(-25.0f, -25.0f, -2.0f);
+	static const Vector3 SceneMax(25.0f, 25.0f, 90.0f);
+
 	/** Default constructor
 	*/
 	Scene::Scene()
 		:	_camera(0)
 	{ }
 
-	/** Create the scene
+	/** Remove every object, light and the camera and reset the arena, keeping its blocks and the
+	*	containers' capacity so the next scene of the same size is built without the heap
+	*/
+	void Scene::reset()
+	{
+		_objects.clear();
+		_lights.clear();
+		_camera = 0;
+		_arena.reset();
+	}
+
+	/** Create the scene, the same seed always gives the same scene
+	* @param
+	*	seed The seed for the scene's random layout
+	*/
+	void Scene::createScene(unsigned int seed)
+	{
+		Random random(seed);
+		createLights(random);
+		createObjects(random);
+		buildAccelerationStructure();
+	}
+
+	/** Add an object, it must live as long as the scene so it is usually created in the arena
+	* @param
+	*	object The object
+	*/
+	void Scene::addObject(Object* object)
+	{
+		_objects.push_back(object);
+	}
+
+	/** Add a light, it must live as long as the scene so it is usually created in the arena
+	* @param
+	*	light The light
+	*/
+	void Scene::addLight(Light* light)
+	{
+		_lights.push_back(light);
+	}
+
+	/** Get the number of objects in the scene
+	* @return
+	*	unsigned int The number of objects
+	*/
+	unsigned int Scene::getNumObjects() const
+	{
+		return static_cast<unsigned int>(_objects.size());
+	}
+
+	/** Get the number of lights in the scene
+	* @return
+	*	unsigned int The number of lights
 	*/
-	void Scene::createScene()
+	unsigned int Scene::getNumLights() const
 	{
-		srand(time(0));
+		return static_cast<unsigned int>(_lights.size());
+	}
 
-		createLights();
-		createObjects();
+	/** Build the acceleration structure over the scene's objects, call after objects are added
+	*/
+	void Scene::buildAccelerationStructure()
+	{
+		_bounds.resize(_objects.size());
+		for(unsigned int i = 0; i < _objects.size(); ++i)
+		{
+			_bounds[i] = _objects[i]->getBounds();
+		}
+		_bvh.build(_bounds);
+	}
+
+	/** Get the statistics of the last acceleration structure build
+	* @return
+	*	const BVHBuildStats& The build statistics
+	*/
+	const BVHBuildStats& Scene::getAccelerationStats() const
+	{
+		return _bvh.getBuildStats();
 	}
 
 	/** Trace a given rasterized position
@@ -38,36 +125,159 @@ namespace SuperTrace
 	*	x The rasterized x position
 	* @param
 	*	y The rasterized y position
+	* @param
+	*	stats Receives counts of the rays cast
 	*/
-	Color Scene::trace(unsigned int x, unsigned int y)
+	Color Scene::trace(unsigned int x, unsigned int y, RayStats& stats)
 	{
-		// Resultant color
-		Color color;
+		return trace(_camera->rasterToRay(x, y), stats);
+	}
 
-		// Get the direction ray
-		Ray ray = _camera->rasterToRay(x, y);
+	/** Trace a camera ray
+	* @param
+	*	ray The camera ray
+	* @param
+	*	stats Receives counts of the rays cast
+	* @return
+	*	Color The color seen along the ray
+	*/
+	Color Scene::trace(const Ray& ray, RayStats& stats)
+	{
+		++stats.numCameraRays;
+		ST_STATS_ADD(numRays[RAY_TYPE_CAMERA], 1);
+
+		// Visibility first, so only the surface that is actually seen gets shaded
+		HitRecord hit;
+		if(findClosestHit(ray, hit) == false)
+		{
+			return Color();
+		}
+		return shade(hit, ray, stats);
+	}
+
+	/** Trace a packet of camera rays together, visibility runs across the packet and the
+	*	surfaces found are then shaded
+	* @param
+	*	packet The camera rays
+	* @param
+	*	colors Receives the color seen along each ray in the packet
+	* @param
+	*	stats Receives counts of the rays cast
+	*/
+	void Scene::tracePacket(const RayPacket& packet, Color* colors, RayStats& stats)
+	{
+		stats.numCameraRays += packet.count;
+		ST_STATS_ADD(numRays[RAY_TYPE_CAMERA], packet.count);
 
-		std::list<Object*>::iterator end = _objects.end();
-		// Iterate through the list of objects to see if this ray will need to return a color
-		for(std::list<Object*>::iterator itr = _objects.begin(); itr != end; ++itr)
+		// Every lane searches for its closest hit in the same walk
+		HitPacket hits;
+		hits.reset(packet);
+		_bvh.traversePacket(packet, packet.getActiveMask(), hits.t, [&](unsigned int index, unsigned int mask)
 		{
-			Object* obj = *itr;
-			if(obj->intersect(ray) == true)
+			unsigned int updated = _objects[index]->intersectPacket(packet, mask, hits);
+			for(unsigned int lane = 0; updated != 0; ++lane, updated >>= 1)
 			{
-				// We passed the intersection test for this object, now we need to locate a light source to determine the color
-				
-				// For now, just iterate through lights and cast shadow rays
-				std::list<Light*>::iterator lEnd = _lights.end();
-				for(std::list<Light*>::iterator lItr = _lights.begin(); lItr != lEnd; ++lItr)
+				if((updated & 1) != 0)
 				{
-					Light* light = *lItr;
-					color = light->compute(obj, ray);
+					hits.primitive[lane] = index;
 				}
 			}
+			return false;
+		});
+
+		// Lights work on one hit at a time
+		for(unsigned int lane = 0; lane < packet.count; ++lane)
+		{
+			if(hits.object[lane] == 0)
+			{
+				colors[lane] = Color();
+				continue;
+			}
+			colors[lane] = shade(hits.getHit(lane), packet.getRay(lane), stats);
+		}
+	}
+
+	/** Check whether anything lies along a ray, stopping at the first hit found rather than
+	*	searching for the closest
+	* @param
+	*	ray The ray, only hits within [tMin, tMax] count
+	* @param
+	*	stats Receives counts of the rays cast
+	* @return
+	*	bool True if the ray is blocked
+	*/
+	bool Scene::occluded(const Ray& ray, RayStats& stats) const
+	{
+		++stats.numShadowRays;
+		ST_STATS_ADD(numRays[ray.getType()], 1);
+
+		// Any blocker will do, so the walk stops at the first one instead of shortening the ray
+		bool blocked = _bvh.traverseAny(ray, [&](unsigned int index)
+		{
+			return _objects[index]->occludes(ray);
+		});
+
+		if(blocked == true)
+		{
+			++stats.numOccludedShadowRays;
+		}
+		return blocked;
+	}
+
+	/** Find the closest surface along a ray
+	* @param
+	*	ray The ray
+	* @param
+	*	hit Receives the closest hit
+	* @return
+	*	bool True if the ray hit anything
+	*/
+	bool Scene::findClosestHit(const Ray& ray, HitRecord& hit) const
+	{
+		// Walk the objects along the ray, each accepted hit shortens hit.t so the last one is the closest
+		hit = HitRecord(ray.getTMax());
+		_bvh.traverse(ray, hit.t, [&](unsigned int index)
+		{
+			if(_objects[index]->intersect(ray, hit) == true)
+			{
+				hit.primitive = index;
+			}
+			return false;
+		});
+		return hit.isHit();
+	}
+
+	/** Shade a surface point with every light in the scene
+	* @param
+	*	hit The closest hit of the ray
+	* @param
+	*	ray The ray that found the hit
+	* @param
+	*	stats Receives counts of the shadow rays cast
+	* @return
+	*	Color The sum of the light contributions
+	*/
+	Color Scene::shade(const HitRecord& hit, const Ray& ray, RayStats& stats) const
+	{
+		Color color;
+		stats.numShadingSamples += _lights.size();
+		for(unsigned int i = 0; i < _lights.size(); ++i)
+		{
+			color += _lights[i]->compute(*this, hit, ray, stats);
 		}
 		return color;
 	}
 
+	/** Get the arena holding the scene's objects and lights, anything created in it lives as
+	*	long as the scene
+	* @return
+	*	Arena& The scene arena
+	*/
+	Arena& Scene::getArena()
+	{
+		return _arena;
+	}
+
 	/** Create the camera for the scene
 	*/
 	void Scene::setCamera(Camera* camera)
@@ -76,9 +286,20 @@ namespace SuperTrace
 
 	}
 
+	/** Get the scene camera
+	* @return
+	*	const Camera* The camera, NULL if none has been set
+	*/
+	const Camera* Scene::getCamera() const
+	{
+		return _camera;
+	}
+
 	/** Create lights
+	* @param
+	*	random The generator for the scene's layout
 	*/
-	void Scene::createLights()
+	void Scene::createLights(Random& random)
 	{
 		// Setup light components
 		Vector4 ambient;
@@ -86,22 +307,28 @@ namespace SuperTrace
 		Vector4 specular;
 
 		// Generate 10 random lights
-		for(int i = 0; i < 40; ++i)
+		const int NumLights = 40;
+
+		// Shading sums every light, so each gets its share of the range, a third of them are points
+		const float lightScale = 3.0f / NumLights;
+		_lights.reserve(NumLights);
+
+		for(int i = 0; i < NumLights; ++i)
 		{
 			// Generate base light features
-			ambient = Vector4(Randf(), Randf(), Randf(), 1.0f);
-			diffuse = Vector4(Randf(), Randf(), Randf(), 1.0f);
-			specular = Vector4(Randf(), Randf(), Randf(), 1.0f);
+			ambient = RandomColor(random, 1.0f) * lightScale;
+			diffuse = RandomColor(random, 1.0f) * lightScale;
+			specular = RandomColor(random, 1.0f) * lightScale;
 
-			int lightType = rand() % 3;
+			int lightType = random.nextUInt(3);
 
 			// Point
 			if(lightType == 0)
 			{
-				Vector3 position = Vector3(Randf(-25.0f, 25.0f), Randf(-25.0f, 25.0f), Randf(-2.0f, 90.0f));
-				Vector3 attenuation = Vector3(Randf(0.0f, 0.2f), Randf(0.0f, 0.2f), Randf(0.0f, 0.2f));
+				Vector3 position = RandomPoint(random, SceneMin, SceneMax);
+				Vector3 attenuation = RandomPoint(random, Vector3(0.0f, 0.0f, 0.0f), Vector3(0.2f, 0.2f, 0.2f));
 
-				PointLight* pl = new PointLight(position, attenuation, 1000.0f,
+				PointLight* pl = _arena.create<PointLight>(position, attenuation, 1000.0f,
 												ambient, diffuse, specular);
 				_lights.push_back(pl);
 			}
@@ -118,31 +345,30 @@ namespace SuperTrace
 	}
 
 	/** Add objects to the scene
+	* @param
+	*	random The generator for the scene's layout
 	*/
-	void Scene::createObjects()
+	void Scene::createObjects(Random& random)
 	{
 		// Create spheres
 		Matrix44 identity;
 		identity.setIdentity();
 		
-		Vector4 ambient;
-		Vector4 diffuse;
-		Vector4 specular;
 		Material m;
 		Vector3 position;
 
-		for(int i = 0; i < 60; ++i)
+		const int NumSpheres = 60;
+		_objects.reserve(NumSpheres);
+
+		for(int i = 0; i < NumSpheres; ++i)
 		{
 			// Generate material properties
-			ambient = Vector4(Randf(), Randf(), Randf(), 1.0f);
-			diffuse = Vector4(Randf(), Randf(), Randf(), 1.0f);
-			specular = Vector4(Randf(), Randf(), Randf(), Randf(2.0f, 8.0f));
-			m = Material(ambient, diffuse, specular);
+			m = RandomMaterial(random);
 
 			// Generate position
-			position = Vector3(Randf(-25.0f, 25.0f), Randf(-25.0f, 25.0f), Randf(-2.0f, 90.0f));
+			position = RandomPoint(random, SceneMin, SceneMax);
 
-			Sphere* s = new Sphere(identity, position, Randf(0.5f, 3.0f));
+			Sphere* s = _arena.create<Sphere>(identity, position, random.nextFloat(0.5f, 3.0f));
 			s->setMaterial(m);
 			_objects.push_back(s);
 		}
@@ -0,0 +1,308 @@
+//*************************************************************************************************
+// Title: SceneGenerator.cpp
+// Description: Procedural scenes of any size for scaling tests. The same settings always give the
+//	same scene, whatever the number of threads it was generated on.
+//*************************************************************************************************
+#include "SceneGenerator.h"
+#include "Box3.h"
+#include "Material.h"
+#include "Matrix44.h"
+#include "ParallelFor.h"
+#include "PointLight.h"
+#include "Random.h"
+#include "Scene.h"
+#include "Sphere.h"
+#include "SphereSet.h"
+#include "Timeline.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// Placements are drawn this many at a time, each block from a generator of its own
+		const unsigned int BlockSize = 4096;
+
+		const char* const DistributionNames[NUM_SCENE_DISTRIBUTIONS] = { "uniform", "clustered", "grid" };
+		const char* const PrimitiveNames[NUM_SCENE_PRIMITIVES] = { "particles", "spheres", "boxes" };
+
+		/** Where a sphere or box object goes, drawn in parallel before the objects are created
+		*/
+		struct Placement
+		{
+			Vector3 center;
+			Vector3 halfSize;
+			unsigned int material;
+		};
+
+		/** What every block needs to place its primitives
+		*/
+		struct Layout
+		{
+			Vector3 boundsMin;
+			Vector3 extent;
+			std::vector<Vector3> clusters;
+			unsigned int gridCounts[3];
+		};
+
+		/** Get the point at a fraction of the way across the bounds along each axis
+		*/
+		Vector3 PointInBounds(const Layout& layout, float x, float y, float z)
+		{
+			const Vector3& extent = layout.extent;
+			return layout.boundsMin + Vector3(x * extent.getX(), y * extent.getY(), z * extent.getZ());
+		}
+
+		/** Draw a point inside the bounds, one axis at a time
+		*/
+		Vector3 RandomPoint(Random& random, const Layout& layout)
+		{
+			float x = random.nextFloat();
+			float y = random.nextFloat();
+			float z = random.nextFloat();
+			return PointInBounds(layout, x, y, z);
+		}
+
+		/** Get the generator for a block, stream 0 is kept for what the whole scene shares
+		*/
+		Random BlockRandom(unsigned int seed, unsigned int block)
+		{
+			return Random(MixBits(seed), block + 1);
+		}
+
+		/** Size a lattice with close to cubic cells that has room for every primitive
+		*/
+		void SizeGrid(const SceneGeneratorSettings& settings, Layout& layout)
+		{
+			// Flat bounds still get a layer of cells
+			float x = std::max(layout.extent.getX(), 1.0e-3f);
+			float y = std::max(layout.extent.getY(), 1.0e-3f);
+			float z = std::max(layout.extent.getZ(), 1.0e-3f);
+			float cell = cbrtf(x * y * z / std::max(settings.numObjects, 1u));
+
+			// Rounding every axis up can only add cells
+			layout.gridCounts[0] = std::max(static_cast<unsigned int>(ceilf(x / cell)), 1u);
+			layout.gridCounts[1] = std::max(static_cast<unsigned int>(ceilf(y / cell)), 1u);
+			layout.gridCounts[2] = std::max(static_cast<unsigned int>(ceilf(z / cell)), 1u);
+		}
+
+		/** Draw the center of a primitive
+		*/
+		Vector3 PlaceCenter(const SceneGeneratorSettings& settings, const Layout& layout, Random& random, unsigned int index)
+		{
+			if(settings.distribution == SCENE_DISTRIBUTION_CLUSTERED && layout.clusters.empty() == false)
+			{
+				// A point in the unit ball pulled in by a uniform scale, so primitives pile up towards
+				// the middle of their cluster
+				const Vector3& center = layout.clusters[random.nextUInt(static_cast<unsigned int>(layout.clusters.size()))];
+				float x, y, z;
+				do
+				{
+					x = random.nextFloat(-1.0f, 1.0f);
+					y = random.nextFloat(-1.0f, 1.0f);
+					z = random.nextFloat(-1.0f, 1.0f);
+				}
+				while(x * x + y * y + z * z > 1.0f);
+				return center + Vector3(x, y, z) * (settings.clusterRadius * random.nextFloat());
+			}
+
+			if(settings.distribution == SCENE_DISTRIBUTION_GRID)
+			{
+				// Rows along x, then layers front to back
+				unsigned int nx = layout.gridCounts[0];
+				unsigned int ny = layout.gridCounts[1];
+				float x = (index % nx + 0.5f) / nx;
+				float y = (index / nx % ny + 0.5f) / ny;
+				float z = (index / (nx * ny) + 0.5f) / layout.gridCounts[2];
+				return PointInBounds(layout, x, y, z);
+			}
+
+			return RandomPoint(random, layout);
+		}
+	}
+
+	/** Get the name of a distribution
+	* @param
+	*	distribution The distribution
+	* @return
+	*	const char* The name, as parsed by SceneDistributionFromName
+	*/
+	const char* GetSceneDistributionName(SceneDistribution distribution)
+	{
+		return distribution < NUM_SCENE_DISTRIBUTIONS ? DistributionNames[distribution] : "unknown";
+	}
+
+	/** Find a distribution by name
+	* @param
+	*	name uniform, clustered or grid
+	* @return
+	*	SceneDistribution The distribution, NUM_SCENE_DISTRIBUTIONS if the name is unknown
+	*/
+	SceneDistribution SceneDistributionFromName(const char* name)
+	{
+		for(unsigned int i = 0; i < NUM_SCENE_DISTRIBUTIONS; ++i)
+		{
+			if(strcmp(name, DistributionNames[i]) == 0)
+			{
+				return static_cast<SceneDistribution>(i);
+			}
+		}
+		return NUM_SCENE_DISTRIBUTIONS;
+	}
+
+	/** Get the name of a primitive type
+	* @param
+	*	primitive The primitive type
+	* @return
+	*	const char* The name, as parsed by ScenePrimitiveFromName
+	*/
+	const char* GetScenePrimitiveName(ScenePrimitive primitive)
+	{
+		return primitive < NUM_SCENE_PRIMITIVES ? PrimitiveNames[primitive] : "unknown";
+	}
+
+	/** Find a primitive type by name
+	* @param
+	*	name particles, spheres or boxes
+	* @return
+	*	ScenePrimitive The primitive type, NUM_SCENE_PRIMITIVES if the name is unknown
+	*/
+	ScenePrimitive ScenePrimitiveFromName(const char* name)
+	{
+		for(unsigned int i = 0; i < NUM_SCENE_PRIMITIVES; ++i)
+		{
+			if(strcmp(name, PrimitiveNames[i]) == 0)
+			{
+				return static_cast<ScenePrimitive>(i);
+			}
+		}
+		return NUM_SCENE_PRIMITIVES;
+	}
+
+	/** Fill a scene with generated primitives and lights. Placements are drawn in parallel in
+	*	fixed blocks, each from a generator of its own, so the scene does not depend on the thread
+	*	count. Particles are written straight into their sphere set from every thread, sphere and
+	*	box objects are created in the scene arena on the calling thread once placed. Call
+	*	Scene::buildAccelerationStructure afterwards, as SceneRenderer does for a scene builder
+	* @param
+	*	scene The scene to add to
+	* @param
+	*	settings What to generate
+	*/
+	void GenerateScene(Scene& scene, const SceneGeneratorSettings& settings)
+	{
+		TimelineSpan generateSpan("Generate scene");
+
+		unsigned int numThreads = settings.numThreads;
+		if(numThreads == 0)
+		{
+			numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		// Everything the blocks share is drawn up front from stream 0
+		Random random(MixBits(settings.seed), 0);
+		Layout layout;
+		layout.boundsMin = settings.boundsMin;
+		layout.extent = settings.boundsMax - settings.boundsMin;
+		if(settings.distribution == SCENE_DISTRIBUTION_CLUSTERED)
+		{
+			layout.clusters.resize(settings.numClusters);
+			for(unsigned int i = 0; i < settings.numClusters; ++i)
+			{
+				layout.clusters[i] = RandomPoint(random, layout);
+			}
+		}
+		SizeGrid(settings, layout);
+
+		std::vector<Material> materials(std::max(settings.numMaterials, 1u));
+		for(unsigned int i = 0; i < materials.size(); ++i)
+		{
+			materials[i] = RandomMaterial(random);
+		}
+		unsigned int numMaterials = static_cast<unsigned int>(materials.size());
+
+		Matrix44 identity;
+		identity.setIdentity();
+		unsigned int numObjects = settings.numObjects;
+
+		if(settings.primitive == SCENE_PRIMITIVE_PARTICLES)
+		{
+			// One object for every sphere, filled in place
+			SphereSet* particles = scene.getArena().create<SphereSet>(identity);
+			for(unsigned int i = 0; i < numMaterials; ++i)
+			{
+				particles->addMaterial(materials[i]);
+			}
+			particles->resize(numObjects);
+
+			ParallelForBlocks(numThreads, numObjects, BlockSize, [&](unsigned int block, unsigned int begin, unsigned int end)
+			{
+				Random blockRandom = BlockRandom(settings.seed, block);
+				for(unsigned int i = begin; i < end; ++i)
+				{
+					Vector3 center = PlaceCenter(settings, layout, blockRandom, i);
+					float radius = blockRandom.nextFloat(settings.minSize, settings.maxSize);
+					particles->setSphere(i, center, radius, blockRandom.nextUInt(numMaterials));
+				}
+			});
+
+			if(numObjects > 0)
+			{
+				particles->build();
+				scene.addObject(particles);
+			}
+		}
+		else
+		{
+			// The arena is not shared between threads, so objects are only placed in parallel
+			std::vector<Placement> placements(numObjects);
+			ParallelForBlocks(numThreads, numObjects, BlockSize, [&](unsigned int block, unsigned int begin, unsigned int end)
+			{
+				Random blockRandom = BlockRandom(settings.seed, block);
+				for(unsigned int i = begin; i < end; ++i)
+				{
+					Placement& placement = placements[i];
+					placement.center = PlaceCenter(settings, layout, blockRandom, i);
+					float x = blockRandom.nextFloat(settings.minSize, settings.maxSize);
+					float y = settings.primitive == SCENE_PRIMITIVE_BOXES ? blockRandom.nextFloat(settings.minSize, settings.maxSize) : x;
+					float z = settings.primitive == SCENE_PRIMITIVE_BOXES ? blockRandom.nextFloat(settings.minSize, settings.maxSize) : x;
+					placement.halfSize = Vector3(x, y, z);
+					placement.material = blockRandom.nextUInt(numMaterials);
+				}
+			});
+
+			for(unsigned int i = 0; i < numObjects; ++i)
+			{
+				const Placement& placement = placements[i];
+				Object* object = 0;
+				if(settings.primitive == SCENE_PRIMITIVE_BOXES)
+				{
+					object = scene.getArena().create<Box3>(identity, placement.center - placement.halfSize, placement.center + placement.halfSize);
+				}
+				else
+				{
+					object = scene.getArena().create<Sphere>(identity, placement.center, placement.halfSize.getX());
+				}
+				object->setMaterial(materials[placement.material]);
+				scene.addObject(object);
+			}
+		}
+
+		// Shading sums every light, so each gets its share of the brightness
+		float lightScale = 1.0f / std::max(settings.numLights, 1u);
+		for(unsigned int i = 0; i < settings.numLights; ++i)
+		{
+			Vector4 ambient = RandomColor(random, 1.0f) * lightScale;
+			Vector4 diffuse = RandomColor(random, 1.0f) * lightScale;
+			Vector4 specular = RandomColor(random, 1.0f) * lightScale;
+			Vector3 position = RandomPoint(random, layout);
+			float attenuation = random.nextFloat(0.0f, 0.05f);
+			scene.addLight(scene.getArena().create<PointLight>(position, Vector3(1.0f, attenuation, 0.0f), 1000.0f, ambient, diffuse, specular));
+		}
+	}
+
+}	// Namespace
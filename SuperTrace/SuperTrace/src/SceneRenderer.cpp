@@ -10,8 +10,13 @@
 #include "STMath.h"
 #include "Scene.h"
 #include "Color.h"
-#include <Windows.h>
-#include <gl/GL.h>
+#include "Presenter.h"
+#include "RayPacket.h"
+#include "Timeline.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
 
 // TEMP
 #include "Sphere.h"
@@ -19,31 +24,70 @@
 
 namespace SuperTrace
 {
-	DWORD WINAPI TraceWorker(LPVOID lpParam);
-	DWORD WINAPI RenderWorker(LPVOID lpParam);
-	CRITICAL_SECTION cs;
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// Square tile sizes considered by adaptive tiling, largest first
+	static const unsigned int AdaptiveTileSizes[] = { 128, 64, 32, 16, 8 };
+
+	// Both halves of a split tile keep at least this many rows
+	static const unsigned int MinSplitRows = 4;
+
+	// Room each worker queue keeps for split tiles, a split is skipped when its queue is full
+	static const unsigned int SplitQueueSlack = 64;
+
+	// Each worker's scratch starts on its own cache line so workers never write to a shared line
+	static const size_t CacheLineSize = 64;
 
 	/** Default constructor
 	*/
 	SceneRenderer::SceneRenderer()
-	:   _numChunks(0)
+	:   _numChunks(0),
+		_tilingMode(TILING_ADAPTIVE),
+		_targetTilesPerWorker(8),
+		_tileCacheBudget(64 * 1024),
+		_tileSplitTime(0.02),
+		_packetTracing(PacketHasSimd),
+		_tileBuffers(true),
+		_tileCostOrdering(true),
+		_sceneSeed(1),
+		_firstTileDone(false),
+		_numSplits(0),
+		_recordedWidth(0),
+		_recordedHeight(0),
+		_recordedTileWidth(0),
+		_recordedTileHeight(0),
+		_traceScratch(0),
+		_presenterWaiting(false),
+		_remainingTiles(0),
+		_presenter(0),
+		_cWidth(0),
+		_cHeight(0),
+		_width(0),
+		_height(0),
+		_pixelData(0),
+		_scene(0)
 	{ }
 
 	/** Destructor
 	*/
 	SceneRenderer::~SceneRenderer()
-	{ }
+	{
+		waitForWorkers();
+		delete _scene;
+		delete[] _pixelData;
+	}
 
-	/** Set the number of chunks
+	/** Set the number of chunks along each axis, this selects TILING_CHUNK_COUNT
 	* @param
 	*   numChunks The number of chunks
 	*/
 	void SceneRenderer::setNumChunks(unsigned int numChunks)
 	{
 		_numChunks = numChunks;
+		_tilingMode = TILING_CHUNK_COUNT;
 	}
 
-	/** Calculate the optimal number of chunks for the given dimensions
+	/** Calculate the optimal tiling for the given dimensions, this selects TILING_ADAPTIVE
 	* @param
 	*   width The window width
 	* @param
@@ -51,62 +95,303 @@ namespace SuperTrace
 	*/
 	void SceneRenderer::calcOptimalChunks(unsigned int width, unsigned int height)
 	{
-		// Find the greatest common divisor
-		// First use the binary method to simplify calculations
-		unsigned int d = 1;
-		bool canDivide = true;
-		while(canDivide == true)
+		_tilingMode = TILING_ADAPTIVE;
+		getChunkDimensions(width, height);
+	}
+
+	/** Set a fixed tile size in pixels, this selects TILING_FIXED_SIZE
+	* @param
+	*   tileWidth The tile width
+	* @param
+	*   tileHeight The tile height
+	*/
+	void SceneRenderer::setTileSize(unsigned int tileWidth, unsigned int tileHeight)
+	{
+		_cWidth = std::max(tileWidth, 1u);
+		_cHeight = std::max(tileHeight, 1u);
+		_tilingMode = TILING_FIXED_SIZE;
+	}
+
+	/** Set the number of tiles each worker should receive when picking an adaptive tile size
+	* @param
+	*   tilesPerWorker The target number of tiles per worker
+	*/
+	void SceneRenderer::setTargetTilesPerWorker(unsigned int tilesPerWorker)
+	{
+		_targetTilesPerWorker = tilesPerWorker;
+	}
+
+	/** Set the maximum number of bytes of pixel data a single adaptive tile may cover
+	* @param
+	*   bytes The cache budget per tile
+	*/
+	void SceneRenderer::setTileCacheBudget(unsigned int bytes)
+	{
+		_tileCacheBudget = bytes;
+	}
+
+	/** Set the time after which a tile that is still being traced is split so idle workers can
+	*   steal the rest of it. Only adaptive tiling splits, fixed size and chunk count tiling
+	*   always trace the tiles they were given
+	* @param
+	*   seconds The split threshold, 0 disables splitting
+	*/
+	void SceneRenderer::setTileSplitTime(double seconds)
+	{
+		_tileSplitTime = seconds;
+	}
+
+	/** Set whether camera rays are traced in packets along each row rather than one at a time,
+	*   on by default when packets use SIMD
+	* @param
+	*   packetTracing True to trace packets
+	*/
+	void SceneRenderer::setPacketTracing(bool packetTracing)
+	{
+		_packetTracing = packetTracing;
+	}
+
+	/** Get whether camera rays are traced in packets
+	* @return
+	*   bool True if packets are traced
+	*/
+	bool SceneRenderer::getPacketTracing() const
+	{
+		return _packetTracing;
+	}
+
+	/** Set whether each worker traces a tile into its own buffer and copies it to the frame buffer
+	*   once the tile is done, rather than writing every pixel straight to the frame buffer where
+	*   workers on neighbouring tiles share cache lines, on by default
+	* @param
+	*   tileBuffers True to trace into tile buffers
+	*/
+	void SceneRenderer::setTileBuffers(bool tileBuffers)
+	{
+		_tileBuffers = tileBuffers;
+	}
+
+	/** Get whether workers trace into tile buffers
+	* @return
+	*   bool True if tile buffers are used
+	*/
+	bool SceneRenderer::getTileBuffers() const
+	{
+		return _tileBuffers;
+	}
+
+	/** Set whether tiles are handed out most expensive first, judged by what they cost in the
+	*   last render over the same tile grid, so the slowest tiles do not start last and hold up
+	*   the end of the frame. On by default, the first render and any render after the grid
+	*   changes go in raster order
+	* @param
+	*   costOrdering True to order tiles by their last cost
+	*/
+	void SceneRenderer::setTileCostOrdering(bool costOrdering)
+	{
+		_tileCostOrdering = costOrdering;
+	}
+
+	/** Get whether tiles are handed out most expensive first
+	* @return
+	*   bool True if tiles are ordered by cost
+	*/
+	bool SceneRenderer::getTileCostOrdering() const
+	{
+		return _tileCostOrdering;
+	}
+
+	/** Set the seed the scene is created from, the same seed gives the same image whatever the
+	*   number of workers
+	* @param
+	*   seed The scene seed
+	*/
+	void SceneRenderer::setSceneSeed(unsigned int seed)
+	{
+		_sceneSeed = seed;
+	}
+
+	/** Get the seed the scene is created from
+	* @return
+	*   unsigned int The scene seed
+	*/
+	unsigned int SceneRenderer::getSceneSeed() const
+	{
+		return _sceneSeed;
+	}
+
+	/** Set the function that fills each new scene
+	* @param
+	*   builder The scene builder, empty for the default scene
+	*/
+	void SceneRenderer::setSceneBuilder(const SceneBuilder& builder)
+	{
+		_sceneBuilder = builder;
+	}
+
+	/** Get the tiling used by the last render, the split count is final once the workers finish
+	* @return
+	*   TilingStats The tiling statistics
+	*/
+	TilingStats SceneRenderer::getTilingStats() const
+	{
+		TilingStats stats;
+		stats.mode = _tilingMode;
+		stats.tileWidth = _cWidth;
+		stats.tileHeight = _cHeight;
+		if(_cWidth > 0 && _cHeight > 0)
 		{
-			bool dW = (width % 2 == 0);
-			bool dH = (height % 2 == 0);
-			if(dW == true && dH == true)
-			{
-				width >>= 1;
-				height >>= 1;
-				d <<= 1;
-			}
-			else if(dW == true)
-			{
-				width >>= 1;
-			}
-			else if(dH == true)
-			{
-				height >>= 1;
-			}
-			else
-			{
-				canDivide = false;
-			}
+			stats.tilesX = (_width + _cWidth - 1) / _cWidth;
+			stats.tilesY = (_height + _cHeight - 1) / _cHeight;
 		}
+		stats.numSplits = _numSplits.load();
+		return stats;
+	}
+
+	/** Set the number of trace workers
+	* @param
+	*   numWorkers The number of workers, 0 to use the hardware concurrency
+	*/
+	void SceneRenderer::setNumWorkers(unsigned int numWorkers)
+	{
+		_workerPool.setNumWorkers(numWorkers);
+	}
 
-		// We have pared down our values using binary method, so now we can find the GCD of this number
-		canDivide = true;
+	/** Get the number of trace workers
+	* @return
+	*   unsigned int The number of workers
+	*/
+	unsigned int SceneRenderer::getNumWorkers() const
+	{
+		return _workerPool.getNumWorkers();
+	}
+
+	/** Get the load balance statistics for a trace worker, valid once the workers have finished
+	* @param
+	*   worker The worker index
+	* @return
+	*   const WorkerStats& The worker statistics
+	*/
+	const WorkerStats& SceneRenderer::getWorkerStats(unsigned int worker) const
+	{
+		return _workerPool.getWorkerStats(worker);
+	}
+
+	/** Get the rays cast by all trace workers during the last render, valid once the workers
+	*	have finished
+	* @return
+	*   RayStats The ray counts
+	*/
+	RayStats SceneRenderer::getRayStats() const
+	{
+		RayStats stats;
+		for(unsigned int i = 0; i < _rayStats.size(); ++i)
+		{
+			stats += _rayStats[i];
+		}
+		return stats;
+	}
 
-		// Ensure width is the largest value
-		if(height > width)
+	/** Get the work done by all trace workers during the last render, valid once the workers
+	*	have finished. The counters read 0 unless built with ST_ENABLE_STATS, the tiles and
+	*	times are always filled in
+	* @return
+	*   RenderStats The work counts
+	*/
+	RenderStats SceneRenderer::getRenderStats() const
+	{
+		RenderStats stats;
+		for(unsigned int i = 0; i < _renderStats.size(); ++i)
 		{
-			unsigned int t = width;
-			width = height;
-			height = t;
+			stats += getWorkerRenderStats(i);
 		}
-		while(canDivide == true)
+		return stats;
+	}
+
+	/** Get the work done by one trace worker during the last render, valid once the workers
+	*	have finished
+	* @param
+	*   worker The index of the worker
+	* @return
+	*   RenderStats The work counts
+	*/
+	RenderStats SceneRenderer::getWorkerRenderStats(unsigned int worker) const
+	{
+		RenderStats stats = _renderStats[worker];
+		const WorkerStats& workerStats = _workerPool.getWorkerStats(worker);
+		stats.numTiles = workerStats.tilesExecuted;
+		stats.busySeconds = workerStats.busySeconds;
+		stats.idleSeconds = workerStats.idleSeconds;
+		return stats;
+	}
+
+	/** Get the cost of every tile traced in the last render, valid once the workers have
+	*	finished
+	* @param
+	*   records Receives a record per tile, grouped by worker
+	*/
+	void SceneRenderer::getTileRecords(std::vector<TileRecord>& records) const
+	{
+		records.clear();
+		for(unsigned int i = 0; i < _tileRecords.size(); ++i)
 		{
-			// Divide w by h
-			unsigned int quotient = width / height;
-			unsigned int remainder = width - (height * quotient);
+			records.insert(records.end(), _tileRecords[i].begin(), _tileRecords[i].end());
+		}
+	}
+
+	/** Get where the time of the last render went, valid once the workers have finished
+	* @return
+	*   FrameTimings The timings
+	*/
+	FrameTimings SceneRenderer::getFrameTimings() const
+	{
+		return _frameTimings;
+	}
 
-			// Set height to width and remainder to height (then repeat)
-			width = height;
-			height = remainder;
+	/** Get the heap allocations made during the last render, valid once the workers have
+	*	finished
+	* @return
+	*   RenderAllocationStats The allocation counts
+	*/
+	RenderAllocationStats SceneRenderer::getAllocationStats() const
+	{
+		RenderAllocationStats stats;
+		stats.setup = _setupAllocations;
+		stats.present = _presentAllocations;
+		for(unsigned int i = 0; i < _rayStats.size() && _traceScratch != 0; ++i)
+		{
+			stats.trace += _traceScratch[i].allocations;
+		}
+		return stats;
+	}
 
-			if(remainder == 0)
-			{
-				canDivide = false;
-			}
+	/** Wait for the trace workers and the render processor to finish the current render
+	*/
+	void SceneRenderer::waitForWorkers()
+	{
+		_workerPool.join();
+		if(_renderWorker.joinable() == true)
+		{
+			_renderWorker.join();
 		}
+	}
+
+	/** Get the frame buffer of the last render, complete once the frame future is ready
+	* @return
+	*   const float* RGB floats stored bottom up, 0 before the first render
+	*/
+	const float* SceneRenderer::getPixelData() const
+	{
+		return _pixelData;
+	}
 
-		// GCD is current width * d
-		_numChunks = width * d;
+	/** Get the scene of the last render
+	* @return
+	*   const Scene* The scene, 0 before the first render
+	*/
+	const Scene* SceneRenderer::getScene() const
+	{
+		return _scene;
 	}
 
 	/** Render the scene
@@ -114,69 +399,105 @@ namespace SuperTrace
 	*   width The viewport width
 	* @param
 	*   height The viewport height
+	* @return
+	*   std::shared_future<void> Becomes ready the moment the last chunk has been traced
 	*/
-	void SceneRenderer::render(unsigned int width, unsigned int height)
+	std::shared_future<void> SceneRenderer::render(unsigned int width, unsigned int height)
 	{
-		_scene = new Scene();
-		_scene->createScene();
+		// Finish any render still in flight before its state is replaced
+		waitForWorkers();
+		_renderStart = Clock::now();
+		_frameTimings = FrameTimings();
+		_firstTileDone.store(false);
+		AllocationCount setupStart = GetThreadAllocations();
+
+		// Rebuild into the last frame's scene, its arena and containers are already sized for it
+		if(_scene == 0)
+		{
+			_scene = new Scene();
+		}
+		_scene->reset();
+		{
+			TimelineSpan loadSpan("Load scene");
+			if(_sceneBuilder)
+			{
+				_sceneBuilder(*_scene, _sceneSeed);
+				_scene->buildAccelerationStructure();
+			}
+			else
+			{
+				_scene->createScene(_sceneSeed);
+			}
+		}
 
 		// Setup the camera
 		float fovy = tan(60.0f * 0.5f * M_PI / 180.0f);
-		Camera* camera = new Camera(width, height, fovy);
+		Camera* camera = _scene->getArena().create<Camera>(width, height, fovy);
 		_scene->setCamera(camera);
 
+		// Keep the pixel buffer while the viewport size is unchanged
+		if(_pixelData == 0 || width != _width || height != _height)
+		{
+			delete[] _pixelData;
+			_pixelData = new float[width * height * 3];
+		}
+
 		// First, calculate the chunk dimensions
+		_width = width;
+		_height = height;
 		getChunkDimensions(width, height);
 
+		// Tiles never grow past the chunk size, splits only divide them by rows
+		unsigned int numWorkers = _workerPool.getNumWorkers();
+		_frameArena.reset();
+		_traceScratch = _frameArena.allocateArray<TraceScratch>(numWorkers, CacheLineSize);
+		for(unsigned int i = 0; i < numWorkers; ++i)
+		{
+			_traceScratch[i].origins = _frameArena.allocateArray<Vector3>(_cWidth, CacheLineSize);
+			_traceScratch[i].directions = _frameArena.allocateArray<Vector3>(_cWidth, CacheLineSize);
+			_traceScratch[i].tile = _tileBuffers == true ? _frameArena.allocateArray<float>(_cWidth * _cHeight * 3, CacheLineSize) : 0;
+			_traceScratch[i].allocations = AllocationCount();
+		}
+
 		// Initialize the pixel buffer data
-		_pixelData = new float[width * height * 3];
 		for(unsigned int i = 0; i < width * height * 3; ++i)
 		{
 			_pixelData[i] = 0.0f;
 		}
 
-		// Create the mutex
-		InitializeCriticalSectionAndSpinCount(&_renderMutex, 0x00000400);
-		InitializeCriticalSectionAndSpinCount(&_jobMutex, 0x00000400);
-		InitializeCriticalSectionAndSpinCount(&cs, 0x00000400);
-
-		// Initialize the number of threads
-		_numWorkers = 100;
-		_workers = new HANDLE[_numWorkers];
-		_numJobs = _numChunks * _numChunks;
-		DWORD threadId;
+		// Arm the completion signal before any chunk can finish
+		_numSplits.store(0);
+		_rayStats.assign(numWorkers, RayStats());
+		_renderStats.assign(numWorkers, RenderStats());
+		updateTileCosts();
+		_presentAllocations = AllocationCount();
+		_framePromise = std::promise<void>();
+		std::shared_future<void> frameComplete = _framePromise.get_future().share();
+
+		// Let the presenter prepare for the frame before any chunk can complete
+		if(_presenter != 0)
+		{
+			_presenter->begin(width, height, _pixelData);
+		}
 
-		// Unset the rendering context before doing any work
-		wglMakeCurrent(NULL, NULL);
+		// Second, size the queues and hand each section to the trace workers
+		submitChunks();
 
-		// Start the workers
-		for(unsigned int i = 0; i < _numWorkers; ++i)
+		// Create thread for the presenter
+		if(_presenter != 0)
 		{
-			_workers[i] = CreateThread(	NULL,
-										0,
-										(LPTHREAD_START_ROUTINE) TraceWorker,
-										(LPVOID) this,
-										0,
-										&threadId);
+			_renderWorker = std::thread(&SceneRenderer::presentFrame, this);
 		}
 
-		// Create thread for render processor
-		CreateThread(	NULL,
-						0,
-						(LPTHREAD_START_ROUTINE) RenderWorker,
-						(LPVOID) this,
-						0,
-						&threadId);
-						
-		// Second, iterate over each section and render
-		for(unsigned int i = 0; i < _numChunks; ++i)
+		// Start the workers, they steal from each other until every chunk has been traced
+		_frameTimings.setupSeconds = std::chrono::duration_cast<std::chrono::duration<double> >(Clock::now() - _renderStart).count();
+		_workerPool.start([this](const ChunkData& chunk, unsigned int worker)
 		{
-			for(unsigned int j = 0; j < _numChunks; ++j)
-			{
-				// Ask enqueue object
-				addTraceableChunk(new ChunkData(i, j));
-			}
-		}
+			traceChunk(chunk, worker);
+		});
+
+		_setupAllocations = GetThreadAllocations() - setupStart;
+		return frameComplete;
 	}
 
 	/** Calculate the chunk dimensions
@@ -187,256 +508,410 @@ namespace SuperTrace
 	*/
 	void SceneRenderer::getChunkDimensions(unsigned int tWidth, unsigned int tHeight)
 	{
-		// Naively divide tWidth by numChunks
-		_cWidth = tWidth / _numChunks;
-		_cHeight = tHeight / _numChunks;
-	}
+		if(_tilingMode == TILING_FIXED_SIZE)
+		{
+			// The tile size was given explicitly
+			return;
+		}
 
-	/** Render a chunk
-	* @param
-	*   startX The starting x index
-	* @param
-	*   startY The starting y index
-	*/
-	void SceneRenderer::traceChunk(unsigned int startX, unsigned int startY)
-	{
-		//float* pixels = new float[_cWidth*_cHeight*3];
-		unsigned int width = _cWidth * _numChunks;
-		unsigned int height = _cHeight * _numChunks;
+		if(_tilingMode == TILING_CHUNK_COUNT)
+		{
+			// Round up so the last chunk along each axis covers the remainder instead of dropping it
+			unsigned int numChunks = std::max(_numChunks, 1u);
+			_cWidth = std::max((tWidth + numChunks - 1) / numChunks, 1u);
+			_cHeight = std::max((tHeight + numChunks - 1) / numChunks, 1u);
+			return;
+		}
+
+		// Pick the largest square tile that fits the cache budget and still gives every worker
+		// enough tiles to balance the load, falling back to the smallest tile that fits
+		const unsigned int bytesPerPixel = 3 * sizeof(float);
+		unsigned int targetTiles = _workerPool.getNumWorkers() * _targetTilesPerWorker;
+		unsigned int numSizes = sizeof(AdaptiveTileSizes) / sizeof(AdaptiveTileSizes[0]);
 
-		bool test = false;
-		
-		for(unsigned int i = 0; i < _cHeight; ++i)
+		_cWidth = _cHeight = AdaptiveTileSizes[numSizes - 1];
+		for(unsigned int i = 0; i < numSizes; ++i)
 		{
-			// Calculate base array position
-			unsigned int base = ((width * _cHeight) * startY) + (width * i);
-			// Inverse the base
-			base = (width * height) - base - width;
-	
-			// Calculate rasterized y value
-			unsigned int y = _cHeight * startY + i;
+			unsigned int size = AdaptiveTileSizes[i];
+			if(size * size * bytesPerPixel > _tileCacheBudget)
+			{
+				continue;
+			}
 
-			for(unsigned int j = 0; j < _cWidth; ++j)
+			_cWidth = _cHeight = size;
+			unsigned int tiles = ((tWidth + size - 1) / size) * ((tHeight + size - 1) / size);
+			if(tiles >= targetTiles)
 			{
-				int pos = ((i * _cWidth) + j) * 3;
+				break;
+			}
+		}
+	}
 
-				// Get the raster position
-				unsigned int x = _cWidth * startX + j;
-				
-				// Get a color from the scene
-				Color color = _scene->trace(x, y);
+	/** Total up the tile costs of the last render per grid cell, when it used the same grid as
+	*   the render being set up, and clear the records for the new render
+	*/
+	void SceneRenderer::updateTileCosts()
+	{
+		unsigned int tilesX = (_width + _cWidth - 1) / _cWidth;
+		unsigned int tilesY = (_height + _cHeight - 1) / _cHeight;
+		bool sameGrid = _width == _recordedWidth && _height == _recordedHeight && _cWidth == _recordedTileWidth && _cHeight == _recordedTileHeight;
 
-/*				if(color.r == float(float(x)/1024.0f) || color.g == float(float(y)/768.0f))
+		// A split tile left a record for each piece, every piece starts inside its tile's cell
+		_tileCosts.clear();
+		if(sameGrid == true && _tileRecords.empty() == false)
+		{
+			_tileCosts.assign(tilesX * tilesY, 0.0);
+			for(unsigned int i = 0; i < _tileRecords.size(); ++i)
+			{
+				for(unsigned int j = 0; j < _tileRecords[i].size(); ++j)
 				{
-					if(startX > 8 && startX < 24 && startY > 8 && startY < 24)
-					{
-						int a =0;
-						_scene->trace(x, y);
-					}
-					test = true;
-				}*/
-
-				// Calculate offset from width
-				unsigned int offset = (startX * _cWidth) + j;
-				unsigned int p = (base + offset) * 3;
-				_pixelData[p] = color.r;
-				_pixelData[p + 1] = color.g;
-				_pixelData[p + 2] = color.b;
+					const TileRecord& record = _tileRecords[i][j];
+					_tileCosts[(record.startY / _cHeight) * tilesX + record.startX / _cWidth] += record.seconds;
+				}
 			}
 		}
 
-		if(test == true && startX > 8 && startX < 24 && startY > 8 && startY < 24)
+		_recordedWidth = _width;
+		_recordedHeight = _height;
+		_recordedTileWidth = _cWidth;
+		_recordedTileHeight = _cHeight;
+
+		// Any worker may trace every tile, including the pieces splitting adds
+		unsigned int numWorkers = _workerPool.getNumWorkers();
+		_tileRecords.resize(numWorkers);
+		for(unsigned int i = 0; i < numWorkers; ++i)
 		{
-			int a = 0;
+			_tileRecords[i].clear();
+			_tileRecords[i].reserve(tilesX * tilesY + numWorkers * SplitQueueSlack);
 		}
-
-		// Construct x and y position
-/*		float initX = static_cast<float>(_cWidth * startX);
-		float totalX = static_cast<float>(_cWidth * _numChunks) * 0.5f;
-		float xpos = (initX / totalX) - 1.0f;
-
-		float initY = static_cast<float>(_cHeight * startY);
-		float totalY = static_cast<float>(_cHeight * _numChunks) * 0.5f;
-		float ypos = (initY / totalY) - 1.0f;
-		*/
-		// Add to the list of completed blocks
-		addRenderData(startX, startY, 0);
 	}
 
-	// Add render data
-	void SceneRenderer::addRenderData(unsigned int startX, unsigned int startY, float* renderData)
+	/** Submit every chunk of the image to the trace workers
+	*/
+	void SceneRenderer::submitChunks()
 	{
-		// First, acquire the job mutex
-		EnterCriticalSection(&_renderMutex);
-
-		// Create pointer to render data
-		RenderData* rd = new RenderData();
-		rd->_startX = startX;
-		rd->_startY = startY;
-		rd->_pixelData = renderData;
-			
-		// Enqueue and release
-		_renderQueue.push(rd);
+		unsigned int tilesX = (_width + _cWidth - 1) / _cWidth;
+		unsigned int numTiles = tilesX * ((_height + _cHeight - 1) / _cHeight);
 
-		// Release the mutex
-		LeaveCriticalSection(&_renderMutex);
-	} 
+		// Both rings are bounded, size them for the grid plus the tiles splitting may add
+		_workerPool.reserve(numTiles, SplitQueueSlack);
+		_renderQueue.reset(numTiles + _workerPool.getNumWorkers() * SplitQueueSlack);
 
-	// Try to get a piece of render data
-	RenderData* SceneRenderer::getRenderData()
-	{
-		// The data to return
-		RenderData* data = 0;
+		// Raster order, or the most expensive tiles of the last render first; tiles are dealt to
+		// the workers round robin, so each worker also starts on its most expensive tiles
+		_tileOrder.resize(numTiles);
+		for(unsigned int i = 0; i < numTiles; ++i)
+		{
+			_tileOrder[i] = i;
+		}
+		if(_tileCostOrdering == true && _tileCosts.size() == numTiles)
+		{
+			const std::vector<double>& costs = _tileCosts;
+			// Ties keep raster order, as a stable sort would without its temporary buffer
+			std::sort(_tileOrder.begin(), _tileOrder.end(), [&costs](unsigned int a, unsigned int b)
+			{
+				return costs[a] > costs[b] || (costs[a] == costs[b] && a < b);
+			});
+		}
 
-		// There is a valid queue entry at lock attempt time
-		EnterCriticalSection(&_renderMutex);
-		
-		// Now that we have acquired the lock, make sure we still have a valid queue entry
-		if(_renderQueue.size() > 0)
+		// Tiles along the right and bottom edges are clipped to the image, so any resolution is
+		// covered exactly whatever the tile size
+		for(unsigned int i = 0; i < numTiles; ++i)
 		{
-			data = _renderQueue.front();
-			_renderQueue.pop();
+			unsigned int x = (_tileOrder[i] % tilesX) * _cWidth;
+			unsigned int y = (_tileOrder[i] / tilesX) * _cHeight;
+			unsigned int w = std::min(_cWidth, _width - x);
+			unsigned int h = std::min(_cHeight, _height - y);
+			_workerPool.submit(ChunkData(x, y, w, h));
 		}
 
-		// Release the mutex
-		LeaveCriticalSection(&_renderMutex);
+		_remainingTiles.store(numTiles);
 
-		return data;
+		// An empty image is complete before it starts
+		if(numTiles == 0)
+		{
+			_framePromise.set_value();
+		}
 	}
 
-	// Enqueue a chunk
-	void SceneRenderer::addTraceableChunk(ChunkData* chunk)
+	/** Render a chunk, splitting it if it turns out to be expensive
+	* @param
+	*   chunk The chunk to trace
+	* @param
+	*   worker The index of the worker tracing the chunk
+	*/
+	void SceneRenderer::traceChunk(const ChunkData& chunk, unsigned int worker)
 	{
-		// First, acquire the job mutex
-		EnterCriticalSection(&_jobMutex);
+		Clock::time_point start = Clock::now();
+		TimelineSpan traceSpan;
+		TraceScratch& scratch = _traceScratch[worker];
+		AllocationCount allocationStart = GetThreadAllocations();
+		unsigned int rows = chunk._height;
+		RayStats rayStats;
+#ifdef ST_ENABLE_STATS
+		RenderStats renderStatsStart = GetThreadRenderStats();
+#endif
+
+		// Camera rays are generated a row at a time
+		const Camera* camera = _scene->getCamera();
+		Vector3* origins = scratch.origins;
+		Vector3* directions = scratch.directions;
+		RayPacket packet;
+		Color colors[PacketWidth];
+
+		for(unsigned int i = 0; i < rows; ++i)
+		{
+			// Calculate rasterized y value
+			unsigned int y = chunk._startY + i;
 
-		// Enqueue and release
-		_chunkQueue.push(chunk);
+			// Pixels go to the worker's tile buffer, or straight to the frame buffer which is stored
+			// bottom up
+			float* row = scratch.tile != 0 ? scratch.tile + i * chunk._width * 3 : _pixelData + ((_height - 1 - y) * _width + chunk._startX) * 3;
 
-		// Release the mutex
-		LeaveCriticalSection(&_jobMutex);
-	}
+			if(_packetTracing == true)
+			{
+				// Neighbouring pixels along the row form a packet, the last may be partly filled
+				for(unsigned int j = 0; j < chunk._width; j += PacketWidth)
+				{
+					unsigned int count = std::min(PacketWidth, chunk._width - j);
+					camera->generatePacket(chunk._startX + j, y, count, packet);
+					_scene->tracePacket(packet, colors, rayStats);
 
-	// Dequeue a chunk
-	ChunkData* SceneRenderer::getTraceableChunk()
-	{
+					for(unsigned int lane = 0; lane < count; ++lane)
+					{
+						unsigned int p = (j + lane) * 3;
+						row[p] = colors[lane].r;
+						row[p + 1] = colors[lane].g;
+						row[p + 2] = colors[lane].b;
+					}
+				}
+			}
+			else
+			{
+				camera->generateRays(chunk._startX, y, chunk._width, 1, origins, directions);
+				for(unsigned int j = 0; j < chunk._width; ++j)
+				{
+					// Get a color from the scene
+					Color color = _scene->trace(Ray(origins[j], directions[j], RAY_TYPE_CAMERA), rayStats);
+
+					unsigned int p = j * 3;
+					row[p] = color.r;
+					row[p + 1] = color.g;
+					row[p + 2] = color.b;
+				}
+			}
 
-		// The data to return
-		ChunkData* data = 0;
+			// If the rows left are projected to take too long, hand the bottom half of them back to
+			// the pool so an idle worker can steal it. The other tilings keep their decomposition
+			unsigned int rowsDone = i + 1;
+			unsigned int rowsLeft = rows - rowsDone;
+			if(_tilingMode == TILING_ADAPTIVE && _tileSplitTime > 0.0 && rowsLeft >= 2 * MinSplitRows && _workerPool.getNumWorkers() > 1)
+			{
+				double elapsed = std::chrono::duration_cast<std::chrono::duration<double> >(Clock::now() - start).count();
+				if(elapsed / rowsDone * rowsLeft > _tileSplitTime)
+				{
+					unsigned int keep = rowsLeft / 2;
 
-		EnterCriticalSection(&_jobMutex);
+					// Count the new chunk before it can be stolen and completed, a full queue keeps
+					// the rows here
+					_remainingTiles.fetch_add(1);
+					if(_workerPool.push(worker, ChunkData(chunk._startX, y + 1 + keep, chunk._width, rowsLeft - keep)) == true)
+					{
+						++_numSplits;
+						rows = rowsDone + keep;
+					}
+					else
+					{
+						_remainingTiles.fetch_sub(1);
+					}
+				}
+			}
+		}
 
-		// Now that we have acquired the lock, make sure we still have a valid queue entry
-		if(_chunkQueue.size() > 0)
+		_rayStats[worker] += rayStats;
+#ifdef ST_ENABLE_STATS
+		_renderStats[worker] += GetThreadRenderStats() - renderStatsStart;
+#endif
+		traceSpan.end("Trace", chunk._startX, chunk._startY, chunk._width, rows);
+
+		// The rows must be in the frame buffer before the chunk is presented or counted
+		if(scratch.tile != 0)
 		{
-			data = _chunkQueue.front();
-			_chunkQueue.pop();
+			commitTile(ChunkData(chunk._startX, chunk._startY, chunk._width, rows), scratch.tile);
 		}
 
-		// Release the mutex
-		LeaveCriticalSection(&_jobMutex);
+		// Reserved before the render, so recording never allocates
+		double seconds = std::chrono::duration_cast<std::chrono::duration<double> >(Clock::now() - start).count();
+		_tileRecords[worker].push_back(TileRecord(chunk._startX, chunk._startY, chunk._width, rows, worker, seconds,
+			rayStats.numCameraRays + rayStats.numShadowRays));
 
-		return data;
-	}
+		if(_firstTileDone.exchange(true) == false)
+		{
+			_frameTimings.firstTileSeconds = std::chrono::duration_cast<std::chrono::duration<double> >(Clock::now() - _renderStart).count();
+		}
 
-	void SceneRenderer::setContext(HDC hDC, HGLRC hRC)
-	{
-		_hDC = hDC;
-		_hRC = hRC;
-	}
+		// Add to the list of completed blocks
+		if(_presenter != 0)
+		{
+			addRenderData(ChunkData(chunk._startX, chunk._startY, chunk._width, rows), 0);
+		}
 
-	// Decrement the number of jobs left to handle
-	void SceneRenderer::decrementJobCount()
-	{
-		--_numJobs;
+		// Tally the chunk, the last one completes the frame
+		completeTile();
+
+		scratch.allocations += GetThreadAllocations() - allocationStart;
 	}
 
-	/** Get isSceneComplete
+	/** Copy a traced tile from a worker's tile buffer to the frame buffer
+	* @param
+	*   chunk The rows of the tile that were traced
+	* @param
+	*   tile The pixels, rows packed at the tile's width
 	*/
-	bool SceneRenderer::getIsSceneComplete()
+	void SceneRenderer::commitTile(const ChunkData& chunk, const float* tile)
 	{
-		return _numJobs == 0;
-	}
+		TimelineSpan commitSpan("Commit", chunk._startX, chunk._startY, chunk._width, chunk._height);
 
-	// Acquire the render context
-	void SceneRenderer::acquireContext()
-	{
-		// Create a context for this thread
-		BOOL success = wglMakeCurrent(_hDC, _hRC);
+		// Each row of the tile is contiguous in the frame buffer, which is stored bottom up
+		size_t rowBytes = chunk._width * 3 * sizeof(float);
+		for(unsigned int i = 0; i < chunk._height; ++i)
+		{
+			unsigned int y = chunk._startY + i;
+			memcpy(_pixelData + ((_height - 1 - y) * _width + chunk._startX) * 3, tile + i * chunk._width * 3, rowBytes);
+		}
 	}
 
-	// Draw a scene
-	void SceneRenderer::drawToScreen(RenderData* data)
+	// Count a traced chunk and signal the frame once none remain
+	void SceneRenderer::completeTile()
 	{
-		// Tally the number of jobs we have left to handle
-		decrementJobCount();
+		if(_remainingTiles.fetch_sub(1) == 1)
+		{
+			_frameTimings.frameSeconds = std::chrono::duration_cast<std::chrono::duration<double> >(Clock::now() - _renderStart).count();
+			_framePromise.set_value();
 
-		glRasterPos2f(-1.0f, -1.0f);
-		glDrawPixels(_cWidth * _numChunks, _cHeight * _numChunks, GL_RGB, GL_FLOAT, _pixelData);
-		glFinish();
+			// Cycle the mutex so a render processor between its check and its wait cannot miss the wakeup
+			{
+				std::lock_guard<std::mutex> lock(_renderMutex);
+			}
+			_renderCondition.notify_all();
+		}
 	}
 
-	DWORD WINAPI TraceWorker(LPVOID lpParam)
+	// Add render data
+	void SceneRenderer::addRenderData(const ChunkData& chunk, float* renderData)
 	{
-		// Get the scene
-		SceneRenderer* sceneRenderer = static_cast<SceneRenderer*>(lpParam);
-		
-		// While the scene is not complete
-		while(sceneRenderer->getIsSceneComplete() == false)
+		RenderData rd;
+		rd._startX = chunk._startX;
+		rd._startY = chunk._startY;
+		rd._width = chunk._width;
+		rd._height = chunk._height;
+		rd._pixelData = renderData;
+
+		// The ring is sized for every chunk of the frame, if the render processor has fallen that far
+		// behind it is draining and a slot frees up shortly
+		while(_renderQueue.tryPush(rd) == false)
 		{
-			//EnterCriticalSection(&cs);
-
-			// Get a chunk from the queue
-			ChunkData* data = sceneRenderer->getTraceableChunk();
+			std::this_thread::yield();
+		}
 
-			// If the chunk is valid, render otherwise skip
-			if(data != 0)
+		// Only pay for the mutex when the render processor is asleep, the fence pairs with the one in
+		// getRenderData so either we see the flag or it sees the new entry
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(_presenterWaiting.load(std::memory_order_relaxed) == true)
+		{
 			{
-				sceneRenderer->traceChunk(data->_startX, data->_startY);
+				std::lock_guard<std::mutex> lock(_renderMutex);
+			}
+			_renderCondition.notify_one();
+		}
+	}
 
-				// Delete the data
-				delete data;
-				data = 0;
+	// Wait for a piece of render data, returns false once the scene is complete and the queue is drained
+	bool SceneRenderer::getRenderData(RenderData& data)
+	{
+		while(true)
+		{
+			if(_renderQueue.tryPop(data) == true)
+			{
+				return true;
 			}
-			else
+
+			// Completed chunks are drained before the scene is reported as done, every chunk is pushed
+			// before its tile is counted so one more pop catches the last of them
+			if(getIsSceneComplete() == true)
 			{
-				Sleep(1000);
+				return _renderQueue.tryPop(data);
 			}
 
-			//LeaveCriticalSection(&cs);
+			std::unique_lock<std::mutex> lock(_renderMutex);
+			_presenterWaiting.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			_renderCondition.wait(lock, [this]
+			{
+				return _renderQueue.isEmpty() == false || getIsSceneComplete() == true;
+			});
+			_presenterWaiting.store(false, std::memory_order_relaxed);
 		}
+	}
 
-		return 0;
+	/** Set the presenter that shows chunks as they complete, it must outlive any render using it
+	* @param
+	*   presenter The presenter, 0 to trace without presenting
+	*/
+	void SceneRenderer::setPresenter(Presenter* presenter)
+	{
+		waitForWorkers();
+		_presenter = presenter;
 	}
 
-	DWORD WINAPI RenderWorker(LPVOID lpParam)
+	/** Get isSceneComplete
+	*/
+	bool SceneRenderer::getIsSceneComplete()
 	{
-		// Get context
-		SceneRenderer* sceneRenderer = static_cast<SceneRenderer*>(lpParam);
+		return _remainingTiles.load() == 0;
+	}
 
-		// Acquire gl context for this thread
-		sceneRenderer->acquireContext();
-		
-		// While the scene is not complete
-		while(sceneRenderer->getIsSceneComplete() == false)
+	// Present completed chunks as dirty rectangles at the presenter's refresh rate until the scene is complete
+	void SceneRenderer::presentFrame()
+	{
+		AllocationCount allocationStart = GetThreadAllocations();
+		BindTimelineThread(TIMELINE_THREAD_PRESENTER, "Presenter");
+		_presenter->attach();
+
+		Clock::duration interval = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(_presenter->getPresentInterval()));
+		Clock::time_point lastPresent = Clock::now() - interval;
+
+		// Sleep until chunks arrive, exit once the scene is complete and everything has been drawn
+		RenderData data;
+		while(getRenderData(data) == true)
 		{
-			// Get a chunk from the queue
-			RenderData* data = sceneRenderer->getRenderData();
+			_presenter->addDirtyRect(data);
 
-			// If the chunk is valid, render otherwise skip
-			if(data != 0)
+			// Let chunks pile up until the next refresh is due, the last chunk cuts the wait short
+			if(getIsSceneComplete() == false)
 			{
-				sceneRenderer->drawToScreen(data);
-				delete data;
-				data = 0;
+				std::unique_lock<std::mutex> lock(_renderMutex);
+				_renderCondition.wait_until(lock, lastPresent + interval, [this]
+				{
+					return getIsSceneComplete() == true;
+				});
 			}
-			else
+
+			while(_renderQueue.tryPop(data) == true)
+			{
+				_presenter->addDirtyRect(data);
+			}
+
 			{
-				Sleep(1000);
+				TimelineSpan presentSpan("Present");
+				_presenter->present();
 			}
+			lastPresent = Clock::now();
 		}
 
-		return 0;
+		_presenter->detach();
+		_presentAllocations = GetThreadAllocations() - allocationStart;
 	}
 
 }   // Namespace
@@ -4,8 +4,13 @@
 // Description: Defines a sphere.
 //*************************************************************************************************
 #include "Sphere.h"
+#include "HitRecord.h"
 #include "Ray.h"
+#include "RayPacket.h"
+#include "RenderStats.h"
 #include "STMath.h"
+#include <math.h>
+#include <algorithm>
 
 namespace SuperTrace
 {
@@ -13,7 +18,15 @@ namespace SuperTrace
 		:	Object(world), _center(center), _radius(radius)
 	{ }
 
-	bool Sphere::intersect(const Ray& ray) const
+	/** Test for an intersection between a ray and this sphere
+	* @param
+	*	ray The ray to test against intersection
+	* @param
+	*	hit The closest hit so far, overwritten if the sphere is hit nearer than hit.t
+	* @return
+	*	bool True if intersection is found, false otherwise
+	*/
+	bool Sphere::intersect(const Ray& ray, HitRecord& hit) const
 	{
 		//float t0, t1;
 
@@ -56,23 +69,147 @@ namespace SuperTrace
 		float c = L.dot(L) - (_radius * _radius);
 		
 		// Attempt to solve the quadratic
+		ST_STATS_ADD(numPrimitiveTests, 1);
 		if(SolveQuadratic(a, b, c, t0, t1) == false)
 		{
 			return false;
 		}
 
-		// If t0 is greater than the max extent of the ray, no intersect
-		if(t0 > ray.getTMax())
+		// Roots behind the start of the ray do not count, otherwise a sphere behind the camera would
+		// win the closest hit depending on the order objects are visited in
+		if(t0 < ray.getTMin())
 		{
-			return false;
+			t0 = t1;
+			if(t0 < ray.getTMin())
+			{
+				return false;
+			}
 		}
-		else
+
+		// If t0 is beyond the closest hit so far, no intersect
+		if(t0 >= hit.t)
 		{
-			ray.setTMax(t0);
+			return false;
 		}
+
+		setHit(ray(t0), t0, hit);
+		ST_STATS_ADD(numPrimitiveHits, 1);
 		return true;
 	}
 
+	/** Test the active lanes of a ray packet for intersection
+	* @param
+	*	packet The rays to test
+	* @param
+	*	mask The lanes to test, a bit per lane
+	* @param
+	*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+	* @return
+	*	unsigned int The lanes whose hit was overwritten
+	*/
+	unsigned int Sphere::intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const
+	{
+		ST_STATS_ADD(numPrimitiveTests, CountLanes(mask));
+		PacketFloat dx = PacketLoad(packet.directionX);
+		PacketFloat dy = PacketLoad(packet.directionY);
+		PacketFloat dz = PacketLoad(packet.directionZ);
+		PacketFloat lx = PacketLoad(packet.originX) - PacketSplat(_center.getX());
+		PacketFloat ly = PacketLoad(packet.originY) - PacketSplat(_center.getY());
+		PacketFloat lz = PacketLoad(packet.originZ) - PacketSplat(_center.getZ());
+
+		// The same quadratic as the single ray test, evaluated in the same order so both agree
+		PacketFloat a = dx * dx + dy * dy + dz * dz;
+		PacketFloat b = PacketSplat(2.0f) * (dx * lx + dy * ly + dz * lz);
+		PacketFloat c = (lx * lx + ly * ly + lz * lz) - PacketSplat(_radius * _radius);
+		PacketFloat disc = b * b - PacketSplat(4.0f) * a * c;
+		PacketFloat zero = PacketSplat(0.0f);
+		PacketFloat valid = PacketLessEqual(zero, disc);
+
+		// q takes the sign of b so the roots never come from cancellation
+		PacketFloat root = PacketSqrt(PacketMax(disc, zero));
+		PacketFloat q = PacketSplat(-0.5f) * PacketSelect(PacketLess(zero, b), b + root, b - root);
+		PacketFloat x0 = q / a;
+		PacketFloat x1 = PacketSelect(PacketLess(zero, disc), c / q, x0);
+		PacketFloat t0 = PacketMin(x0, x1);
+		PacketFloat t1 = PacketMax(x0, x1);
+
+		// Roots behind the start of the ray do not count, the far root is used from inside
+		PacketFloat tMin = PacketLoad(packet.tMin);
+		PacketFloat t = PacketSelect(PacketLess(t0, tMin), t1, t0);
+		valid = PacketAnd(valid, PacketLessEqual(tMin, t));
+		valid = PacketAnd(valid, PacketLess(t, PacketLoad(hits.t)));
+
+		mask &= PacketMoveMask(valid);
+		if(mask == 0)
+		{
+			return 0;
+		}
+
+		float tLanes[PacketWidth];
+		PacketStore(tLanes, t);
+		for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+		{
+			if((mask & (1u << lane)) == 0)
+			{
+				continue;
+			}
+
+			// Only the lanes that hit pay for the normal and parameterization
+			Vector3 origin(packet.originX[lane], packet.originY[lane], packet.originZ[lane]);
+			Vector3 direction(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]);
+			HitRecord hit;
+			setHit(origin + (direction * tLanes[lane]), tLanes[lane], hit);
+			hits.setHit(lane, hit);
+		}
+		ST_STATS_ADD(numPrimitiveHits, CountLanes(mask));
+		return mask;
+	}
+
+	/** Any hit test, skips the normal and surface parameterization
+	* @param
+	*	ray The ray to test, only hits within [tMin, tMax] count
+	* @return
+	*	bool True if the sphere blocks the ray
+	*/
+	bool Sphere::occludes(const Ray& ray) const
+	{
+		float t0, t1;
+		Vector3 L = ray.getOrigin() - _center;
+		float a = ray.getDirection().dot(ray.getDirection());
+		float b = 2.0f * ray.getDirection().dot(L);
+		float c = L.dot(L) - (_radius * _radius);
+		ST_STATS_ADD(numPrimitiveTests, 1);
+		if(SolveQuadratic(a, b, c, t0, t1) == false)
+		{
+			return false;
+		}
+
+		// Either root inside the ray's extent blocks it
+		bool blocked = (t0 >= ray.getTMin() && t0 <= ray.getTMax()) || (t1 >= ray.getTMin() && t1 <= ray.getTMax());
+		ST_STATS_ADD(numPrimitiveHits, blocked == true ? 1 : 0);
+		return blocked;
+	}
+
+	/** Fill in a hit record for a point on the surface
+	* @param
+	*	contact The point on the surface
+	* @param
+	*	t The distance along the ray to the point
+	* @param
+	*	hit Receives the hit
+	*/
+	void Sphere::setHit(const Vector3& contact, float t, HitRecord& hit) const
+	{
+		hit.t = t;
+		hit.object = this;
+		hit.material = &_material;
+		hit.normal = (contact - _center) * (1.0f / _radius);
+
+		// Longitude and latitude of the contact point
+		hit.u = 0.5f + atan2f(hit.normal.getZ(), hit.normal.getX()) * (0.5f / M_PI);
+		hit.v = acosf(std::min(std::max(hit.normal.getY(), -1.0f), 1.0f)) * (1.0f / M_PI);
+	}
+
 	/** Calculate the surface normal for a given contact point
 	* @param
 	*	surfacePoint The surface point at which to construct a normal
@@ -86,4 +223,14 @@ namespace SuperTrace
 		return normal;
 	}
 
+	/** Get the world space bounds of the sphere
+	* @return
+	*	AABB A box containing the whole sphere
+	*/
+	AABB Sphere::getBounds() const
+	{
+		Vector3 extent(_radius, _radius, _radius);
+		return AABB(_center - extent, _center + extent);
+	}
+
 }	// Namespace
\ No newline at end of file
@@ -0,0 +1,507 @@
+//*************************************************************************************************
+// Title: SphereSet.cpp
+// Description: Many spheres held by a single object, for particle data. Centers and radii are
+//	stored one array per component in the order of the set's own BVH, so each leaf is a contiguous
+//	run that is tested a packet of spheres at a time.
+//*************************************************************************************************
+#include "SphereSet.h"
+#include "HitRecord.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "RenderStats.h"
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Solve for where rays meet spheres across every lane at once, without branches
+		* @param
+		*	lx, ly, lz The ray origin minus the sphere center
+		* @param
+		*	dx, dy, dz The ray direction
+		* @param
+		*	a The squared length of the ray direction
+		* @param
+		*	radius The sphere radius
+		* @param
+		*	tMin The start of the ray
+		* @param
+		*	valid Receives the lanes with a root at or after tMin
+		* @return
+		*	PacketFloat The nearest root at or after tMin in each valid lane
+		*/
+		inline PacketFloat SolveSpheres(PacketFloat lx, PacketFloat ly, PacketFloat lz, PacketFloat dx, PacketFloat dy, PacketFloat dz,
+			PacketFloat a, PacketFloat radius, PacketFloat tMin, PacketFloat& valid)
+		{
+			PacketFloat zero = PacketSplat(0.0f);
+			PacketFloat b = dx * lx + dy * ly + dz * lz;
+			PacketFloat c = (lx * lx + ly * ly + lz * lz) - radius * radius;
+
+			// The discriminant from the distance between the center and the ray's closest approach
+			// rather than b * b - a * c, which loses every digit for small spheres far from the ray
+			// origin
+			PacketFloat s = b / a;
+			PacketFloat fx = lx - dx * s;
+			PacketFloat fy = ly - dy * s;
+			PacketFloat fz = lz - dz * s;
+			PacketFloat disc = a * (radius * radius - (fx * fx + fy * fy + fz * fz));
+			valid = PacketLessEqual(zero, disc);
+
+			// q takes the sign of b so neither root comes from cancellation
+			PacketFloat root = PacketSqrt(PacketMax(disc, zero));
+			PacketFloat q = PacketSelect(PacketLess(zero, b), zero - b - root, root - b);
+			PacketFloat x0 = q / a;
+			PacketFloat x1 = PacketSelect(PacketLess(zero, disc), c / q, x0);
+			PacketFloat t0 = PacketMin(x0, x1);
+			PacketFloat t1 = PacketMax(x0, x1);
+
+			// The far root counts from inside a sphere
+			PacketFloat t = PacketSelect(PacketLess(t0, tMin), t1, t0);
+			valid = PacketAnd(valid, PacketLessEqual(tMin, t));
+			return t;
+		}
+	}
+
+	/** Constructor
+	* @param
+	*	world The world matrix
+	*/
+	SphereSet::SphereSet(const Matrix44& world)
+		:	Object(world), _numSpheres(0)
+	{
+		// A leaf is tested a packet of spheres at once, so a full leaf costs about one test
+		_bvh.setMaxLeafSize(PacketWidth);
+		_bvh.setIntersectionCost(1.0f / PacketWidth);
+	}
+
+	/** Reserve room for spheres before adding them
+	* @param
+	*	numSpheres The number of spheres
+	*/
+	void SphereSet::reserve(unsigned int numSpheres)
+	{
+		_centerX.reserve(numSpheres + PacketWidth);
+		_centerY.reserve(numSpheres + PacketWidth);
+		_centerZ.reserve(numSpheres + PacketWidth);
+		_radius.reserve(numSpheres + PacketWidth);
+		_materialIndices.reserve(numSpheres);
+	}
+
+	/** Add a material spheres can refer to
+	* @param
+	*	material The material
+	* @return
+	*	unsigned int The index to pass to addSphere
+	*/
+	unsigned int SphereSet::addMaterial(const Material& material)
+	{
+		_materials.push_back(material);
+		return static_cast<unsigned int>(_materials.size() - 1);
+	}
+
+	/** Add a sphere, call build once every sphere is added
+	* @param
+	*	center The center
+	* @param
+	*	radius The radius
+	* @param
+	*	material Index of the sphere's material from addMaterial
+	*/
+	void SphereSet::addSphere(const Vector3& center, float radius, unsigned int material)
+	{
+		// Drop the padding of an earlier build before appending
+		_centerX.resize(_numSpheres);
+		_centerY.resize(_numSpheres);
+		_centerZ.resize(_numSpheres);
+		_radius.resize(_numSpheres);
+
+		_centerX.push_back(center.getX());
+		_centerY.push_back(center.getY());
+		_centerZ.push_back(center.getZ());
+		_radius.push_back(radius);
+		_materialIndices.push_back(material);
+		++_numSpheres;
+	}
+
+	/** Set the number of spheres, spheres past the old count are left empty until set. Meant
+	*	for filling a large set from several threads, call build once every sphere is set
+	* @param
+	*	numSpheres The number of spheres
+	*/
+	void SphereSet::resize(unsigned int numSpheres)
+	{
+		// Any padding of an earlier build is cleared along with the new spheres
+		_centerX.resize(_numSpheres);
+		_centerY.resize(_numSpheres);
+		_centerZ.resize(_numSpheres);
+		_radius.resize(_numSpheres);
+
+		_centerX.resize(numSpheres, 0.0f);
+		_centerY.resize(numSpheres, 0.0f);
+		_centerZ.resize(numSpheres, 0.0f);
+		_radius.resize(numSpheres, 0.0f);
+		_materialIndices.resize(numSpheres, 0);
+		_numSpheres = numSpheres;
+	}
+
+	/** Set a sphere added by resize, different spheres may be set from different threads at once
+	* @param
+	*	sphere Index of the sphere
+	* @param
+	*	center The center
+	* @param
+	*	radius The radius
+	* @param
+	*	material Index of the sphere's material from addMaterial
+	*/
+	void SphereSet::setSphere(unsigned int sphere, const Vector3& center, float radius, unsigned int material)
+	{
+		assert(sphere < _numSpheres);
+		_centerX[sphere] = center.getX();
+		_centerY[sphere] = center.getY();
+		_centerZ[sphere] = center.getZ();
+		_radius[sphere] = radius;
+		_materialIndices[sphere] = material;
+	}
+
+	/** Build the hierarchy over the spheres, which reorders them into leaf order
+	*/
+	void SphereSet::build()
+	{
+		std::vector<AABB> bounds(_numSpheres);
+		for(unsigned int i = 0; i < _numSpheres; ++i)
+		{
+			Vector3 center(_centerX[i], _centerY[i], _centerZ[i]);
+			Vector3 extent(_radius[i], _radius[i], _radius[i]);
+			bounds[i] = AABB(center - extent, center + extent);
+		}
+		_bvh.build(bounds);
+
+		// Store the spheres in leaf order, so a leaf's range in the indices is also its range here
+		const std::vector<unsigned int>& order = _bvh.getIndices();
+		std::vector<float> centerX(_numSpheres + PacketWidth - 1, 0.0f);
+		std::vector<float> centerY(_numSpheres + PacketWidth - 1, 0.0f);
+		std::vector<float> centerZ(_numSpheres + PacketWidth - 1, 0.0f);
+		std::vector<float> radius(_numSpheres + PacketWidth - 1, 0.0f);
+		std::vector<unsigned int> materialIndices(_numSpheres);
+		for(unsigned int i = 0; i < _numSpheres; ++i)
+		{
+			centerX[i] = _centerX[order[i]];
+			centerY[i] = _centerY[order[i]];
+			centerZ[i] = _centerZ[order[i]];
+			radius[i] = _radius[order[i]];
+			materialIndices[i] = _materialIndices[order[i]];
+		}
+		_centerX.swap(centerX);
+		_centerY.swap(centerY);
+		_centerZ.swap(centerZ);
+		_radius.swap(radius);
+		_materialIndices.swap(materialIndices);
+	}
+
+	/** Get the number of spheres
+	* @return
+	*	unsigned int The number of spheres
+	*/
+	unsigned int SphereSet::getNumSpheres() const
+	{
+		return _numSpheres;
+	}
+
+	/** Get the center of a sphere
+	* @param
+	*	sphere Index of the sphere in leaf order
+	* @return
+	*	Vector3 The center
+	*/
+	Vector3 SphereSet::getCenter(unsigned int sphere) const
+	{
+		return Vector3(_centerX[sphere], _centerY[sphere], _centerZ[sphere]);
+	}
+
+	/** Get the radius of a sphere
+	* @param
+	*	sphere Index of the sphere in leaf order
+	* @return
+	*	float The radius
+	*/
+	float SphereSet::getRadius(unsigned int sphere) const
+	{
+		return _radius[sphere];
+	}
+
+	/** Find the nearest sphere along a ray
+	* @param
+	*	ray The ray, only hits within [tMin, tMax] count
+	* @param
+	*	t The nearest distance accepted so far, receives the distance to the sphere found
+	* @return
+	*	unsigned int Index of the nearest sphere in leaf order, HitRecord::InvalidPrimitive if
+	*	no sphere is nearer than t
+	*/
+	unsigned int SphereSet::findNearest(const Ray& ray, float& t) const
+	{
+		t = std::min(t, ray.getTMax());
+		unsigned int nearest = HitRecord::InvalidPrimitive;
+		_bvh.traverseLeaves(ray, t, [&](unsigned int first, unsigned int count)
+		{
+			unsigned int sphere = intersectRun(first, count, ray, t);
+			if(sphere != HitRecord::InvalidPrimitive)
+			{
+				nearest = sphere;
+			}
+			return false;
+		});
+		return nearest;
+	}
+
+	/** Test for an intersection between a ray and the spheres
+	* @param
+	*	ray The ray to test against intersection
+	* @param
+	*	hit The closest hit so far, overwritten if a sphere is hit nearer than hit.t
+	* @return
+	*	bool True if intersection is found, false otherwise
+	*/
+	bool SphereSet::intersect(const Ray& ray, HitRecord& hit) const
+	{
+		float t = hit.t;
+		unsigned int sphere = findNearest(ray, t);
+		if(sphere == HitRecord::InvalidPrimitive)
+		{
+			return false;
+		}
+
+		setHit(sphere, ray(t), t, hit);
+		return true;
+	}
+
+	/** Test the active lanes of a ray packet for intersection
+	* @param
+	*	packet The rays to test
+	* @param
+	*	mask The lanes to test, a bit per lane
+	* @param
+	*	hits The closest hits so far, lanes hit nearer than their t are overwritten
+	* @return
+	*	unsigned int The lanes whose hit was overwritten
+	*/
+	unsigned int SphereSet::intersectPacket(const RayPacket& packet, unsigned int mask, HitPacket& hits) const
+	{
+		PacketFloat dx = PacketLoad(packet.directionX);
+		PacketFloat dy = PacketLoad(packet.directionY);
+		PacketFloat dz = PacketLoad(packet.directionZ);
+		PacketFloat ox = PacketLoad(packet.originX);
+		PacketFloat oy = PacketLoad(packet.originY);
+		PacketFloat oz = PacketLoad(packet.originZ);
+		PacketFloat tMin = PacketLoad(packet.tMin);
+		PacketFloat a = dx * dx + dy * dy + dz * dz;
+
+		// Each lane remembers its nearest sphere, the hit records are only filled in at the end
+		unsigned int nearest[PacketWidth];
+		unsigned int updated = 0;
+		_bvh.traversePacketLeaves(packet, mask, hits.t, [&](unsigned int first, unsigned int count, unsigned int leafMask)
+		{
+			for(unsigned int sphere = first; sphere < first + count; ++sphere)
+			{
+				// One sphere against every lane
+				PacketFloat lx = ox - PacketSplat(_centerX[sphere]);
+				PacketFloat ly = oy - PacketSplat(_centerY[sphere]);
+				PacketFloat lz = oz - PacketSplat(_centerZ[sphere]);
+				PacketFloat valid;
+				PacketFloat t = SolveSpheres(lx, ly, lz, dx, dy, dz, a, PacketSplat(_radius[sphere]), tMin, valid);
+				valid = PacketAnd(valid, PacketLess(t, PacketLoad(hits.t)));
+
+				unsigned int hitLanes = leafMask & PacketMoveMask(valid);
+				ST_STATS_ADD(numPrimitiveTests, CountLanes(leafMask));
+				ST_STATS_ADD(numPrimitiveHits, CountLanes(hitLanes));
+				if(hitLanes == 0)
+				{
+					continue;
+				}
+
+				float tLanes[PacketWidth];
+				PacketStore(tLanes, t);
+				for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+				{
+					if((hitLanes & (1u << lane)) != 0)
+					{
+						hits.t[lane] = tLanes[lane];
+						nearest[lane] = sphere;
+					}
+				}
+				updated |= hitLanes;
+			}
+			return false;
+		});
+
+		for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+		{
+			if((updated & (1u << lane)) == 0)
+			{
+				continue;
+			}
+
+			Vector3 origin(packet.originX[lane], packet.originY[lane], packet.originZ[lane]);
+			Vector3 direction(packet.directionX[lane], packet.directionY[lane], packet.directionZ[lane]);
+			HitRecord hit;
+			setHit(nearest[lane], origin + (direction * hits.t[lane]), hits.t[lane], hit);
+			hits.setHit(lane, hit);
+		}
+		return updated;
+	}
+
+	/** Any hit test, skips the normal and surface parameterization
+	* @param
+	*	ray The ray to test, only hits within [tMin, tMax] count
+	* @return
+	*	bool True if any sphere blocks the ray
+	*/
+	bool SphereSet::occludes(const Ray& ray) const
+	{
+		// Stop at the first leaf that has any sphere in the way
+		float t = ray.getTMax();
+		bool blocked = false;
+		_bvh.traverseLeaves(ray, t, [&](unsigned int first, unsigned int count)
+		{
+			blocked = intersectRun(first, count, ray, t) != HitRecord::InvalidPrimitive;
+			return blocked;
+		});
+		return blocked;
+	}
+
+	/** Calculate the surface normal for a given contact point, searches every sphere for the
+	*	one whose surface is nearest the point so hits should use their own normal instead
+	* @param
+	*	surfacePoint The surface point at which to construct a normal
+	* @return
+	*	Vector3 A vector representing a surface normal
+	*/
+	Vector3 SphereSet::getSurfaceNormal(const Vector3& surfacePoint) const
+	{
+		unsigned int nearest = 0;
+		float nearestDistance = FLT_MAX;
+		for(unsigned int i = 0; i < _numSpheres; ++i)
+		{
+			Vector3 offset = surfacePoint - Vector3(_centerX[i], _centerY[i], _centerZ[i]);
+			float distance = fabsf(offset.length() - _radius[i]);
+			if(distance < nearestDistance)
+			{
+				nearestDistance = distance;
+				nearest = i;
+			}
+		}
+
+		Vector3 normal = surfacePoint - Vector3(_centerX[nearest], _centerY[nearest], _centerZ[nearest]);
+		normal.normalize();
+		return normal;
+	}
+
+	/** Get the world space bounds of the set
+	* @return
+	*	AABB A box containing every sphere
+	*/
+	AABB SphereSet::getBounds() const
+	{
+		return _bvh.getBounds();
+	}
+
+	/** Get the bytes used per sphere for its geometry and material index, not counting the
+	*	hierarchy
+	* @return
+	*	unsigned int The bytes per sphere
+	*/
+	unsigned int SphereSet::getBytesPerSphere()
+	{
+		return 4 * sizeof(float) + sizeof(unsigned int);
+	}
+
+	/** Test a run of spheres against a ray, a packet of spheres at a time
+	* @param
+	*	first The first sphere
+	* @param
+	*	count The number of spheres
+	* @param
+	*	ray The ray
+	* @param
+	*	t The nearest distance accepted so far, shortened by any nearer hit
+	* @return
+	*	unsigned int Index of the nearest sphere hit, HitRecord::InvalidPrimitive if none
+	*/
+	unsigned int SphereSet::intersectRun(unsigned int first, unsigned int count, const Ray& ray, float& t) const
+	{
+		const Vector3& o = ray.getOrigin();
+		const Vector3& d = ray.getDirection();
+		PacketFloat ox = PacketSplat(o.getX());
+		PacketFloat oy = PacketSplat(o.getY());
+		PacketFloat oz = PacketSplat(o.getZ());
+		PacketFloat dx = PacketSplat(d.getX());
+		PacketFloat dy = PacketSplat(d.getY());
+		PacketFloat dz = PacketSplat(d.getZ());
+		PacketFloat a = PacketSplat(d.dot(d));
+		PacketFloat tMin = PacketSplat(ray.getTMin());
+
+		unsigned int nearest = HitRecord::InvalidPrimitive;
+		for(unsigned int offset = 0; offset < count; offset += PacketWidth)
+		{
+			unsigned int base = first + offset;
+			PacketFloat lx = ox - PacketLoad(&_centerX[base]);
+			PacketFloat ly = oy - PacketLoad(&_centerY[base]);
+			PacketFloat lz = oz - PacketLoad(&_centerZ[base]);
+			PacketFloat valid;
+			PacketFloat tHit = SolveSpheres(lx, ly, lz, dx, dy, dz, a, PacketLoad(&_radius[base]), tMin, valid);
+			valid = PacketAnd(valid, PacketLess(tHit, PacketSplat(t)));
+
+			// Lanes past the end of the run hold the next leaf's spheres or padding
+			unsigned int hitLanes = PacketMoveMask(valid) & PacketLaneMask(count - offset);
+			ST_STATS_ADD(numPrimitiveTests, count - offset < PacketWidth ? count - offset : PacketWidth);
+			ST_STATS_ADD(numPrimitiveHits, CountLanes(hitLanes));
+			if(hitLanes == 0)
+			{
+				continue;
+			}
+
+			float tLanes[PacketWidth];
+			PacketStore(tLanes, tHit);
+			for(unsigned int lane = 0; lane < PacketWidth; ++lane)
+			{
+				if((hitLanes & (1u << lane)) != 0 && tLanes[lane] < t)
+				{
+					t = tLanes[lane];
+					nearest = base + lane;
+				}
+			}
+		}
+		return nearest;
+	}
+
+	/** Fill in a hit record for a point on a sphere
+	* @param
+	*	sphere The sphere that was hit
+	* @param
+	*	contact The point on the surface
+	* @param
+	*	t The distance along the ray to the point
+	* @param
+	*	hit Receives the hit
+	*/
+	void SphereSet::setHit(unsigned int sphere, const Vector3& contact, float t, HitRecord& hit) const
+	{
+		Vector3 center(_centerX[sphere], _centerY[sphere], _centerZ[sphere]);
+
+		hit.t = t;
+		hit.primitive = sphere;
+		hit.object = this;
+		hit.material = &_materials[_materialIndices[sphere]];
+		hit.normal = (contact - center) * (1.0f / _radius[sphere]);
+
+		// Longitude and latitude of the contact point
+		hit.u = 0.5f + atan2f(hit.normal.getZ(), hit.normal.getX()) * (0.5f / M_PI);
+		hit.v = acosf(std::min(std::max(hit.normal.getY(), -1.0f), 1.0f)) * (1.0f / M_PI);
+	}
+
+}	// Namespace
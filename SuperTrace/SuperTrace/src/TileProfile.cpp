@@ -0,0 +1,108 @@
+//*************************************************************************************************
+// Title: TileProfile.cpp
+// Description: What each traced tile cost, and ways to look at it: a heatmap the size of the
+//	frame and a CSV with a row per tile.
+//*************************************************************************************************
+#include "TileProfile.h"
+#include <stdio.h>
+
+namespace SuperTrace
+{
+	/** Map a value in [0, 1] onto the heat ramp, black to red to yellow to white
+	*/
+	static void HeatColor(float value, float* rgb)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		float scaled = value * 3.0f;
+		rgb[0] = scaled < 1.0f ? scaled : 1.0f;
+		rgb[1] = scaled < 1.0f ? 0.0f : (scaled < 2.0f ? scaled - 1.0f : 1.0f);
+		rgb[2] = scaled < 2.0f ? 0.0f : scaled - 2.0f;
+	}
+
+	/** Get a tile's time per pixel
+	*/
+	static double SecondsPerPixel(const TileRecord& record)
+	{
+		unsigned int pixels = record.width * record.height;
+		return pixels > 0 ? record.seconds / pixels : 0.0;
+	}
+
+	/** Paint each tile's time per pixel over the frame, from black through red and yellow to
+	*	white at the most expensive tile, with tile edges darkened so the grid stays visible
+	* @param
+	*	records The tiles of a frame
+	* @param
+	*	width The frame width
+	* @param
+	*	height The frame height
+	* @param
+	*	pixels Receives width * height RGB floats stored bottom up, like the frame buffer
+	*/
+	void BuildTileHeatmap(const std::vector<TileRecord>& records, unsigned int width, unsigned int height, float* pixels)
+	{
+		for(unsigned int i = 0; i < width * height * 3; ++i)
+		{
+			pixels[i] = 0.0f;
+		}
+
+		double maxCost = 0.0;
+		for(size_t i = 0; i < records.size(); ++i)
+		{
+			double cost = SecondsPerPixel(records[i]);
+			maxCost = cost > maxCost ? cost : maxCost;
+		}
+		if(maxCost <= 0.0)
+		{
+			return;
+		}
+
+		for(size_t i = 0; i < records.size(); ++i)
+		{
+			const TileRecord& record = records[i];
+			float rgb[3];
+			HeatColor(static_cast<float>(SecondsPerPixel(record) / maxCost), rgb);
+
+			for(unsigned int y = record.startY; y < record.startY + record.height && y < height; ++y)
+			{
+				bool edgeRow = y == record.startY || y + 1 == record.startY + record.height;
+				float* row = pixels + (height - 1 - y) * width * 3;
+				for(unsigned int x = record.startX; x < record.startX + record.width && x < width; ++x)
+				{
+					bool edge = edgeRow == true || x == record.startX || x + 1 == record.startX + record.width;
+					float shade = edge == true ? 0.5f : 1.0f;
+					row[x * 3] = rgb[0] * shade;
+					row[x * 3 + 1] = rgb[1] * shade;
+					row[x * 3 + 2] = rgb[2] * shade;
+				}
+			}
+		}
+	}
+
+	/** Write the tiles of a frame as CSV, a row per tile
+	* @param
+	*	path The file to write
+	* @param
+	*	records The tiles
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteTileCsv(const char* path, const std::vector<TileRecord>& records)
+	{
+		FILE* file = fopen(path, "w");
+		if(file == 0)
+		{
+			return false;
+		}
+
+		fprintf(file, "x,y,width,height,worker,ms,rays,ns_per_pixel,rays_per_pixel\n");
+		for(size_t i = 0; i < records.size(); ++i)
+		{
+			const TileRecord& r = records[i];
+			unsigned int pixels = r.width * r.height;
+			fprintf(file, "%u,%u,%u,%u,%u,%.4f,%llu,%.1f,%.2f\n", r.startX, r.startY, r.width, r.height, r.worker, r.seconds * 1000.0, r.numRays,
+				SecondsPerPixel(r) * 1.0e9, pixels > 0 ? static_cast<double>(r.numRays) / pixels : 0.0);
+		}
+		return fclose(file) == 0;
+	}
+
+}	// Namespace
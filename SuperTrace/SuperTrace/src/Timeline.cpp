@@ -0,0 +1,362 @@
+//*************************************************************************************************
+// Title: Timeline.cpp
+// Description: A timeline of what each thread was doing while rendering, written as Chrome
+//	trace-event JSON. Only records when ST_ENABLE_TIMELINE is defined.
+//*************************************************************************************************
+#include "Timeline.h"
+#include <stdio.h>
+#ifdef ST_ENABLE_TIMELINE
+#include <chrono>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace SuperTrace
+{
+#ifdef ST_ENABLE_TIMELINE
+	std::atomic<bool> TimelineCapturing(false);
+
+	namespace
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		// Spans each thread keeps, the oldest are overwritten past this
+		const unsigned int RingCapacity = 1 << 16;
+
+		// Rows handed to threads that never bound one start here
+		const unsigned int FirstUnboundThread = 1000;
+
+		const Clock::time_point Epoch = Clock::now();
+
+		/** A recorded span
+		*/
+		struct Span
+		{
+			const char* name;
+			long long start;
+			long long end;
+			unsigned int x;
+			unsigned int y;
+			unsigned int width;
+			unsigned int height;
+		};
+
+		/** The spans of one row of the timeline. Only the thread holding the row writes to it, the
+		*	count is published after each span so a reader sees whole spans
+		*/
+		struct Ring
+		{
+			Ring(unsigned int inThread, const char* inName, bool inUnbound)
+				:	spans(RingCapacity), count(0), captureBegin(0), thread(inThread), unbound(inUnbound), inUse(true)
+			{
+				snprintf(name, sizeof(name), "%s", inName);
+			}
+
+			std::vector<Span> spans;
+			std::atomic<unsigned long long> count;
+
+			// The count when the capture started, the spans before it are left out
+			unsigned long long captureBegin;
+
+			unsigned int thread;
+			char name[32];
+
+			// Rows of threads that never bound one are reused once their thread exits
+			bool unbound;
+			bool inUse;
+		};
+
+		/** Every row ever created, rows live as long as the process so a capture outlives the
+		*	threads that recorded it
+		*/
+		struct Registry
+		{
+			Registry()
+				:	captureStart(0)
+			{ }
+
+			~Registry()
+			{
+				for(size_t i = 0; i < rings.size(); ++i)
+				{
+					delete rings[i];
+				}
+			}
+
+			std::mutex mutex;
+			std::vector<Ring*> rings;
+			long long captureStart;
+		};
+
+		Registry& GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		/** The row held by the calling thread, an unbound row is given back when the thread exits
+		*/
+		struct ThreadRing
+		{
+			ThreadRing()
+				:	ring(0)
+			{ }
+
+			~ThreadRing()
+			{
+				release();
+			}
+
+			void release()
+			{
+				if(ring != 0 && ring->unbound == true)
+				{
+					std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+					ring->inUse = false;
+				}
+				ring = 0;
+			}
+
+			Ring* ring;
+		};
+
+		thread_local ThreadRing CurrentRing;
+
+		/** Get the row for a thread, creating it the first time. The registry must be locked
+		*/
+		Ring* FindRing(Registry& registry, unsigned int thread, const char* name)
+		{
+			for(size_t i = 0; i < registry.rings.size(); ++i)
+			{
+				if(registry.rings[i]->unbound == false && registry.rings[i]->thread == thread)
+				{
+					snprintf(registry.rings[i]->name, sizeof(registry.rings[i]->name), "%s", name);
+					return registry.rings[i];
+				}
+			}
+			registry.rings.push_back(new Ring(thread, name, false));
+			return registry.rings.back();
+		}
+
+		/** Get a free row for a thread that never bound one. The registry must be locked
+		*/
+		Ring* AcquireUnboundRing(Registry& registry)
+		{
+			unsigned int numUnbound = 0;
+			for(size_t i = 0; i < registry.rings.size(); ++i)
+			{
+				if(registry.rings[i]->unbound == true)
+				{
+					if(registry.rings[i]->inUse == false)
+					{
+						registry.rings[i]->inUse = true;
+						return registry.rings[i];
+					}
+					++numUnbound;
+				}
+			}
+
+			char name[32];
+			snprintf(name, sizeof(name), "Thread %u", numUnbound);
+			registry.rings.push_back(new Ring(FirstUnboundThread + numUnbound, name, true));
+			return registry.rings.back();
+		}
+
+		/** Write a JSON string, span and row names are plain text but may hold quotes
+		*/
+		void WriteJsonString(FILE* file, const char* text)
+		{
+			fputc('"', file);
+			for(; *text != '\0'; ++text)
+			{
+				if(*text == '"' || *text == '\\')
+				{
+					fputc('\\', file);
+				}
+				fputc(*text, file);
+			}
+			fputc('"', file);
+		}
+	}
+
+	/** Get the time spans are measured in
+	* @return
+	*	long long Nanoseconds since the process started
+	*/
+	long long GetTimelineTime()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Epoch).count();
+	}
+
+	/** Add a span to the calling thread's ring, overwriting the oldest once the ring is full
+	* @param
+	*	name The span name, must outlive the capture
+	* @param
+	*	start The start time from GetTimelineTime
+	* @param
+	*	end The end time from GetTimelineTime
+	* @param
+	*	x, y, width, height The tile the span worked on, a width of 0 for none
+	*/
+	void RecordTimelineSpan(const char* name, long long start, long long end, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+	{
+		Ring* ring = CurrentRing.ring;
+		if(ring == 0)
+		{
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			ring = CurrentRing.ring = AcquireUnboundRing(registry);
+		}
+
+		unsigned long long count = ring->count.load(std::memory_order_relaxed);
+		Span& span = ring->spans[count & (RingCapacity - 1)];
+		span.name = name;
+		span.start = start;
+		span.end = end;
+		span.x = x;
+		span.y = y;
+		span.width = width;
+		span.height = height;
+		ring->count.store(count + 1, std::memory_order_release);
+	}
+#endif
+
+	/** Check whether timeline spans are compiled in
+	* @return
+	*	bool True when built with ST_ENABLE_TIMELINE
+	*/
+	bool IsTimelineEnabled()
+	{
+#ifdef ST_ENABLE_TIMELINE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** Start recording spans, dropping whatever was recorded before. Call while no render is in
+	*	flight
+	*/
+	void StartTimelineCapture()
+	{
+#ifdef ST_ENABLE_TIMELINE
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// Older spans stay in the rings, the capture starts after them
+		registry.captureStart = GetTimelineTime();
+		for(size_t i = 0; i < registry.rings.size(); ++i)
+		{
+			registry.rings[i]->captureBegin = registry.rings[i]->count.load(std::memory_order_acquire);
+		}
+		TimelineCapturing.store(true);
+#endif
+	}
+
+	/** Stop recording spans, what was recorded is kept until the next capture starts
+	*/
+	void StopTimelineCapture()
+	{
+#ifdef ST_ENABLE_TIMELINE
+		TimelineCapturing.store(false);
+#endif
+	}
+
+	/** Give the calling thread a row of the timeline. A thread that records a span without one is
+	*	given a row of its own, which is handed on to another such thread once it exits. A row may
+	*	only be held by one running thread at a time
+	* @param
+	*	thread The row, threads that come and go under the same role share one across frames
+	* @param
+	*	name The name shown for the row
+	*/
+	void BindTimelineThread(unsigned int thread, const char* name)
+	{
+#ifdef ST_ENABLE_TIMELINE
+		CurrentRing.release();
+
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		CurrentRing.ring = FindRing(registry, thread, name);
+#else
+		(void)thread;
+		(void)name;
+#endif
+	}
+
+	/** Give the calling thread the row of a trace worker
+	* @param
+	*	worker The worker index
+	*/
+	void BindTimelineWorker(unsigned int worker)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "Worker %u", worker);
+		BindTimelineThread(TIMELINE_THREAD_WORKER + worker, name);
+	}
+
+	/** Write the spans of the last capture as Chrome trace-event JSON. Call once the render has
+	*	finished, spans recorded while writing may be torn
+	* @param
+	*	path The file to write
+	* @return
+	*	bool False if the file could not be written
+	*/
+	bool WriteTimeline(const char* path)
+	{
+		FILE* file = fopen(path, "w");
+		if(file == 0)
+		{
+			return false;
+		}
+
+		fprintf(file, "{\"traceEvents\":[\n");
+		unsigned long long numDropped = 0;
+#ifdef ST_ENABLE_TIMELINE
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		bool first = true;
+		for(size_t i = 0; i < registry.rings.size(); ++i)
+		{
+			const Ring& ring = *registry.rings[i];
+			unsigned long long count = ring.count.load(std::memory_order_acquire);
+			unsigned long long begin = count > RingCapacity ? count - RingCapacity : 0;
+
+			// Spans of this capture that were overwritten before they could be written
+			if(begin > ring.captureBegin)
+			{
+				numDropped += begin - ring.captureBegin;
+			}
+			else
+			{
+				begin = ring.captureBegin;
+			}
+
+			// Name and order the row, the viewer sorts rows by their sort index
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first == true ? "" : ",\n", ring.thread);
+			WriteJsonString(file, ring.name);
+			fprintf(file, "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", ring.thread, ring.thread);
+			first = false;
+
+			// Complete events in microseconds from the start of the capture
+			for(unsigned long long j = begin; j < count; ++j)
+			{
+				const Span& span = ring.spans[j & (RingCapacity - 1)];
+				fprintf(file, ",\n{\"name\":");
+				WriteJsonString(file, span.name);
+				fprintf(file, ",\"cat\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", ring.thread,
+					(span.start - registry.captureStart) / 1000.0, (span.end - span.start) / 1000.0);
+				if(span.width > 0)
+				{
+					fprintf(file, ",\"args\":{\"x\":%u,\"y\":%u,\"width\":%u,\"height\":%u}", span.x, span.y, span.width, span.height);
+				}
+				fputc('}', file);
+			}
+		}
+#endif
+		fprintf(file, "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"droppedSpans\":%llu}}\n", numDropped);
+		return fclose(file) == 0;
+	}
+
+}	// Namespace
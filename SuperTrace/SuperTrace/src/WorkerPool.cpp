@@ -0,0 +1,347 @@
+//*************************************************************************************************
+// Title: WorkerPool.cpp
+// Description: A portable pool of tile workers. Each worker owns a lock-free deque of chunks,
+//	taking its own tiles from the bottom, and steals from the top of the other workers' deques when
+//	its own runs dry.
+//*************************************************************************************************
+#include "WorkerPool.h"
+#include "Timeline.h"
+#include <assert.h>
+
+namespace SuperTrace
+{
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// Rounds of failed steals an idle worker yields through before it blocks until there is work
+	static const unsigned int IdleSpinRounds = 64;
+
+	/** Convert a clock duration to seconds
+	*/
+	static double ToSeconds(Clock::duration d)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double> >(d).count();
+	}
+
+	/** Default constructor
+	*/
+	WorkerPool::WorkerPool()
+		:	_requestedWorkers(0), _numWorkers(0), _workers(0), _nextSubmit(0), _pending(0), _numIdle(0), _idleEpoch(0)
+	{
+		allocateWorkers();
+	}
+
+	/** Destructor
+	*/
+	WorkerPool::~WorkerPool()
+	{
+		join();
+		delete[] _workers;
+	}
+
+	/** Set the number of workers used by the next call to start
+	* @param
+	*	numWorkers The number of workers, 0 to size the pool from the hardware concurrency
+	*/
+	void WorkerPool::setNumWorkers(unsigned int numWorkers)
+	{
+		_requestedWorkers = numWorkers;
+		allocateWorkers();
+	}
+
+	/** Get the number of workers the pool will run with
+	* @return
+	*	unsigned int The number of workers
+	*/
+	unsigned int WorkerPool::getNumWorkers() const
+	{
+		return _numWorkers;
+	}
+
+	/** Allocate the workers if the requested count changed
+	*/
+	void WorkerPool::allocateWorkers()
+	{
+		unsigned int numWorkers = _requestedWorkers;
+		if(numWorkers == 0)
+		{
+			// hardware_concurrency is allowed to report 0 when it cannot tell
+			numWorkers = std::thread::hardware_concurrency();
+			if(numWorkers == 0)
+			{
+				numWorkers = 1;
+			}
+		}
+
+		if(numWorkers == _numWorkers)
+		{
+			return;
+		}
+
+		// Workers may only be reallocated while the pool is idle and empty
+		assert(_pending.load() == 0);
+		join();
+		delete[] _workers;
+
+		_numWorkers = numWorkers;
+		_workers = new Worker[_numWorkers];
+		_nextSubmit = 0;
+	}
+
+	/** Empty the worker deques and size them for a render, must be called before submitting
+	* @param
+	*	numTiles The number of tiles that will be submitted
+	* @param
+	*	spareTiles Extra room per worker for tiles pushed while the pool runs
+	*/
+	void WorkerPool::reserve(unsigned int numTiles, unsigned int spareTiles)
+	{
+		join();
+
+		unsigned int perWorker = (numTiles + _numWorkers - 1) / _numWorkers;
+		for(unsigned int i = 0; i < _numWorkers; ++i)
+		{
+			_workers[i].deque.reset(perWorker + spareTiles);
+		}
+		_nextSubmit = 0;
+		_pending.store(0);
+	}
+
+	/** Submit a tile before the pool is started, tiles are distributed round robin and each
+	*	worker takes its share in the order it was submitted
+	* @param
+	*	chunk The tile to submit
+	*/
+	void WorkerPool::submit(const ChunkData& chunk)
+	{
+		Worker& worker = _workers[_nextSubmit];
+		_nextSubmit = (_nextSubmit + 1) % _numWorkers;
+
+		_pending.fetch_add(1, std::memory_order_relaxed);
+
+		// Filling from the top leaves the first tile submitted at the bottom, where the owner starts.
+		// reserve sized every deque for its share of the tiles
+		bool pushed = worker.deque.pushTop(chunk);
+		assert(pushed == true);
+		(void)pushed;
+	}
+
+	/** Push a tile onto the bottom of a worker's own deque from within a running tile function,
+	*	the worker takes it next unless a thief gets to it first
+	* @param
+	*	worker The index of the calling worker
+	* @param
+	*	chunk The tile to push
+	* @return
+	*	bool False if the worker's deque is full, the caller keeps the work
+	*/
+	bool WorkerPool::push(unsigned int worker, const ChunkData& chunk)
+	{
+		assert(worker < _numWorkers);
+
+		// Count the tile before it becomes visible so the pool cannot drain while it is in flight
+		_pending.fetch_add(1, std::memory_order_relaxed);
+
+		if(_workers[worker].deque.push(chunk) == false)
+		{
+			_pending.fetch_sub(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// Pairs with the fence in waitForWork, either a worker going idle sees the tile or this sees
+		// the worker
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(_numIdle.load(std::memory_order_relaxed) > 0)
+		{
+			wakeIdleWorkers();
+		}
+		return true;
+	}
+
+	/** Start the workers, they exit once every submitted and pushed tile has been executed
+	* @param
+	*	tileFunction The function to execute for each tile
+	*/
+	void WorkerPool::start(const TileFunction& tileFunction)
+	{
+		join();
+
+		_tileFunction = tileFunction;
+		for(unsigned int i = 0; i < _numWorkers; ++i)
+		{
+			_workers[i].stats = WorkerStats();
+			_workers[i].thread = std::thread(&WorkerPool::workerLoop, this, i);
+		}
+	}
+
+	/** Wait for all workers to exit
+	*/
+	void WorkerPool::join()
+	{
+		for(unsigned int i = 0; i < _numWorkers; ++i)
+		{
+			if(_workers[i].thread.joinable() == true)
+			{
+				_workers[i].thread.join();
+			}
+		}
+	}
+
+	/** Get the statistics for a worker, only valid once the pool has been joined
+	* @param
+	*	worker The worker index
+	* @return
+	*	const WorkerStats& The statistics for the worker
+	*/
+	const WorkerStats& WorkerPool::getWorkerStats(unsigned int worker) const
+	{
+		assert(worker < _numWorkers);
+		return _workers[worker].stats;
+	}
+
+	/** Main loop for a worker thread
+	* @param
+	*	index The worker index
+	*/
+	void WorkerPool::workerLoop(unsigned int index)
+	{
+		WorkerStats& stats = _workers[index].stats;
+		Clock::time_point idleStart = Clock::now();
+		BindTimelineWorker(index);
+
+		// Spans the time from finishing one tile to picking up the next
+		TimelineSpan dequeueSpan;
+
+		ChunkData chunk;
+		unsigned int failedRounds = 0;
+		while(true)
+		{
+			// Prefer our own work, then try to steal
+			bool found = popLocal(index, chunk);
+			bool stolen = false;
+			if(found == false)
+			{
+				found = stolen = steal(index, chunk);
+				if(found == true)
+				{
+					++stats.tilesStolen;
+				}
+			}
+
+			if(found == true)
+			{
+				Clock::time_point busyStart = Clock::now();
+				stats.idleSeconds += ToSeconds(busyStart - idleStart);
+				dequeueSpan.end(stolen == true ? "Steal" : "Dequeue", chunk._startX, chunk._startY, chunk._width, chunk._height);
+
+				_tileFunction(chunk, index);
+
+				idleStart = Clock::now();
+				dequeueSpan.restart();
+				stats.busySeconds += ToSeconds(idleStart - busyStart);
+				++stats.tilesExecuted;
+				failedRounds = 0;
+
+				if(_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					// The last tile, release the workers waiting for more
+					wakeIdleWorkers();
+				}
+			}
+			else if(_pending.load(std::memory_order_acquire) == 0)
+			{
+				// Every tile has been executed, nothing more can arrive
+				break;
+			}
+			else if(++failedRounds < IdleSpinRounds)
+			{
+				// Other workers are still busy and may yet push work
+				std::this_thread::yield();
+			}
+			else
+			{
+				// The rest of the frame is in tiles other workers are tracing, stop burning a core
+				// until one of them splits or the frame ends
+				waitForWork();
+				failedRounds = 0;
+			}
+		}
+
+		stats.idleSeconds += ToSeconds(Clock::now() - idleStart);
+	}
+
+	/** Pop the newest tile from the bottom of the worker's own deque
+	* @param
+	*	index The worker index
+	* @param
+	*	chunk The popped tile
+	* @return
+	*	bool True if a tile was found
+	*/
+	bool WorkerPool::popLocal(unsigned int index, ChunkData& chunk)
+	{
+		return _workers[index].deque.pop(chunk);
+	}
+
+	/** Steal a tile from the top of another worker's deque
+	* @param
+	*	index The index of the stealing worker
+	* @param
+	*	chunk The stolen tile
+	* @return
+	*	bool True if a tile was found
+	*/
+	bool WorkerPool::steal(unsigned int index, ChunkData& chunk)
+	{
+		for(unsigned int i = 1; i < _numWorkers; ++i)
+		{
+			if(_workers[(index + i) % _numWorkers].deque.steal(chunk) == true)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Check whether any worker's deque holds a tile
+	* @return
+	*	bool True if a tile was found
+	*/
+	bool WorkerPool::hasQueuedTiles() const
+	{
+		for(unsigned int i = 0; i < _numWorkers; ++i)
+		{
+			if(_workers[i].deque.isEmpty() == false)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Block an idle worker until a tile is pushed or the last tile is done
+	*/
+	void WorkerPool::waitForWork()
+	{
+		std::unique_lock<std::mutex> lock(_idleMutex);
+		_numIdle.fetch_add(1, std::memory_order_relaxed);
+
+		// Pairs with the fence in push, a tile pushed before the count went up is seen here
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(hasQueuedTiles() == false && _pending.load(std::memory_order_acquire) > 0)
+		{
+			unsigned int epoch = _idleEpoch;
+			_idleCondition.wait(lock, [this, epoch]() { return _idleEpoch != epoch; });
+		}
+		_numIdle.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/** Wake every blocked worker
+	*/
+	void WorkerPool::wakeIdleWorkers()
+	{
+		std::lock_guard<std::mutex> lock(_idleMutex);
+		++_idleEpoch;
+		_idleCondition.notify_all();
+	}
+
+}	// Namespace
@@ -0,0 +1,176 @@
+//*************************************************************************************************
+// Title: Bench.h
+// Description: Entry points for the benchmark suites and the helpers they share.
+//*************************************************************************************************
+#ifndef __STBENCH_H__
+#define __STBENCH_H__
+
+#include <chrono>
+#include <vector>
+#include "Ray.h"
+#include "STMath.h"
+
+namespace SuperTrace
+{
+	/** \addtogroup Bench
+	*	@{
+	*/
+
+	typedef std::chrono::high_resolution_clock BenchClock;
+
+	/** Get the seconds elapsed since a time point
+	* @param
+	*	start The time point to measure from
+	* @return
+	*	double The elapsed time in seconds
+	*/
+	inline double SecondsSince(BenchClock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::duration<double> >(BenchClock::now() - start).count();
+	}
+
+	/** Generate camera rays fanning out along +z from a small square in front of a primitive volume
+	*	around the origin, drawn from Randf
+	* @param
+	*	numRays The number of rays
+	* @param
+	*	rays Receives the rays, replacing what it held
+	*/
+	inline void MakeFanRays(unsigned int numRays, std::vector<Ray>& rays)
+	{
+		rays.clear();
+		rays.reserve(numRays);
+		for(unsigned int i = 0; i < numRays; ++i)
+		{
+			Vector3 origin(Randf(-5.0f, 5.0f), Randf(-5.0f, 5.0f), -60.0f);
+			Vector3 direction(Randf(-0.5f, 0.5f), Randf(-0.5f, 0.5f), 1.0f);
+			direction.normalize();
+			rays.push_back(Ray(origin, direction, RAY_TYPE_CAMERA));
+		}
+	}
+
+	/** Measure lock-free queue throughput against a locked std::queue
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunQueueBench(int argc, char** argv);
+
+	/** Measure BVH build time and closest hit throughput against primitive count
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunBVHBench(int argc, char** argv);
+
+	/** Measure parallel BVH build time and SAH cost against primitive count, threads and bins
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunBVHBuildBench(int argc, char** argv);
+
+	/** Measure any hit occlusion queries against closest hit queries over the same rays
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunShadowBench(int argc, char** argv);
+
+	/** Measure the math kernels out of line, inlined scalar and inlined SIMD
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunMathBench(int argc, char** argv);
+
+	/** Measure primary visibility traced in ray packets against single rays
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunPacketBench(int argc, char** argv);
+
+	/** Measure SphereSet closest hit throughput and memory against separate Sphere objects
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSphereSetBench(int argc, char** argv);
+
+	/** Measure how frame time scales with trace workers, with and without tile buffers
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunScalingBench(int argc, char** argv);
+
+	/** Render the standard scenes and report frame timings, Mrays/s and a JSON summary
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSceneBench(int argc, char** argv);
+
+	/** Measure the hot per-ray kernels over hit-heavy and miss-heavy data, alternatives side by side
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunKernelBench(int argc, char** argv);
+
+	/** Time generating, building and tracing generated scenes of growing size in each layout
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSceneSizeBench(int argc, char** argv);
+
+	/** Check per pixel random numbers are the same whatever thread draws them and time drawing them
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunRandomBench(int argc, char** argv);
+
+	/** @} */
+
+}	// Namespace
+
+#endif	// __STBENCH_H__
@@ -0,0 +1,144 @@
+//*************************************************************************************************
+// Title: BVHBench.cpp
+// Description: Closest hit throughput of the BVH against a linear walk as the number of spheres
+//	grows. BVH cost should grow roughly with the log of the count, the linear walk with the count.
+//*************************************************************************************************
+#include "Bench.h"
+#include "BVH.h"
+#include "HitRecord.h"
+#include "Sphere.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Trace every ray through the hierarchy
+		* @return
+		*	unsigned int The number of rays that hit
+		*/
+		unsigned int TraceBVH(const BVH& bvh, const std::vector<Object*>& objects, const std::vector<Ray>& rays)
+		{
+			unsigned int hits = 0;
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				HitRecord hit(ray.getTMax());
+				bvh.traverse(ray, hit.t, [&](unsigned int index)
+				{
+					objects[index]->intersect(ray, hit);
+					return false;
+				});
+				hits += hit.isHit() == true ? 1 : 0;
+			}
+			return hits;
+		}
+
+		/** Trace every ray against every object
+		* @return
+		*	unsigned int The number of rays that hit
+		*/
+		unsigned int TraceLinear(const std::vector<Object*>& objects, const std::vector<Ray>& rays)
+		{
+			unsigned int hits = 0;
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				HitRecord hit(ray.getTMax());
+				for(unsigned int i = 0; i < objects.size(); ++i)
+				{
+					objects[i]->intersect(ray, hit);
+				}
+				hits += hit.isHit() == true ? 1 : 0;
+			}
+			return hits;
+		}
+	}
+
+	/** Measure BVH build time and closest hit throughput against primitive count
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunBVHBench(int argc, char** argv)
+	{
+		unsigned int maxPrimitives = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 100000;
+		unsigned int numRays = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 65536;
+
+		// The linear walk is only timed while it finishes in reasonable time
+		const unsigned int MaxLinearPrimitives = 10000;
+
+		SeedRandf(1);
+		std::vector<Ray> rays;
+		MakeFanRays(numRays, rays);
+
+		Matrix44 identity;
+		identity.setIdentity();
+
+		printf("%10s %8s %10s %14s %14s %8s\n", "prims", "nodes", "build ms", "bvh Mrays/s", "linear Mrays/s", "hit %");
+		for(unsigned int numPrimitives = 100; numPrimitives <= maxPrimitives; numPrimitives *= 10)
+		{
+			// Keep the total cross section of the spheres constant so hit rates stay comparable
+			float radius = 2.0f * sqrtf(1000.0f / numPrimitives);
+
+			std::vector<Object*> objects;
+			std::vector<AABB> bounds;
+			objects.reserve(numPrimitives);
+			bounds.reserve(numPrimitives);
+			for(unsigned int i = 0; i < numPrimitives; ++i)
+			{
+				Vector3 center(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				Sphere* sphere = new Sphere(identity, center, Randf(0.5f, 1.0f) * radius);
+				objects.push_back(sphere);
+				bounds.push_back(sphere->getBounds());
+			}
+
+			BVH bvh;
+			BenchClock::time_point start = BenchClock::now();
+			bvh.build(bounds);
+			double buildSeconds = SecondsSince(start);
+
+			start = BenchClock::now();
+			unsigned int hits = TraceBVH(bvh, objects, rays);
+			double bvhRate = numRays / SecondsSince(start) / 1.0e6;
+
+			double linearRate = 0.0;
+			if(numPrimitives <= MaxLinearPrimitives)
+			{
+				start = BenchClock::now();
+				unsigned int linearHits = TraceLinear(objects, rays);
+				linearRate = numRays / SecondsSince(start) / 1.0e6;
+				if(linearHits != hits)
+				{
+					printf("hit count mismatch: bvh %u linear %u\n", hits, linearHits);
+					return 1;
+				}
+			}
+
+			printf("%10u %8u %10.2f %14.3f ", numPrimitives, bvh.getNumNodes(), buildSeconds * 1000.0, bvhRate);
+			if(linearRate > 0.0)
+			{
+				printf("%14.3f", linearRate);
+			}
+			else
+			{
+				printf("%14s", "-");
+			}
+			printf(" %8.1f\n", 100.0 * hits / numRays);
+
+			for(unsigned int i = 0; i < objects.size(); ++i)
+			{
+				delete objects[i];
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
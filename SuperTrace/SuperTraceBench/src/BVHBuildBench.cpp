@@ -0,0 +1,67 @@
+//*************************************************************************************************
+// Title: BVHBuildBench.cpp
+// Description: BVH build time and tree quality against primitive count, build threads and SAH bin
+//	count. Build time should fall with threads while the SAH cost stays put, more bins should
+//	lower the SAH cost at some build time.
+//*************************************************************************************************
+#include "Bench.h"
+#include "BVH.h"
+#include "STMath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace SuperTrace
+{
+	/** Measure parallel BVH build time and SAH cost against primitive count, threads and bins
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunBVHBuildBench(int argc, char** argv)
+	{
+		unsigned int maxPrimitives = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 1000000;
+		unsigned int maxThreads = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : std::max(std::thread::hardware_concurrency(), 1u);
+
+		const unsigned int BinCounts[] = { 8, 16, 32 };
+		const unsigned int NumBinCounts = sizeof(BinCounts) / sizeof(BinCounts[0]);
+
+		printf("%10s %8s %6s %10s %10s %8s %6s\n", "prims", "threads", "bins", "build ms", "SAH cost", "leaves", "depth");
+		for(unsigned int numPrimitives = 10000; numPrimitives <= maxPrimitives; numPrimitives *= 10)
+		{
+			// Boxes scattered through a fixed volume, the same set for every configuration
+			SeedRandf(1);
+			std::vector<AABB> bounds;
+			bounds.reserve(numPrimitives);
+			for(unsigned int i = 0; i < numPrimitives; ++i)
+			{
+				Vector3 center(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				Vector3 extent(Randf(0.1f, 1.0f), Randf(0.1f, 1.0f), Randf(0.1f, 1.0f));
+				bounds.push_back(AABB(center - extent, center + extent));
+			}
+
+			for(unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+			{
+				for(unsigned int b = 0; b < NumBinCounts; ++b)
+				{
+					BVH bvh;
+					bvh.setNumBuildThreads(numThreads);
+					bvh.setNumBins(BinCounts[b]);
+					bvh.build(bounds);
+
+					const BVHBuildStats& stats = bvh.getBuildStats();
+					printf("%10u %8u %6u %10.2f %10.2f %8u %6u\n", numPrimitives, numThreads, BinCounts[b],
+						stats.buildSeconds * 1000.0, stats.sahCost, stats.numLeaves, stats.maxDepth);
+				}
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
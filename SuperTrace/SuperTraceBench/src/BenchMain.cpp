@@ -0,0 +1,80 @@
+//*************************************************************************************************
+// Title: BenchMain.cpp
+// Description: Command line entry point for the benchmarks, runs the suite named by the first
+//	argument or every suite when none is given.
+//*************************************************************************************************
+#include "Bench.h"
+#include <stdio.h>
+#include <string.h>
+
+using namespace SuperTrace;
+
+namespace
+{
+	typedef int (*SuiteFunction)(int argc, char** argv);
+
+	/** A named benchmark suite
+	*/
+	struct Suite
+	{
+		const char* name;
+		const char* description;
+		SuiteFunction run;
+	};
+
+	const Suite Suites[] =
+	{
+		{ "queue", "MPMC queue push/pop throughput and a work-stealing deque check, args: [pairs]", RunQueueBench },
+		{ "bvh", "BVH closest hit rays/s against primitive count, args: [maxPrims] [rays]", RunBVHBench },
+		{ "bvhbuild", "BVH build ms and SAH cost against prims, threads and bins, args: [maxPrims] [maxThreads]", RunBVHBuildBench },
+		{ "shadow", "Any hit against closest hit occlusion rays/s, args: [maxPrims] [rays]", RunShadowBench },
+		{ "math", "Vector and matrix kernel ns/op out of line, scalar and SIMD, args: [iterations]", RunMathBench },
+		{ "packet", "Primary visibility Mrays/s for single rays against ray packets, args: [maxPrims] [width]", RunPacketBench },
+		{ "spheres", "SphereSet closest hit Mrays/s and bytes per sphere against Sphere objects, args: [maxSpheres] [rays]", RunSphereSetBench },
+		{ "scaling", "Frame ms against trace workers, direct frame buffer writes against tile buffers, args: [maxWorkers] [tileSize] [width]", RunScalingBench },
+		{ "scenes", "Standard scenes through the full renderer, setup, first tile and frame ms with primary Mrays/s, written as JSON, args: [width] [json] [workers]", RunSceneBench },
+		{ "kernels", "Sphere, Box3, SolveQuadratic, camera ray, point light and transform ns/op and ops/cycle on hit and miss heavy data, args: [rays] [passes]", RunKernelBench },
+		{ "scenesize", "Generated scenes from 1000 primitives up, generate, BVH, setup, trace and frame ms per layout, args: [maxPrims] [particles|spheres|boxes] [width] [workers]", RunSceneSizeBench },
+		{ "random", "Per pixel random numbers checked identical across threads, Mdraws/s against threads, args: [width] [samples] [maxThreads]", RunRandomBench },
+	};
+
+	const unsigned int NumSuites = sizeof(Suites) / sizeof(Suites[0]);
+
+	void PrintUsage()
+	{
+		printf("usage: SuperTraceBench [suite [args...]]\n");
+		for(unsigned int i = 0; i < NumSuites; ++i)
+		{
+			printf("  %-12s %s\n", Suites[i].name, Suites[i].description);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		// No suite named, run all of them with their defaults
+		int result = 0;
+		for(unsigned int i = 0; i < NumSuites; ++i)
+		{
+			printf("== %s ==\n", Suites[i].name);
+			if(Suites[i].run(0, 0) != 0)
+			{
+				result = 1;
+			}
+		}
+		return result;
+	}
+
+	for(unsigned int i = 0; i < NumSuites; ++i)
+	{
+		if(strcmp(argv[1], Suites[i].name) == 0)
+		{
+			return Suites[i].run(argc - 2, argv + 2);
+		}
+	}
+
+	PrintUsage();
+	return 1;
+}
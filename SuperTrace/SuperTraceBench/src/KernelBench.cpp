@@ -0,0 +1,719 @@
+//*************************************************************************************************
+// Title: KernelBench.cpp
+// Description: Time per call of the hot kernels the renderer runs for every ray, each driven over
+//	large pre-generated sets of rays that mostly hit and rays that mostly miss. Alternative forms
+//	of a kernel run in the same pass on the same data, and are checked against the form the
+//	renderer uses before anything is timed.
+//*************************************************************************************************
+#include "Bench.h"
+#include "Box3.h"
+#include "Camera.h"
+#include "HitRecord.h"
+#include "Material.h"
+#include "PointLight.h"
+#include "RayPacket.h"
+#include "Scene.h"
+#include "Sphere.h"
+#include "STMath.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define ST_BENCH_CYCLES
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ST_BENCH_CYCLES
+#endif
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// The sphere and box sit in front of the camera at this depth
+		const float TargetDepth = 10.0f;
+
+		// Half the width of the square the rays aim at, as a multiple of the primitive's radius;
+		// 0.7 puts nearly every ray through the primitive, 10 puts about one in a hundred through it
+		const float HitSpread = 0.7f;
+		const float MissSpread = 10.0f;
+
+		/** Read the processor's time stamp counter, 0 where there is none
+		*/
+		unsigned long long ReadCycles()
+		{
+#ifdef ST_BENCH_CYCLES
+			return __rdtsc();
+#else
+			return 0;
+#endif
+		}
+
+		/** Rays aimed at a square around the primitives, in the forms the kernels take
+		*/
+		struct RaySet
+		{
+			std::vector<Ray> rays;
+			std::vector<RayPacket> packets;
+		};
+
+		/** Everything the kernels run against
+		*/
+		struct KernelData
+		{
+			KernelData()
+				:	sphere(0), box(0), radius(0.0f), width(0), height(0), frontLight(0), backLight(0)
+			{ }
+
+			Scene scene;
+			Sphere* sphere;
+			Box3* box;
+			Vector3 center;
+			float radius;
+			Camera camera;
+			unsigned int width;
+			unsigned int height;
+			PointLight* frontLight;
+			PointLight* backLight;
+			Matrix44 transform;
+
+			RaySet hitSet;
+			RaySet missSet;
+
+			// The first hits of the hit set on the sphere, shaded by the lights
+			std::vector<Ray> shadeRays;
+			std::vector<HitRecord> shadeHits;
+		};
+
+		/** A timed loop over one data set
+		* @return
+		*	float A value computed from every result, so nothing can be optimized away
+		*/
+		typedef float (*KernelLoop)(KernelData& data, const RaySet& set, unsigned int& numHits);
+
+		/** Keeps the results of timed loops alive
+		*/
+		volatile float Sink;
+
+		/** Sphere intersection in its geometric form, projecting the center onto the ray instead
+		*	of solving the quadratic, fills the same hit fields as Sphere::intersect
+		*/
+		bool IntersectSphereGeometric(const Vector3& center, float radius, const Ray& ray, HitRecord& hit)
+		{
+			// Assumes a normalized direction, which every ray the renderer makes has
+			Vector3 L = center - ray.getOrigin();
+			float tca = L.dot(ray.getDirection());
+			float radius2 = radius * radius;
+			float d2 = L.dot(L) - tca * tca;
+			if(d2 > radius2)
+			{
+				return false;
+			}
+
+			float thc = sqrtf(radius2 - d2);
+			float t = tca - thc;
+			if(t < ray.getTMin())
+			{
+				t = tca + thc;
+				if(t < ray.getTMin())
+				{
+					return false;
+				}
+			}
+			if(t >= hit.t)
+			{
+				return false;
+			}
+
+			hit.t = t;
+			hit.normal = (ray(t) - center) / radius;
+			return true;
+		}
+
+		/** The textbook roots of a quadratic, which lose precision when b * b is much larger than
+		*	4 * a * c, kept to weigh against the stable form SolveQuadratic uses
+		*/
+		bool SolveQuadraticTextbook(float a, float b, float c, float& x0, float& x1)
+		{
+			float disc = b * b - 4.0f * a * c;
+			if(disc < 0.0f)
+			{
+				return false;
+			}
+
+			float root = sqrtf(disc);
+			float inv2a = 0.5f / a;
+			x0 = (-b - root) * inv2a;
+			x1 = (-b + root) * inv2a;
+			if(x0 > x1)
+			{
+				std::swap(x0, x1);
+			}
+			return true;
+		}
+
+		/** Transform a direction by adding up the rows of the upper 3x3, the matrix rows fetched
+		*	as vectors instead of element by element
+		*/
+		Vector3 TransformByRows(const Vector3& v, const Vector3& row0, const Vector3& row1, const Vector3& row2)
+		{
+			return row0 * v.getX() + row1 * v.getY() + row2 * v.getZ();
+		}
+
+		/** The quadratic the sphere test solves for a ray
+		*/
+		void SphereQuadratic(const Vector3& center, float radius, const Ray& ray, float& a, float& b, float& c)
+		{
+			Vector3 L = ray.getOrigin() - center;
+			a = ray.getDirection().dot(ray.getDirection());
+			b = 2.0f * ray.getDirection().dot(L);
+			c = L.dot(L) - radius * radius;
+		}
+
+		float SphereIntersect(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				HitRecord hit;
+				if(data.sphere->intersect(set.rays[i], hit) == true)
+				{
+					++numHits;
+					sum += hit.t;
+				}
+			}
+			return sum;
+		}
+
+		float SphereGeometric(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				HitRecord hit;
+				if(IntersectSphereGeometric(data.center, data.radius, set.rays[i], hit) == true)
+				{
+					++numHits;
+					sum += hit.t;
+				}
+			}
+			return sum;
+		}
+
+		float SpherePacket(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			HitPacket hits;
+			for(size_t i = 0; i < set.packets.size(); ++i)
+			{
+				const RayPacket& packet = set.packets[i];
+				hits.reset(packet);
+				unsigned int mask = data.sphere->intersectPacket(packet, packet.getActiveMask(), hits);
+				for(unsigned int lane = 0; lane < packet.count; ++lane)
+				{
+					if((mask & (1u << lane)) != 0)
+					{
+						++numHits;
+						sum += hits.t[lane];
+					}
+				}
+			}
+			return sum;
+		}
+
+		float BoxIntersect(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				HitRecord hit;
+				if(data.box->intersect(set.rays[i], hit) == true)
+				{
+					++numHits;
+					sum += hit.t;
+				}
+			}
+			return sum;
+		}
+
+		float BoxPacket(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			HitPacket hits;
+			for(size_t i = 0; i < set.packets.size(); ++i)
+			{
+				const RayPacket& packet = set.packets[i];
+				hits.reset(packet);
+				unsigned int mask = data.box->intersectPacket(packet, packet.getActiveMask(), hits);
+				for(unsigned int lane = 0; lane < packet.count; ++lane)
+				{
+					if((mask & (1u << lane)) != 0)
+					{
+						++numHits;
+						sum += hits.t[lane];
+					}
+				}
+			}
+			return sum;
+		}
+
+		/** The quadratic loops solve for the same rays as the sphere test, the coefficients are
+		*	worked out inside the loop as they are in the sphere test
+		*/
+		template <bool (*Solve)(float, float, float, float&, float&)>
+		float Quadratic(KernelData& data, const RaySet& set, unsigned int& numHits)
+		{
+			float sum = 0.0f;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				float a, b, c, x0, x1;
+				SphereQuadratic(data.center, data.radius, set.rays[i], a, b, c);
+				if(Solve(a, b, c, x0, x1) == true)
+				{
+					++numHits;
+					sum += x0;
+				}
+			}
+			return sum;
+		}
+
+		float CameraRasterToRay(KernelData& data, const RaySet&, unsigned int&)
+		{
+			float sum = 0.0f;
+			for(unsigned int y = 0; y < data.height; ++y)
+			{
+				for(unsigned int x = 0; x < data.width; ++x)
+				{
+					sum += data.camera.rasterToRay(x, y).getDirection().getX();
+				}
+			}
+			return sum;
+		}
+
+		float CameraGenerateRays(KernelData& data, const RaySet&, unsigned int&)
+		{
+			unsigned int width = data.width;
+			std::vector<Vector3> origins(width);
+			std::vector<Vector3> directions(width);
+			float sum = 0.0f;
+			for(unsigned int y = 0; y < data.height; ++y)
+			{
+				data.camera.generateRays(0, y, width, 1, &origins[0], &directions[0]);
+				for(unsigned int x = 0; x < width; ++x)
+				{
+					sum += directions[x].getX();
+				}
+			}
+			return sum;
+		}
+
+		float CameraGeneratePacket(KernelData& data, const RaySet&, unsigned int&)
+		{
+			unsigned int width = data.width;
+			RayPacket packet;
+			float sum = 0.0f;
+			for(unsigned int y = 0; y < data.height; ++y)
+			{
+				for(unsigned int x = 0; x < width; x += PacketWidth)
+				{
+					unsigned int count = width - x < PacketWidth ? width - x : PacketWidth;
+					data.camera.generatePacket(x, y, count, packet);
+					for(unsigned int lane = 0; lane < count; ++lane)
+					{
+						sum += packet.directionX[lane];
+					}
+				}
+			}
+			return sum;
+		}
+
+		/** Shade the sphere hits with one light
+		*/
+		float ComputeLight(const KernelData& data, const PointLight& light)
+		{
+			RayStats stats;
+			float sum = 0.0f;
+			for(size_t i = 0; i < data.shadeHits.size(); ++i)
+			{
+				Color color = light.compute(data.scene, data.shadeHits[i], data.shadeRays[i], stats);
+				sum += color.r;
+			}
+			return sum;
+		}
+
+		float PointLightFront(KernelData& data, const RaySet&, unsigned int&)
+		{
+			return ComputeLight(data, *data.frontLight);
+		}
+
+		float PointLightBack(KernelData& data, const RaySet&, unsigned int&)
+		{
+			return ComputeLight(data, *data.backLight);
+		}
+
+		float Transform(KernelData& data, const RaySet& set, unsigned int&)
+		{
+			Vector3 sum;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				sum += Vector3Transform(set.rays[i].getDirection(), data.transform);
+			}
+			return sum.getX() + sum.getY() + sum.getZ();
+		}
+
+		float TransformRows(KernelData& data, const RaySet& set, unsigned int&)
+		{
+			const Matrix44& m = data.transform;
+			Vector3 row0(m(0, 0), m(0, 1), m(0, 2));
+			Vector3 row1(m(1, 0), m(1, 1), m(1, 2));
+			Vector3 row2(m(2, 0), m(2, 1), m(2, 2));
+
+			Vector3 sum;
+			for(size_t i = 0; i < set.rays.size(); ++i)
+			{
+				sum += TransformByRows(set.rays[i].getDirection(), row0, row1, row2);
+			}
+			return sum.getX() + sum.getY() + sum.getZ();
+		}
+
+		/** Where a kernel's operations come from
+		*/
+		enum KernelInput
+		{
+			KERNEL_INPUT_HIT_SET = 0,
+			KERNEL_INPUT_MISS_SET,
+			KERNEL_INPUT_PIXELS,
+			KERNEL_INPUT_SHADE_HITS
+		};
+
+		/** One row of the table, a form of a kernel over one input
+		*/
+		struct KernelCase
+		{
+			const char* kernel;
+			const char* form;
+			KernelInput input;
+			const char* inputName;
+			KernelLoop loop;
+		};
+
+		const KernelCase KernelCases[] =
+		{
+			{ "Sphere::intersect", "quadratic", KERNEL_INPUT_HIT_SET, "hit", SphereIntersect },
+			{ "Sphere::intersect", "geometric", KERNEL_INPUT_HIT_SET, "hit", SphereGeometric },
+			{ "Sphere::intersect", "packet", KERNEL_INPUT_HIT_SET, "hit", SpherePacket },
+			{ "Sphere::intersect", "quadratic", KERNEL_INPUT_MISS_SET, "miss", SphereIntersect },
+			{ "Sphere::intersect", "geometric", KERNEL_INPUT_MISS_SET, "miss", SphereGeometric },
+			{ "Sphere::intersect", "packet", KERNEL_INPUT_MISS_SET, "miss", SpherePacket },
+			{ "Box3::intersect", "slabs", KERNEL_INPUT_HIT_SET, "hit", BoxIntersect },
+			{ "Box3::intersect", "packet", KERNEL_INPUT_HIT_SET, "hit", BoxPacket },
+			{ "Box3::intersect", "slabs", KERNEL_INPUT_MISS_SET, "miss", BoxIntersect },
+			{ "Box3::intersect", "packet", KERNEL_INPUT_MISS_SET, "miss", BoxPacket },
+			{ "SolveQuadratic", "stable", KERNEL_INPUT_HIT_SET, "hit", Quadratic<SolveQuadratic> },
+			{ "SolveQuadratic", "textbook", KERNEL_INPUT_HIT_SET, "hit", Quadratic<SolveQuadraticTextbook> },
+			{ "SolveQuadratic", "stable", KERNEL_INPUT_MISS_SET, "miss", Quadratic<SolveQuadratic> },
+			{ "SolveQuadratic", "textbook", KERNEL_INPUT_MISS_SET, "miss", Quadratic<SolveQuadraticTextbook> },
+			{ "Camera::rasterToRay", "per pixel", KERNEL_INPUT_PIXELS, "pixels", CameraRasterToRay },
+			{ "Camera::rasterToRay", "generateRays", KERNEL_INPUT_PIXELS, "pixels", CameraGenerateRays },
+			{ "Camera::rasterToRay", "generatePacket", KERNEL_INPUT_PIXELS, "pixels", CameraGeneratePacket },
+			{ "PointLight::compute", "shadow ray", KERNEL_INPUT_SHADE_HITS, "facing", PointLightFront },
+			{ "PointLight::compute", "no shadow ray", KERNEL_INPUT_SHADE_HITS, "behind", PointLightBack },
+			{ "Vector3Transform", "elements", KERNEL_INPUT_HIT_SET, "dirs", Transform },
+			{ "Vector3Transform", "rows", KERNEL_INPUT_HIT_SET, "dirs", TransformRows },
+		};
+
+		/** Aim rays from around the camera at a square around the primitives
+		* @param
+		*	spread Half the width of the square as a multiple of the primitive's radius
+		*/
+		void MakeRaySet(const KernelData& data, unsigned int count, float spread, RaySet& set)
+		{
+			set.rays.reserve(count);
+			set.packets.resize((count + PacketWidth - 1) / PacketWidth);
+			for(unsigned int i = 0; i < count; ++i)
+			{
+				Vector3 origin(Randf(-0.1f, 0.1f), Randf(-0.1f, 0.1f), 0.0f);
+				Vector3 target = data.center + Vector3(Randf(-spread, spread), Randf(-spread, spread), 0.0f) * data.radius;
+				Vector3 direction = target - origin;
+				direction.normalize();
+				set.rays.push_back(Ray(origin, direction, RAY_TYPE_CAMERA));
+
+				RayPacket& packet = set.packets[i / PacketWidth];
+				packet.setRay(packet.count, origin, direction);
+				++packet.count;
+			}
+		}
+
+		/** Build the scene, camera, lights and data sets
+		*/
+		void MakeData(unsigned int count, KernelData& data)
+		{
+			Matrix44 identity;
+			identity.setIdentity();
+			Material material(Vector4(0.2f, 0.2f, 0.2f, 1.0f), Vector4(0.8f, 0.6f, 0.4f, 1.0f), Vector4(0.5f, 0.5f, 0.5f, 8.0f));
+
+			data.center = Vector3(0.0f, 0.0f, TargetDepth);
+			data.radius = 1.0f;
+			data.sphere = data.scene.getArena().create<Sphere>(identity, data.center, data.radius);
+			data.sphere->setMaterial(material);
+			data.box = data.scene.getArena().create<Box3>(identity, data.center - Vector3(1.0f, 1.0f, 1.0f), data.center + Vector3(1.0f, 1.0f, 1.0f));
+			data.box->setMaterial(material);
+
+			// Shadow rays from the lit side of the sphere are tested against the sphere itself
+			data.scene.addObject(data.sphere);
+			data.scene.buildAccelerationStructure();
+
+			Vector4 color(0.5f, 0.5f, 0.5f, 1.0f);
+			data.frontLight = data.scene.getArena().create<PointLight>(Vector3(2.0f, 3.0f, 0.0f), Vector3(1.0f, 0.01f, 0.0f), 1000.0f, color, color, color);
+			data.backLight = data.scene.getArena().create<PointLight>(Vector3(0.0f, 0.0f, TargetDepth * 2.0f), Vector3(1.0f, 0.01f, 0.0f), 1000.0f, color, color, color);
+
+			// About as many pixels as there are rays in a set, at 4:3
+			data.width = static_cast<unsigned int>(sqrtf(count * 4.0f / 3.0f));
+			data.width = data.width > 4 ? data.width : 4;
+			data.height = data.width * 3 / 4;
+			data.camera = Camera(data.width, data.height, tanf(30.0f * 3.14159265f / 180.0f));
+
+			data.transform = Matrix44RotationY(0.7f) * Matrix44RotationX(0.3f) * Matrix44Translation(1.0f, 2.0f, 3.0f);
+
+			MakeRaySet(data, count, HitSpread, data.hitSet);
+			MakeRaySet(data, count, MissSpread, data.missSet);
+
+			for(size_t i = 0; i < data.hitSet.rays.size(); ++i)
+			{
+				HitRecord hit;
+				if(data.sphere->intersect(data.hitSet.rays[i], hit) == true)
+				{
+					data.shadeRays.push_back(data.hitSet.rays[i]);
+					data.shadeHits.push_back(hit);
+				}
+			}
+		}
+
+		/** Check whether two values agree to within a relative tolerance
+		*/
+		bool Agree(float x, float y, float tolerance)
+		{
+			float scale = fabsf(x) > 1.0f ? fabsf(x) : 1.0f;
+			return fabsf(x - y) <= tolerance * scale;
+		}
+
+		/** Check the alternative forms against the forms the renderer uses
+		* @return
+		*	bool True if everything agrees
+		*/
+		bool CheckKernels(KernelData& data)
+		{
+			const float Tolerance = 1.0e-3f;
+			const RaySet* sets[2] = { &data.hitSet, &data.missSet };
+			for(unsigned int s = 0; s < 2; ++s)
+			{
+				const RaySet& set = *sets[s];
+
+				// Rays that graze the sphere can fall either side of it depending on rounding, a few
+				// in a million are let through
+				unsigned int numGrazing = 0;
+				for(size_t i = 0; i < set.rays.size(); ++i)
+				{
+					const Ray& ray = set.rays[i];
+					const RayPacket& packet = set.packets[i / PacketWidth];
+					unsigned int lane = static_cast<unsigned int>(i % PacketWidth);
+
+					HitRecord quadratic;
+					HitRecord geometric;
+					bool quadraticHit = data.sphere->intersect(ray, quadratic);
+					bool geometricHit = IntersectSphereGeometric(data.center, data.radius, ray, geometric);
+					if(quadraticHit != geometricHit)
+					{
+						++numGrazing;
+					}
+					else if(quadraticHit == true && Agree(quadratic.t, geometric.t, Tolerance) == false)
+					{
+						printf("sphere geometric mismatch at %u: %g %g\n", static_cast<unsigned int>(i), quadratic.t, geometric.t);
+						return false;
+					}
+
+					HitPacket hits;
+					hits.reset(packet);
+					bool packetHit = (data.sphere->intersectPacket(packet, 1u << lane, hits) & (1u << lane)) != 0;
+					if(packetHit != quadraticHit || (packetHit == true && Agree(quadratic.t, hits.t[lane], Tolerance) == false))
+					{
+						printf("sphere packet mismatch at %u\n", static_cast<unsigned int>(i));
+						return false;
+					}
+
+					HitRecord slabs;
+					bool slabsHit = data.box->intersect(ray, slabs);
+					hits.reset(packet);
+					packetHit = (data.box->intersectPacket(packet, 1u << lane, hits) & (1u << lane)) != 0;
+					if(packetHit != slabsHit || (packetHit == true && Agree(slabs.t, hits.t[lane], Tolerance) == false))
+					{
+						printf("box packet mismatch at %u\n", static_cast<unsigned int>(i));
+						return false;
+					}
+
+					// A solver that finds no roots leaves them untouched, they are printed either way
+					float a, b, c;
+					float s0 = 0.0f, s1 = 0.0f, t0 = 0.0f, t1 = 0.0f;
+					SphereQuadratic(data.center, data.radius, ray, a, b, c);
+					bool stable = SolveQuadratic(a, b, c, s0, s1);
+					bool textbook = SolveQuadraticTextbook(a, b, c, t0, t1);
+					if(stable != textbook || (stable == true && (Agree(s0, t0, Tolerance) == false || Agree(s1, t1, Tolerance) == false)))
+					{
+						printf("quadratic mismatch at %u: %g %g against %g %g\n", static_cast<unsigned int>(i), s0, s1, t0, t1);
+						return false;
+					}
+
+					Vector3 elements = Vector3Transform(ray.getDirection(), data.transform);
+					const Matrix44& m = data.transform;
+					Vector3 rows = TransformByRows(ray.getDirection(), Vector3(m(0, 0), m(0, 1), m(0, 2)), Vector3(m(1, 0), m(1, 1), m(1, 2)),
+						Vector3(m(2, 0), m(2, 1), m(2, 2)));
+					if(Agree(elements.getX(), rows.getX(), Tolerance) == false || Agree(elements.getY(), rows.getY(), Tolerance) == false ||
+						Agree(elements.getZ(), rows.getZ(), Tolerance) == false)
+					{
+						printf("transform mismatch at %u\n", static_cast<unsigned int>(i));
+						return false;
+					}
+				}
+
+				if(numGrazing * 100000 > set.rays.size())
+				{
+					printf("sphere geometric disagrees on %u rays\n", numGrazing);
+					return false;
+				}
+			}
+
+			// Every way of making camera rays gives the same rays
+			unsigned int width = data.width;
+			std::vector<Vector3> origins(width);
+			std::vector<Vector3> directions(width);
+			RayPacket packet;
+			for(unsigned int y = 0; y < data.height; y += 7)
+			{
+				data.camera.generateRays(0, y, width, 1, &origins[0], &directions[0]);
+				for(unsigned int x = 0; x < width; ++x)
+				{
+					Ray ray = data.camera.rasterToRay(x, y);
+					if((x % PacketWidth) == 0)
+					{
+						data.camera.generatePacket(x, y, width - x < PacketWidth ? width - x : PacketWidth, packet);
+					}
+					unsigned int lane = x % PacketWidth;
+					if(Agree(ray.getDirection().getX(), directions[x].getX(), Tolerance) == false ||
+						Agree(ray.getDirection().getY(), directions[x].getY(), Tolerance) == false ||
+						Agree(ray.getDirection().getX(), packet.directionX[lane], Tolerance) == false ||
+						Agree(ray.getDirection().getY(), packet.directionY[lane], Tolerance) == false)
+					{
+						printf("camera ray mismatch at %u %u\n", x, y);
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/** Get the operations a loop performs on an input
+		*/
+		unsigned int CountOps(const KernelData& data, KernelInput input)
+		{
+			switch(input)
+			{
+			case KERNEL_INPUT_HIT_SET:
+				return static_cast<unsigned int>(data.hitSet.rays.size());
+			case KERNEL_INPUT_MISS_SET:
+				return static_cast<unsigned int>(data.missSet.rays.size());
+			case KERNEL_INPUT_PIXELS:
+				return data.width * data.height;
+			case KERNEL_INPUT_SHADE_HITS:
+				return static_cast<unsigned int>(data.shadeHits.size());
+			default:
+				return 0;
+			}
+		}
+	}
+
+	/** Measure the hot kernels over hit-heavy and miss-heavy data, with alternatives side by side
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunKernelBench(int argc, char** argv)
+	{
+		unsigned int count = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 1 << 18;
+		unsigned int iterations = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 10;
+		count = count > PacketWidth ? count : PacketWidth;
+		iterations = iterations > 0 ? iterations : 1;
+
+		SeedRandf(1);
+		KernelData data;
+		MakeData(count, data);
+
+		if(CheckKernels(data) == false)
+		{
+			return 1;
+		}
+
+		printf("%u rays per set, %ux%u pixels, %u shaded hits, best of %u passes\n", count, data.width, data.height,
+			static_cast<unsigned int>(data.shadeHits.size()), iterations);
+#ifndef ST_BENCH_CYCLES
+		printf("no cycle counter on this target, ops/cycle is not measured\n");
+#endif
+		printf("%-20s %-15s %-7s %8s %10s %10s\n", "kernel", "form", "input", "hit %", "ns/op", "ops/cycle");
+
+		const unsigned int numCases = sizeof(KernelCases) / sizeof(KernelCases[0]);
+		for(unsigned int i = 0; i < numCases; ++i)
+		{
+			const KernelCase& kernel = KernelCases[i];
+			const RaySet& set = kernel.input == KERNEL_INPUT_MISS_SET ? data.missSet : data.hitSet;
+			unsigned int numOps = CountOps(data, kernel.input);
+
+			// Warm the caches, and count the hits once
+			unsigned int numHits = 0;
+			Sink = kernel.loop(data, set, numHits);
+
+			double bestSeconds = 0.0;
+			unsigned long long bestCycles = 0;
+			for(unsigned int pass = 0; pass < iterations; ++pass)
+			{
+				unsigned int passHits = 0;
+				unsigned long long startCycles = ReadCycles();
+				BenchClock::time_point start = BenchClock::now();
+				Sink = kernel.loop(data, set, passHits);
+				double seconds = SecondsSince(start);
+				unsigned long long cycles = ReadCycles() - startCycles;
+				if(pass == 0 || seconds < bestSeconds)
+				{
+					bestSeconds = seconds;
+					bestCycles = cycles;
+				}
+			}
+
+			double nsPerOp = bestSeconds * 1.0e9 / numOps;
+			bool countsHits = kernel.input == KERNEL_INPUT_HIT_SET || kernel.input == KERNEL_INPUT_MISS_SET;
+			if(countsHits == true && numHits > 0)
+			{
+				printf("%-20s %-15s %-7s %8.1f", kernel.kernel, kernel.form, kernel.inputName, 100.0 * numHits / numOps);
+			}
+			else
+			{
+				printf("%-20s %-15s %-7s %8s", kernel.kernel, kernel.form, kernel.inputName, "-");
+			}
+			if(bestCycles > 0)
+			{
+				printf(" %10.2f %10.3f\n", nsPerOp, static_cast<double>(numOps) / bestCycles);
+			}
+			else
+			{
+				printf(" %10.2f %10s\n", nsPerOp, "-");
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
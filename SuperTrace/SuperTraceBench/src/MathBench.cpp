@@ -0,0 +1,390 @@
+//*************************************************************************************************
+// Title: MathBench.cpp
+// Description: Time per call of the vector and matrix kernels, called out of line the way the
+//	math classes used to be, inlined in their scalar form and inlined in the form the classes use.
+//	The forms are checked against each other before anything is timed.
+//*************************************************************************************************
+#include "Bench.h"
+#include "MathKernels.h"
+#include "STMath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Inputs and outputs of the kernels, four floats per vector and sixteen per matrix
+		*/
+		struct MathData
+		{
+			std::vector<float> a;
+			std::vector<float> b;
+			std::vector<float> r;
+			std::vector<float> m;
+			std::vector<float> mr;
+			unsigned int count;
+		};
+
+		/** The scalar kernels, inlined
+		*/
+		struct ScalarKernels
+		{
+			static float Dot3(const float* a, const float* b) { return ScalarMath::Dot3(a, b); }
+			static void Cross3(const float* a, const float* b, float* r) { ScalarMath::Cross3(a, b, r); }
+			static void Normalize3(float* v) { ScalarMath::Normalize3(v); }
+			static float Dot4(const float* a, const float* b) { return ScalarMath::Dot4(a, b); }
+			static void Normalize4(float* v) { ScalarMath::Normalize4(v); }
+			static void MultiplyMatrix44(const float* a, const float* b, float* r) { ScalarMath::MultiplyMatrix44(a, b, r); }
+			static float InverseMatrix44(const float* m, float* r) { return ScalarMath::InverseMatrix44(m, r); }
+		};
+
+		/** The kernels the math classes use, inlined
+		*/
+		struct ClassKernels
+		{
+			static float Dot3(const float* a, const float* b) { return MathKernels::Dot3(a, b); }
+			static void Cross3(const float* a, const float* b, float* r) { MathKernels::Cross3(a, b, r); }
+			static void Normalize3(float* v) { MathKernels::Normalize3(v); }
+			static float Dot4(const float* a, const float* b) { return MathKernels::Dot4(a, b); }
+			static void Normalize4(float* v) { MathKernels::Normalize4(v); }
+			static void MultiplyMatrix44(const float* a, const float* b, float* r) { MathKernels::MultiplyMatrix44(a, b, r); }
+			static float InverseMatrix44(const float* m, float* r) { return MathKernels::InverseMatrix44(m, r); }
+		};
+
+		/** The scalar kernels behind pointers the compiler cannot see through, standing in for the
+		*	calls into another translation unit the classes made before they were inlined
+		*/
+		float (* volatile OutOfLineDot3)(const float*, const float*) = ScalarMath::Dot3;
+		void (* volatile OutOfLineCross3)(const float*, const float*, float*) = ScalarMath::Cross3;
+		void (* volatile OutOfLineNormalize3)(float*) = ScalarMath::Normalize3;
+		float (* volatile OutOfLineDot4)(const float*, const float*) = ScalarMath::Dot4;
+		void (* volatile OutOfLineNormalize4)(float*) = ScalarMath::Normalize4;
+		void (* volatile OutOfLineMultiplyMatrix44)(const float*, const float*, float*) = ScalarMath::MultiplyMatrix44;
+		float (* volatile OutOfLineInverseMatrix44)(const float*, float*) = ScalarMath::InverseMatrix44;
+
+		struct OutOfLineKernels
+		{
+			static float Dot3(const float* a, const float* b) { return OutOfLineDot3(a, b); }
+			static void Cross3(const float* a, const float* b, float* r) { OutOfLineCross3(a, b, r); }
+			static void Normalize3(float* v) { OutOfLineNormalize3(v); }
+			static float Dot4(const float* a, const float* b) { return OutOfLineDot4(a, b); }
+			static void Normalize4(float* v) { OutOfLineNormalize4(v); }
+			static void MultiplyMatrix44(const float* a, const float* b, float* r) { OutOfLineMultiplyMatrix44(a, b, r); }
+			static float InverseMatrix44(const float* m, float* r) { return OutOfLineInverseMatrix44(m, r); }
+		};
+
+		/** The benchmarked operations
+		*/
+		enum MathOp
+		{
+			MATH_OP_DOT3 = 0,
+			MATH_OP_CROSS3,
+			MATH_OP_NORMALIZE3,
+			MATH_OP_DOT4,
+			MATH_OP_NORMALIZE4,
+			MATH_OP_MULTIPLY44,
+			MATH_OP_INVERSE44,
+			NUM_MATH_OPS
+		};
+
+		const char* MathOpNames[NUM_MATH_OPS] = { "dot3", "cross3", "normalize3", "dot4", "normalize4", "mul44", "inverse44" };
+
+		/** Keeps the results of timed loops alive
+		*/
+		volatile float Sink;
+
+		/** Fill the inputs, vectors with a zero fourth component like Vector3 and matrices with a
+		*	heavy diagonal so they are comfortably invertible
+		*/
+		void MakeData(unsigned int count, MathData& data)
+		{
+			data.count = count;
+			data.a.resize(count * 4);
+			data.b.resize(count * 4);
+			data.r.resize(count * 4);
+			data.m.resize(count * 16);
+			data.mr.resize(count * 16);
+			for(unsigned int i = 0; i < count * 4; ++i)
+			{
+				data.a[i] = (i & 3) == 3 ? 0.0f : Randf(-10.0f, 10.0f);
+				data.b[i] = (i & 3) == 3 ? 0.0f : Randf(-10.0f, 10.0f);
+			}
+			for(unsigned int i = 0; i < count * 16; ++i)
+			{
+				data.m[i] = Randf(-1.0f, 1.0f) + (((i & 15) % 5) == 0 ? 4.0f : 0.0f);
+			}
+		}
+
+		/** Run one operation over all of the data
+		*/
+		template <typename Kernels>
+		float RunOp(MathOp op, MathData& data)
+		{
+			const float* a = &data.a[0];
+			const float* b = &data.b[0];
+			float* r = &data.r[0];
+			const float* m = &data.m[0];
+			float* mr = &data.mr[0];
+			unsigned int count = data.count;
+			float sum = 0.0f;
+
+			switch(op)
+			{
+			case MATH_OP_DOT3:
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					sum += Kernels::Dot3(a + i * 4, b + i * 4);
+				}
+				break;
+			case MATH_OP_CROSS3:
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					Kernels::Cross3(a + i * 4, b + i * 4, r + i * 4);
+				}
+				break;
+			case MATH_OP_NORMALIZE3:
+				for(unsigned int i = 0; i < count * 4; ++i)
+				{
+					r[i] = a[i];
+				}
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					Kernels::Normalize3(r + i * 4);
+				}
+				break;
+			case MATH_OP_DOT4:
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					sum += Kernels::Dot4(a + i * 4, b + i * 4);
+				}
+				break;
+			case MATH_OP_NORMALIZE4:
+				for(unsigned int i = 0; i < count * 4; ++i)
+				{
+					r[i] = b[i] + 1.0f;
+				}
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					Kernels::Normalize4(r + i * 4);
+				}
+				break;
+			case MATH_OP_MULTIPLY44:
+				for(unsigned int i = 0; i + 1 < count; ++i)
+				{
+					Kernels::MultiplyMatrix44(m + i * 16, m + (i + 1) * 16, mr + i * 16);
+				}
+				break;
+			case MATH_OP_INVERSE44:
+				for(unsigned int i = 0; i < count; ++i)
+				{
+					sum += Kernels::InverseMatrix44(m + i * 16, mr + i * 16);
+				}
+				break;
+			default:
+				break;
+			}
+
+			return sum + r[0] + mr[0];
+		}
+
+		/** Time an operation
+		* @return
+		*	double Nanoseconds per call
+		*/
+		template <typename Kernels>
+		double TimeOp(MathOp op, MathData& data, unsigned int iterations)
+		{
+			// Warm the caches before timing
+			Sink = RunOp<Kernels>(op, data);
+
+			BenchClock::time_point start = BenchClock::now();
+			for(unsigned int i = 0; i < iterations; ++i)
+			{
+				Sink = RunOp<Kernels>(op, data);
+			}
+			return SecondsSince(start) * 1.0e9 / (static_cast<double>(iterations) * data.count);
+		}
+
+		/** Check whether two arrays agree to within a relative tolerance
+		*/
+		bool Agree(const float* x, const float* y, unsigned int n, float tolerance)
+		{
+			for(unsigned int i = 0; i < n; ++i)
+			{
+				float scale = fabsf(x[i]) > 1.0f ? fabsf(x[i]) : 1.0f;
+				if(fabsf(x[i] - y[i]) > tolerance * scale)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/** Check the kernels the classes use against the scalar ones, and the inverses against the
+		*	identity
+		* @return
+		*	bool True if everything agrees
+		*/
+		bool CheckKernels(const MathData& data)
+		{
+			const float Tolerance = 1.0e-4f;
+			for(unsigned int i = 0; i < data.count; ++i)
+			{
+				const float* a = &data.a[i * 4];
+				const float* b = &data.b[i * 4];
+				const float* m = &data.m[i * 16];
+
+				float s = ScalarMath::Dot3(a, b);
+				float k = MathKernels::Dot3(a, b);
+				if(Agree(&s, &k, 1, Tolerance) == false)
+				{
+					printf("dot3 mismatch at %u: %g %g\n", i, s, k);
+					return false;
+				}
+				s = ScalarMath::Dot4(a, b);
+				k = MathKernels::Dot4(a, b);
+				if(Agree(&s, &k, 1, Tolerance) == false)
+				{
+					printf("dot4 mismatch at %u: %g %g\n", i, s, k);
+					return false;
+				}
+
+				float sv[4], kv[4];
+				ScalarMath::Cross3(a, b, sv);
+				MathKernels::Cross3(a, b, kv);
+				if(Agree(sv, kv, 4, Tolerance) == false)
+				{
+					printf("cross3 mismatch at %u\n", i);
+					return false;
+				}
+				for(unsigned int j = 0; j < 4; ++j)
+				{
+					sv[j] = kv[j] = a[j];
+				}
+				ScalarMath::Normalize3(sv);
+				MathKernels::Normalize3(kv);
+				if(Agree(sv, kv, 4, Tolerance) == false)
+				{
+					printf("normalize3 mismatch at %u\n", i);
+					return false;
+				}
+				for(unsigned int j = 0; j < 4; ++j)
+				{
+					sv[j] = kv[j] = b[j] + 1.0f;
+				}
+				ScalarMath::Normalize4(sv);
+				MathKernels::Normalize4(kv);
+				if(Agree(sv, kv, 4, Tolerance) == false)
+				{
+					printf("normalize4 mismatch at %u\n", i);
+					return false;
+				}
+
+				float sm[16], km[16];
+				const float* n = &data.m[((i + 1) % data.count) * 16];
+				ScalarMath::MultiplyMatrix44(m, n, sm);
+				MathKernels::MultiplyMatrix44(m, n, km);
+				if(Agree(sm, km, 16, Tolerance) == false)
+				{
+					printf("mul44 mismatch at %u\n", i);
+					return false;
+				}
+
+				float sDet = ScalarMath::InverseMatrix44(m, sm);
+				float kDet = MathKernels::InverseMatrix44(m, km);
+				if(Agree(&sDet, &kDet, 1, Tolerance) == false || Agree(sm, km, 16, Tolerance) == false)
+				{
+					printf("inverse44 mismatch at %u\n", i);
+					return false;
+				}
+
+				// The inverse times the matrix should give back the identity
+				MathKernels::MultiplyMatrix44(km, m, km);
+				for(unsigned int j = 0; j < 16; ++j)
+				{
+					float expected = (j % 5) == 0 ? 1.0f : 0.0f;
+					if(fabsf(km[j] - expected) > 1.0e-3f)
+					{
+						printf("inverse44 is not an inverse at %u\n", i);
+						return false;
+					}
+				}
+			}
+
+			// The classes go through the same kernels
+			Matrix44 t = Matrix44RotationY(0.7f) * Matrix44Translation(1.0f, 2.0f, 3.0f);
+			Matrix44 p = t * t.getInverse();
+			Matrix44 q = t;
+			q *= t.getInverse();
+			for(unsigned int row = 0; row < 4; ++row)
+			{
+				for(unsigned int col = 0; col < 4; ++col)
+				{
+					float expected = row == col ? 1.0f : 0.0f;
+					if(fabsf(p(row, col) - expected) > 1.0e-4f || fabsf(q(row, col) - expected) > 1.0e-4f)
+					{
+						printf("Matrix44 inverse check failed\n");
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/** Name the instruction set the class kernels were compiled for
+		*/
+		const char* KernelTarget()
+		{
+#if defined(ST_SIMD_AVX)
+			return "avx";
+#elif defined(ST_SIMD_SSE)
+			return "sse2";
+#else
+			return "scalar";
+#endif
+		}
+	}
+
+	/** Measure the math kernels out of line, inlined scalar and inlined SIMD
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunMathBench(int argc, char** argv)
+	{
+		unsigned int iterations = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 200;
+
+		// Small enough to stay in cache, so the kernels are timed rather than memory
+		const unsigned int Count = 4096;
+
+		SeedRandf(1);
+		MathData data;
+		MakeData(Count, data);
+
+		if(CheckKernels(data) == false)
+		{
+			return 1;
+		}
+
+		printf("class kernels: %s\n", KernelTarget());
+		printf("%12s %14s %14s %14s %10s\n", "kernel", "call ns/op", "scalar ns/op", "class ns/op", "speedup");
+		for(unsigned int op = 0; op < NUM_MATH_OPS; ++op)
+		{
+			MathOp mathOp = static_cast<MathOp>(op);
+			double call = TimeOp<OutOfLineKernels>(mathOp, data, iterations);
+			double scalar = TimeOp<ScalarKernels>(mathOp, data, iterations);
+			double kernels = TimeOp<ClassKernels>(mathOp, data, iterations);
+			printf("%12s %14.2f %14.2f %14.2f %9.2fx\n", MathOpNames[op], call, scalar, kernels, call / kernels);
+		}
+
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,195 @@
+//*************************************************************************************************
+// Title: PacketBench.cpp
+// Description: Primary visibility traced one camera ray at a time against the same rays traced in
+//	packets along each row. Both must find the same surface for every pixel.
+//*************************************************************************************************
+#include "Bench.h"
+#include "BVH.h"
+#include "Box3.h"
+#include "Camera.h"
+#include "HitRecord.h"
+#include "RayPacket.h"
+#include "Sphere.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Find the closest hit for every pixel, one ray at a time
+		*/
+		void TraceSingle(const BVH& bvh, const std::vector<Object*>& objects, const Camera& camera, unsigned int width, unsigned int height, std::vector<HitRecord>& hits)
+		{
+			std::vector<Vector3> origins(width);
+			std::vector<Vector3> directions(width);
+			for(unsigned int y = 0; y < height; ++y)
+			{
+				camera.generateRays(0, y, width, 1, &origins[0], &directions[0]);
+				for(unsigned int x = 0; x < width; ++x)
+				{
+					Ray ray(origins[x], directions[x]);
+					HitRecord& hit = hits[y * width + x];
+					hit = HitRecord(ray.getTMax());
+					bvh.traverse(ray, hit.t, [&](unsigned int index)
+					{
+						if(objects[index]->intersect(ray, hit) == true)
+						{
+							hit.primitive = index;
+						}
+						return false;
+					});
+				}
+			}
+		}
+
+		/** Find the closest hit for every pixel, a packet of neighbouring pixels at a time
+		*/
+		void TracePackets(const BVH& bvh, const std::vector<Object*>& objects, const Camera& camera, unsigned int width, unsigned int height, std::vector<HitRecord>& hits)
+		{
+			RayPacket packet;
+			HitPacket packetHits;
+			for(unsigned int y = 0; y < height; ++y)
+			{
+				for(unsigned int x = 0; x < width; x += PacketWidth)
+				{
+					unsigned int count = std::min(PacketWidth, width - x);
+					camera.generatePacket(x, y, count, packet);
+					packetHits.reset(packet);
+					bvh.traversePacket(packet, packet.getActiveMask(), packetHits.t, [&](unsigned int index, unsigned int mask)
+					{
+						unsigned int updated = objects[index]->intersectPacket(packet, mask, packetHits);
+						for(unsigned int lane = 0; updated != 0; ++lane, updated >>= 1)
+						{
+							if((updated & 1) != 0)
+							{
+								packetHits.primitive[lane] = index;
+							}
+						}
+						return false;
+					});
+
+					for(unsigned int lane = 0; lane < count; ++lane)
+					{
+						hits[y * width + x + lane] = packetHits.getHit(lane);
+					}
+				}
+			}
+		}
+
+		/** Count pixels where the two paths found different surfaces, surfaces at the same distance
+		*	may tie either way. When the compiler fuses the scalar arithmetic into multiply adds a
+		*	few grazing hits along silhouettes can also round the other way.
+		*/
+		unsigned int CountMismatches(const std::vector<HitRecord>& single, const std::vector<HitRecord>& packets)
+		{
+			unsigned int mismatches = 0;
+			for(unsigned int i = 0; i < single.size(); ++i)
+			{
+				const HitRecord& a = single[i];
+				const HitRecord& b = packets[i];
+				if(a.isHit() != b.isHit())
+				{
+					++mismatches;
+				}
+				else if(a.isHit() == true && a.primitive != b.primitive && fabsf(a.t - b.t) > 1.0e-4f * a.t)
+				{
+					++mismatches;
+				}
+			}
+			return mismatches;
+		}
+	}
+
+	/** Measure primary visibility traced in packets against the same rays traced one at a time
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunPacketBench(int argc, char** argv)
+	{
+		unsigned int maxPrimitives = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 100000;
+		unsigned int width = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 1024;
+		unsigned int height = width * 3 / 4;
+
+		SeedRandf(1);
+		Camera camera(width, height, tanf(30.0f * 3.14159265f / 180.0f));
+		std::vector<HitRecord> singleHits(width * height);
+		std::vector<HitRecord> packetHits(width * height);
+
+		Matrix44 identity;
+		identity.setIdentity();
+
+		printf("packets of %u rays, %ux%u pixels\n", PacketWidth, width, height);
+		printf("%10s %16s %16s %8s %10s %8s\n", "prims", "single Mrays/s", "packet Mrays/s", "speedup", "hit %", "differ");
+		for(unsigned int numPrimitives = 100; numPrimitives <= maxPrimitives; numPrimitives *= 10)
+		{
+			// Keep the covered fraction of the view roughly constant as the count grows
+			float size = 8.0f * sqrtf(100.0f / numPrimitives);
+
+			// Half spheres and half boxes, spread through the view frustum
+			std::vector<Object*> objects;
+			std::vector<AABB> bounds;
+			objects.reserve(numPrimitives);
+			bounds.reserve(numPrimitives);
+			for(unsigned int i = 0; i < numPrimitives; ++i)
+			{
+				float z = Randf(20.0f, 120.0f);
+				Vector3 center(Randf(-0.7f, 0.7f) * z, Randf(-0.5f, 0.5f) * z, z);
+				float extent = Randf(0.5f, 1.0f) * size;
+				Object* object = 0;
+				if((i & 1) == 0)
+				{
+					object = new Sphere(identity, center, extent);
+				}
+				else
+				{
+					Vector3 half(extent, extent, extent);
+					object = new Box3(identity, center - half, center + half);
+				}
+				objects.push_back(object);
+				bounds.push_back(object->getBounds());
+			}
+
+			BVH bvh;
+			bvh.build(bounds);
+
+			BenchClock::time_point start = BenchClock::now();
+			TraceSingle(bvh, objects, camera, width, height, singleHits);
+			double singleRate = width * height / SecondsSince(start) / 1.0e6;
+
+			start = BenchClock::now();
+			TracePackets(bvh, objects, camera, width, height, packetHits);
+			double packetRate = width * height / SecondsSince(start) / 1.0e6;
+
+			unsigned int mismatches = CountMismatches(singleHits, packetHits);
+			if(mismatches * 1000 > width * height)
+			{
+				printf("visibility mismatch: %u of %u pixels differ\n", mismatches, width * height);
+				return 1;
+			}
+
+			unsigned int numHits = 0;
+			for(unsigned int i = 0; i < singleHits.size(); ++i)
+			{
+				numHits += singleHits[i].isHit() == true ? 1 : 0;
+			}
+
+			printf("%10u %16.3f %16.3f %8.2f %10.1f %8u\n", numPrimitives, singleRate, packetRate, packetRate / singleRate, 100.0 * numHits / (width * height), mismatches);
+
+			for(unsigned int i = 0; i < objects.size(); ++i)
+			{
+				delete objects[i];
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
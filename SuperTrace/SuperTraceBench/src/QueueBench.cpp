@@ -0,0 +1,254 @@
+//*************************************************************************************************
+// Title: QueueBench.cpp
+// Description: Enqueue/dequeue throughput of the lock-free MPMC ring against a mutex guarded
+//	std::queue, for 1 to 64 threads hammering a single queue, then a check that the worker pool's
+//	work-stealing deque hands every item out exactly once while thieves race its owner.
+//*************************************************************************************************
+#include "Bench.h"
+#include "MPMCQueue.h"
+#include "WorkStealingDeque.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** The locked queue the trace and present stages used before the ring, with the same interface
+		*/
+		template <typename T>
+		class LockedQueue
+		{
+		public:
+			explicit LockedQueue(size_t)
+			{ }
+
+			bool tryPush(const T& value)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_queue.push(value);
+				return true;
+			}
+
+			bool tryPop(T& value)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if(_queue.empty() == true)
+				{
+					return false;
+				}
+				value = _queue.front();
+				_queue.pop();
+				return true;
+			}
+
+		private:
+			std::mutex _mutex;
+			std::queue<T> _queue;
+		};
+
+		/** Run pairs of push/pop operations split across a number of threads
+		* @param
+		*	numThreads The number of threads sharing the queue
+		* @param
+		*	totalPairs The number of push/pop pairs across all threads
+		* @return
+		*	double Millions of operations per second, a push and a pop count as one each
+		*/
+		template <typename Queue>
+		double MeasureQueue(unsigned int numThreads, unsigned int totalPairs)
+		{
+			// Enough room that every thread can always push before it pops
+			Queue queue(numThreads * 4);
+
+			unsigned int pairsPerThread = totalPairs / numThreads;
+			std::atomic<unsigned int> ready(0);
+			std::atomic<bool> go(false);
+			std::atomic<unsigned int> checksum(0);
+
+			std::vector<std::thread> threads;
+			for(unsigned int t = 0; t < numThreads; ++t)
+			{
+				threads.push_back(std::thread([&, t]()
+				{
+					unsigned int sum = 0;
+					ready.fetch_add(1);
+					while(go.load(std::memory_order_acquire) == false)
+					{
+						std::this_thread::yield();
+					}
+
+					for(unsigned int i = 0; i < pairsPerThread; ++i)
+					{
+						unsigned int value = t + i;
+						while(queue.tryPush(value) == false)
+						{
+							std::this_thread::yield();
+						}
+						while(queue.tryPop(value) == false)
+						{
+							std::this_thread::yield();
+						}
+						sum += value;
+					}
+
+					// Keeps the popped values alive
+					checksum.fetch_add(sum);
+				}));
+			}
+
+			while(ready.load() < numThreads)
+			{
+				std::this_thread::yield();
+			}
+
+			BenchClock::time_point start = BenchClock::now();
+			go.store(true, std::memory_order_release);
+			for(unsigned int t = 0; t < numThreads; ++t)
+			{
+				threads[t].join();
+			}
+			double seconds = SecondsSince(start);
+
+			double ops = 2.0 * pairsPerThread * numThreads;
+			return ops / seconds / 1.0e6;
+		}
+
+		/** Have one owner push and pop items in bursts while thieves steal from it, and check every
+		*	item is taken exactly once
+		* @param
+		*	numThieves The number of stealing threads
+		* @param
+		*	numItems The number of items the owner pushes
+		* @param
+		*	numStolen Receives the number of items the thieves took
+		* @return
+		*	bool True if every item was taken exactly once
+		*/
+		bool CheckDeque(unsigned int numThieves, unsigned int numItems, unsigned int& numStolen)
+		{
+			// Small enough that the ring wraps many times
+			WorkStealingDeque<unsigned int> deque;
+			deque.reset(64);
+
+			std::vector<std::atomic<unsigned int> > taken(numItems);
+			for(unsigned int i = 0; i < numItems; ++i)
+			{
+				taken[i].store(0, std::memory_order_relaxed);
+			}
+
+			std::atomic<bool> done(false);
+			std::atomic<unsigned int> stolen(0);
+			std::vector<std::thread> thieves;
+			for(unsigned int t = 0; t < numThieves; ++t)
+			{
+				thieves.push_back(std::thread([&]()
+				{
+					unsigned int value;
+					while(done.load(std::memory_order_acquire) == false)
+					{
+						if(deque.steal(value) == true)
+						{
+							taken[value].fetch_add(1, std::memory_order_relaxed);
+							stolen.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				}));
+			}
+
+			// Push a burst, then pop half of it back so the owner and the thieves meet at the last item
+			unsigned int value;
+			unsigned int next = 0;
+			while(next < numItems)
+			{
+				for(unsigned int i = 0; i < 8 && next < numItems; ++i)
+				{
+					if(deque.push(next) == true)
+					{
+						++next;
+					}
+				}
+				for(unsigned int i = 0; i < 4 && deque.pop(value) == true; ++i)
+				{
+					taken[value].fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			while(deque.isEmpty() == false)
+			{
+				if(deque.pop(value) == true)
+				{
+					taken[value].fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			done.store(true, std::memory_order_release);
+			for(unsigned int t = 0; t < thieves.size(); ++t)
+			{
+				thieves[t].join();
+			}
+
+			numStolen = stolen.load();
+			for(unsigned int i = 0; i < numItems; ++i)
+			{
+				if(taken[i].load() != 1)
+				{
+					printf("deque item %u taken %u times\n", i, taken[i].load());
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	/** Measure lock-free queue throughput against a locked std::queue
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunQueueBench(int argc, char** argv)
+	{
+		unsigned int totalPairs = 1 << 20;
+		if(argc > 0)
+		{
+			totalPairs = static_cast<unsigned int>(atoi(argv[0]));
+		}
+
+		static const unsigned int ThreadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+		printf("%8s %14s %14s %8s\n", "threads", "mpmc Mops/s", "locked Mops/s", "speedup");
+		for(unsigned int i = 0; i < sizeof(ThreadCounts) / sizeof(ThreadCounts[0]); ++i)
+		{
+			unsigned int numThreads = ThreadCounts[i];
+			if(totalPairs < numThreads)
+			{
+				break;
+			}
+
+			double ring = MeasureQueue<MPMCQueue<unsigned int> >(numThreads, totalPairs);
+			double locked = MeasureQueue<LockedQueue<unsigned int> >(numThreads, totalPairs);
+			printf("%8u %14.2f %14.2f %7.2fx\n", numThreads, ring, locked, ring / locked);
+		}
+
+		// The worker pool's deques, checked rather than timed
+		for(unsigned int numThieves = 1; numThieves <= 4; numThieves *= 2)
+		{
+			unsigned int numStolen = 0;
+			if(CheckDeque(numThieves, totalPairs, numStolen) == false)
+			{
+				return 1;
+			}
+			printf("work-stealing deque, %u thieves: %u items each taken once, %u stolen\n", numThieves, totalPairs, numStolen);
+		}
+
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,179 @@
+//*************************************************************************************************
+// Title: RandomBench.cpp
+// Description: Checks that the keyed generators give every pixel sample the same numbers whatever
+//	thread draws them and in whatever order, then times filling a frame of samples against the
+//	number of threads. Nothing is shared between the threads, so the rate should grow with them.
+//*************************************************************************************************
+#include "Bench.h"
+#include "ParallelFor.h"
+#include "Random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// The seed every frame is drawn with
+		const unsigned int FrameSeed = 1;
+
+		// The first outputs of the PCG reference implementation for seed 42 on stream 54
+		const unsigned int ReferenceSeed = 42;
+		const unsigned int ReferenceStream = 54;
+		const unsigned int ReferenceOutputs[] = { 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu };
+
+		/** Average the numbers drawn for every sample of a pixel, two per sample as a 2D sample
+		*	position would take
+		*/
+		float SamplePixel(unsigned int x, unsigned int y, unsigned int numSamples, unsigned int frame)
+		{
+			float sum = 0.0f;
+			for(unsigned int s = 0; s < numSamples; ++s)
+			{
+				Random random = Random::ForPixel(FrameSeed, x, y, s, frame);
+				float u = random.nextFloat();
+				float v = random.nextFloat();
+				sum += u + v;
+			}
+			return sum / (2.0f * numSamples);
+		}
+
+		/** Draw a frame of samples, threads take rows as they finish them
+		* @param
+		*	reverse Visit the pixels of each row right to left
+		*/
+		void SampleFrame(unsigned int numThreads, unsigned int width, unsigned int height, unsigned int numSamples, unsigned int frame,
+			bool reverse, std::vector<float>& pixels)
+		{
+			pixels.resize(width * height);
+			ParallelForBlocks(numThreads, height, 1, [&](unsigned int, unsigned int begin, unsigned int end)
+			{
+				for(unsigned int y = begin; y < end; ++y)
+				{
+					for(unsigned int i = 0; i < width; ++i)
+					{
+						unsigned int x = reverse == true ? width - 1 - i : i;
+						pixels[y * width + x] = SamplePixel(x, y, numSamples, frame);
+					}
+				}
+			});
+		}
+
+		/** Check that a key always gives the same sequence and that changing any part of it does not
+		* @return
+		*	bool True if every check passed
+		*/
+		bool CheckKeys()
+		{
+			Random reference(ReferenceSeed, ReferenceStream);
+			for(unsigned int i = 0; i < sizeof(ReferenceOutputs) / sizeof(ReferenceOutputs[0]); ++i)
+			{
+				unsigned int value = reference.nextUInt();
+				if(value != ReferenceOutputs[i])
+				{
+					printf("reference mismatch at %u: %08x expected %08x\n", i, value, ReferenceOutputs[i]);
+					return false;
+				}
+			}
+
+			Random a = Random::ForPixel(FrameSeed, 17, 5, 2, 3);
+			Random b = Random::ForPixel(FrameSeed, 17, 5, 2, 3);
+			for(unsigned int i = 0; i < 64; ++i)
+			{
+				if(a.nextUInt() != b.nextUInt())
+				{
+					printf("key gave two sequences, differ at draw %u\n", i);
+					return false;
+				}
+			}
+
+			// Each neighbour changes one part of the key
+			unsigned int first = Random::ForPixel(FrameSeed, 17, 5, 2, 3).nextUInt();
+			Random neighbours[] =
+			{
+				Random::ForPixel(FrameSeed + 1, 17, 5, 2, 3),
+				Random::ForPixel(FrameSeed, 18, 5, 2, 3),
+				Random::ForPixel(FrameSeed, 17, 6, 2, 3),
+				Random::ForPixel(FrameSeed, 17, 5, 3, 3),
+				Random::ForPixel(FrameSeed, 17, 5, 2, 4),
+				Random::ForPixel(FrameSeed, 5, 17, 2, 3),
+			};
+			const char* const parts[] = { "seed", "x", "y", "sample", "frame", "swapped x and y" };
+			for(unsigned int i = 0; i < sizeof(neighbours) / sizeof(neighbours[0]); ++i)
+			{
+				if(neighbours[i].nextUInt() == first)
+				{
+					printf("changing the %s gave the same numbers\n", parts[i]);
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	/** Check the keyed generators are reproducible and time a frame of samples against threads
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunRandomBench(int argc, char** argv)
+	{
+		unsigned int width = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 512;
+		unsigned int numSamples = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 16;
+		unsigned int maxThreads = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : std::thread::hardware_concurrency();
+		unsigned int height = width * 3 / 4;
+		maxThreads = std::max(maxThreads, 1u);
+		numSamples = std::max(numSamples, 1u);
+
+		if(CheckKeys() == false)
+		{
+			return 1;
+		}
+
+		// One thread in order is the reference every other run must match bit for bit
+		const unsigned int frame = 7;
+		std::vector<float> reference;
+		SampleFrame(1, width, height, numSamples, frame, false, reference);
+
+		std::vector<float> pixels;
+		SampleFrame(1, width, height, numSamples, frame, true, pixels);
+		if(memcmp(&pixels[0], &reference[0], pixels.size() * sizeof(float)) != 0)
+		{
+			printf("frame drawn right to left differs\n");
+			return 1;
+		}
+
+		double mean = 0.0;
+		for(unsigned int i = 0; i < reference.size(); ++i)
+		{
+			mean += reference[i];
+		}
+		mean /= reference.size();
+
+		double numDraws = 2.0 * width * height * numSamples;
+		printf("%ux%u pixels, %u samples, mean %.4f (0.5 expected)\n", width, height, numSamples, mean);
+		printf("%8s %10s %12s %10s\n", "threads", "frame ms", "Mdraws/s", "identical");
+		for(unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+		{
+			BenchClock::time_point start = BenchClock::now();
+			SampleFrame(numThreads, width, height, numSamples, frame, false, pixels);
+			double seconds = SecondsSince(start);
+
+			bool identical = memcmp(&pixels[0], &reference[0], pixels.size() * sizeof(float)) == 0;
+			printf("%8u %10.2f %12.1f %10s\n", numThreads, seconds * 1000.0, numDraws / seconds / 1.0e6, identical == true ? "yes" : "no");
+			if(identical == false)
+			{
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,94 @@
+//*************************************************************************************************
+// Title: ScalingBench.cpp
+// Description: Frame time of the full renderer from one trace worker up to many, with workers
+//	writing pixels straight to the shared frame buffer against tracing into their own tile
+//	buffers. Small tiles put more tile edges on shared cache lines, so they are the default.
+//*************************************************************************************************
+#include "Bench.h"
+#include "SceneRenderer.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// Each configuration is rendered this many times and the fastest frame kept
+		const unsigned int NumRepeats = 3;
+
+		/** Render frames with the given settings and keep the fastest
+		* @return
+		*	double The fastest frame time in seconds
+		*/
+		double TimeFrames(SceneRenderer& renderer, unsigned int numWorkers, bool tileBuffers, unsigned int width, unsigned int height)
+		{
+			renderer.setNumWorkers(numWorkers);
+			renderer.setTileBuffers(tileBuffers);
+
+			double best = 0.0;
+			for(unsigned int i = 0; i < NumRepeats; ++i)
+			{
+				BenchClock::time_point start = BenchClock::now();
+				renderer.render(width, height).wait();
+				double seconds = SecondsSince(start);
+				renderer.waitForWorkers();
+				best = i == 0 ? seconds : std::min(best, seconds);
+			}
+			return best;
+		}
+	}
+
+	/** Measure how frame time scales with trace workers, with and without tile buffers
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunScalingBench(int argc, char** argv)
+	{
+		unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		unsigned int maxWorkers = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : hardwareThreads;
+		unsigned int tileSize = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 8;
+		unsigned int width = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 1024;
+		unsigned int height = width * 3 / 4;
+		maxWorkers = std::max(maxWorkers, 1u);
+
+		SceneRenderer renderer;
+		renderer.setTileSize(std::max(tileSize, 1u), std::max(tileSize, 1u));
+
+		printf("%ux%u pixels, %ux%u tiles, %u hardware threads, fastest of %u frames\n", width, height, tileSize, tileSize, hardwareThreads, NumRepeats);
+		printf("%8s %12s %12s %12s %12s %10s\n", "workers", "direct ms", "buffered ms", "direct x", "buffered x", "gain");
+
+		double directBase = 0.0;
+		double bufferedBase = 0.0;
+
+		// Double the workers each step, finishing on the maximum
+		unsigned int numWorkers = 1;
+		while(true)
+		{
+			double direct = TimeFrames(renderer, numWorkers, false, width, height);
+			double buffered = TimeFrames(renderer, numWorkers, true, width, height);
+			if(numWorkers == 1)
+			{
+				directBase = direct;
+				bufferedBase = buffered;
+			}
+
+			printf("%8u %12.2f %12.2f %12.2f %12.2f %10.2f\n", numWorkers, direct * 1000.0, buffered * 1000.0, directBase / direct, bufferedBase / buffered,
+				direct / buffered);
+
+			if(numWorkers == maxWorkers)
+			{
+				break;
+			}
+			numWorkers = std::min(numWorkers * 2, maxWorkers);
+		}
+
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,281 @@
+//*************************************************************************************************
+// Title: SceneBench.cpp
+// Description: Whole frames of a fixed set of seeded scenes through the full renderer, reported
+//	as a table and as JSON so runs from different commits can be compared.
+//*************************************************************************************************
+#include "Bench.h"
+#include "Box3.h"
+#include "Material.h"
+#include "PacketMath.h"
+#include "PointLight.h"
+#include "Random.h"
+#include "SceneRenderer.h"
+#include "Sphere.h"
+#include "SphereSet.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// Every scene is built from this seed, so every run traces exactly the same frames
+		const unsigned int SceneSeed = 1;
+
+		// Each scene is rendered this many times and the fastest frame kept
+		const unsigned int NumFrames = 3;
+
+		/** Draw a point in the camera's view at a depth between near and far
+		*/
+		Vector3 RandomViewPoint(Random& random, float nearZ, float farZ)
+		{
+			float z = random.nextFloat(nearZ, farZ);
+			float x = random.nextFloat(-0.7f, 0.7f) * z;
+			float y = random.nextFloat(-0.5f, 0.5f) * z;
+			return Vector3(x, y, z);
+		}
+
+		/** Scatter point lights through the view, each gets its share of the brightness
+		*/
+		void AddLights(Scene& scene, Random& random, unsigned int numLights)
+		{
+			float scale = 1.0f / numLights;
+			for(unsigned int i = 0; i < numLights; ++i)
+			{
+				Vector4 ambient = RandomColor(random, 1.0f) * scale;
+				Vector4 diffuse = RandomColor(random, 1.0f) * scale;
+				Vector4 specular = RandomColor(random, 1.0f) * scale;
+				Vector3 position = RandomViewPoint(random, 0.0f, 100.0f);
+				float attenuation = random.nextFloat(0.0f, 0.05f);
+				scene.addLight(scene.getArena().create<PointLight>(position, Vector3(1.0f, attenuation, 0.0f), 1000.0f, ambient, diffuse, specular));
+			}
+		}
+
+		/** A regular grid of spheres filling the view
+		*/
+		void BuildSphereGrid(Scene& scene, unsigned int seed)
+		{
+			Random random(seed);
+			Matrix44 identity;
+			identity.setIdentity();
+
+			for(unsigned int z = 0; z < 8; ++z)
+			{
+				for(unsigned int y = 0; y < 16; ++y)
+				{
+					for(unsigned int x = 0; x < 16; ++x)
+					{
+						float depth = 30.0f + z * 8.0f;
+						Vector3 center((x - 7.5f) / 8.0f * 0.7f * depth, (y - 7.5f) / 8.0f * 0.5f * depth, depth);
+						Sphere* sphere = scene.getArena().create<Sphere>(identity, center, 0.04f * depth);
+						sphere->setMaterial(RandomMaterial(random));
+						scene.addObject(sphere);
+					}
+				}
+			}
+			AddLights(scene, random, 8);
+		}
+
+		/** A dense cloud of small spheres held in one sphere set
+		*/
+		void BuildParticles(Scene& scene, unsigned int seed)
+		{
+			Random random(seed);
+			Matrix44 identity;
+			identity.setIdentity();
+
+			const unsigned int NumParticles = 200000;
+			const unsigned int NumMaterials = 16;
+			SphereSet* particles = scene.getArena().create<SphereSet>(identity);
+			particles->reserve(NumParticles);
+			for(unsigned int i = 0; i < NumMaterials; ++i)
+			{
+				particles->addMaterial(RandomMaterial(random));
+			}
+			for(unsigned int i = 0; i < NumParticles; ++i)
+			{
+				Vector3 center = RandomViewPoint(random, 30.0f, 90.0f);
+				float radius = random.nextFloat(0.05f, 0.2f);
+				particles->addSphere(center, radius, random.nextUInt(NumMaterials));
+			}
+			particles->build();
+			scene.addObject(particles);
+			AddLights(scene, random, 4);
+		}
+
+		/** A few spheres lit by many lights, so shading dominates
+		*/
+		void BuildManyLights(Scene& scene, unsigned int seed)
+		{
+			Random random(seed);
+			Matrix44 identity;
+			identity.setIdentity();
+
+			for(unsigned int i = 0; i < 60; ++i)
+			{
+				Vector3 center = RandomViewPoint(random, 20.0f, 90.0f);
+				Sphere* sphere = scene.getArena().create<Sphere>(identity, center, random.nextFloat(1.0f, 4.0f));
+				sphere->setMaterial(RandomMaterial(random));
+				scene.addObject(sphere);
+			}
+			AddLights(scene, random, 256);
+		}
+
+		/** Randomly sized boxes scattered through the view
+		*/
+		void BuildBoxes(Scene& scene, unsigned int seed)
+		{
+			Random random(seed);
+			Matrix44 identity;
+			identity.setIdentity();
+
+			for(unsigned int i = 0; i < 5000; ++i)
+			{
+				Vector3 center = RandomViewPoint(random, 20.0f, 120.0f);
+				float x = random.nextFloat(0.2f, 1.5f);
+				float y = random.nextFloat(0.2f, 1.5f);
+				float z = random.nextFloat(0.2f, 1.5f);
+				Vector3 half(x, y, z);
+				Box3* box = scene.getArena().create<Box3>(identity, center - half, center + half);
+				box->setMaterial(RandomMaterial(random));
+				scene.addObject(box);
+			}
+			AddLights(scene, random, 8);
+		}
+
+		/** A named standard scene
+		*/
+		struct BenchScene
+		{
+			const char* name;
+			void (*build)(Scene& scene, unsigned int seed);
+		};
+
+		const BenchScene BenchScenes[] =
+		{
+			{ "default", 0 },
+			{ "spheregrid", BuildSphereGrid },
+			{ "particles", BuildParticles },
+			{ "manylights", BuildManyLights },
+			{ "boxes", BuildBoxes },
+		};
+
+		/** Results of the fastest frame of a scene
+		*/
+		struct SceneResult
+		{
+			const char* name;
+			unsigned int numObjects;
+			unsigned int numLights;
+			FrameTimings timings;
+			RayStats rays;
+		};
+
+		/** Get the rate of a count over the traced part of a frame
+		*/
+		double TraceRate(unsigned long long count, const FrameTimings& timings)
+		{
+			double seconds = timings.frameSeconds - timings.setupSeconds;
+			return seconds > 0.0 ? count / seconds : 0.0;
+		}
+
+		/** Write the results as JSON
+		*/
+		bool WriteJson(const char* path, const SceneRenderer& renderer, unsigned int width, unsigned int height, const SceneResult* results, unsigned int numResults)
+		{
+			FILE* file = fopen(path, "w");
+			if(file == 0)
+			{
+				return false;
+			}
+
+			fprintf(file, "{\n");
+			fprintf(file, "  \"suite\": \"scenes\",\n");
+			fprintf(file, "  \"width\": %u,\n  \"height\": %u,\n", width, height);
+			fprintf(file, "  \"workers\": %u,\n", renderer.getNumWorkers());
+			fprintf(file, "  \"packet_tracing\": %s,\n  \"packet_width\": %u,\n", renderer.getPacketTracing() == true ? "true" : "false", PacketWidth);
+			fprintf(file, "  \"seed\": %u,\n  \"frames\": %u,\n", SceneSeed, NumFrames);
+			fprintf(file, "  \"scenes\": [\n");
+			for(unsigned int i = 0; i < numResults; ++i)
+			{
+				const SceneResult& r = results[i];
+				fprintf(file, "    {\n");
+				fprintf(file, "      \"name\": \"%s\",\n", r.name);
+				fprintf(file, "      \"objects\": %u,\n      \"lights\": %u,\n", r.numObjects, r.numLights);
+				fprintf(file, "      \"setup_ms\": %.3f,\n", r.timings.setupSeconds * 1000.0);
+				fprintf(file, "      \"first_tile_ms\": %.3f,\n", r.timings.firstTileSeconds * 1000.0);
+				fprintf(file, "      \"frame_ms\": %.3f,\n", r.timings.frameSeconds * 1000.0);
+				fprintf(file, "      \"camera_rays\": %llu,\n", r.rays.numCameraRays);
+				fprintf(file, "      \"shadow_rays\": %llu,\n", r.rays.numShadowRays);
+				fprintf(file, "      \"shading_samples\": %llu,\n", r.rays.numShadingSamples);
+				fprintf(file, "      \"primary_rays_per_s\": %.0f,\n", TraceRate(r.rays.numCameraRays, r.timings));
+				fprintf(file, "      \"shading_samples_per_s\": %.0f\n", TraceRate(r.rays.numShadingSamples, r.timings));
+				fprintf(file, "    }%s\n", i + 1 < numResults ? "," : "");
+			}
+			fprintf(file, "  ]\n}\n");
+			return fclose(file) == 0;
+		}
+	}
+
+	/** Render the standard scenes and report frame timings and throughput
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSceneBench(int argc, char** argv)
+	{
+		unsigned int width = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 512;
+		const char* jsonPath = argc > 1 ? argv[1] : "scenes.json";
+		unsigned int numWorkers = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 0;
+		unsigned int height = width * 3 / 4;
+
+		SceneRenderer renderer;
+		renderer.setNumWorkers(numWorkers);
+		renderer.setSceneSeed(SceneSeed);
+		renderer.calcOptimalChunks(width, height);
+
+		const unsigned int numScenes = sizeof(BenchScenes) / sizeof(BenchScenes[0]);
+		SceneResult results[numScenes];
+
+		printf("%ux%u pixels, %u workers, fastest of %u frames\n", width, height, renderer.getNumWorkers(), NumFrames);
+		printf("%-12s %8s %7s %10s %12s %10s %14s %16s\n", "scene", "objects", "lights", "setup ms", "1st tile ms", "frame ms", "primary Mray/s", "shading Msamp/s");
+		for(unsigned int i = 0; i < numScenes; ++i)
+		{
+			const BenchScene& scene = BenchScenes[i];
+			renderer.setSceneBuilder(scene.build != 0 ? SceneRenderer::SceneBuilder(scene.build) : SceneRenderer::SceneBuilder());
+
+			SceneResult& result = results[i];
+			result.name = scene.name;
+			for(unsigned int frame = 0; frame < NumFrames; ++frame)
+			{
+				renderer.render(width, height).wait();
+				renderer.waitForWorkers();
+
+				FrameTimings timings = renderer.getFrameTimings();
+				if(frame == 0 || timings.frameSeconds < result.timings.frameSeconds)
+				{
+					result.timings = timings;
+					result.rays = renderer.getRayStats();
+				}
+			}
+			result.numObjects = renderer.getScene()->getNumObjects();
+			result.numLights = renderer.getScene()->getNumLights();
+
+			printf("%-12s %8u %7u %10.2f %12.2f %10.2f %14.3f %16.3f\n", result.name, result.numObjects, result.numLights,
+				result.timings.setupSeconds * 1000.0, result.timings.firstTileSeconds * 1000.0, result.timings.frameSeconds * 1000.0,
+				TraceRate(result.rays.numCameraRays, result.timings) / 1.0e6, TraceRate(result.rays.numShadingSamples, result.timings) / 1.0e6);
+		}
+
+		if(WriteJson(jsonPath, renderer, width, height, results, numScenes) == false)
+		{
+			printf("failed to write %s\n", jsonPath);
+			return 1;
+		}
+		printf("wrote %s\n", jsonPath);
+		return 0;
+	}
+
+}	// Namespace
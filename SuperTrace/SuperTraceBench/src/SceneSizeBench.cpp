@@ -0,0 +1,91 @@
+//*************************************************************************************************
+// Title: SceneSizeBench.cpp
+// Description: How each stage of a frame scales with scene size, from generating the scene and
+//	building its hierarchy to tracing it, over generated scenes of growing size in each layout.
+//*************************************************************************************************
+#include "Bench.h"
+#include "SceneGenerator.h"
+#include "SceneRenderer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		// Every scene is generated from this seed, so every run traces exactly the same frames
+		const unsigned int SceneSeed = 1;
+
+		// The smallest scene, each step after it is ten times larger
+		const unsigned int MinObjects = 1000;
+	}
+
+	/** Generate scenes of growing size in each layout and time every stage of a frame
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSceneSizeBench(int argc, char** argv)
+	{
+		unsigned int maxObjects = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 1000000;
+		ScenePrimitive primitive = argc > 1 ? ScenePrimitiveFromName(argv[1]) : SCENE_PRIMITIVE_PARTICLES;
+		unsigned int width = argc > 2 ? static_cast<unsigned int>(atoi(argv[2])) : 256;
+		unsigned int numWorkers = argc > 3 ? static_cast<unsigned int>(atoi(argv[3])) : 0;
+		unsigned int height = width * 3 / 4;
+		if(primitive == NUM_SCENE_PRIMITIVES)
+		{
+			printf("unknown primitive %s, use particles, spheres or boxes\n", argv[1]);
+			return 1;
+		}
+
+		SceneRenderer renderer;
+		renderer.setNumWorkers(numWorkers);
+		renderer.setSceneSeed(SceneSeed);
+		renderer.calcOptimalChunks(width, height);
+
+		SceneGeneratorSettings settings;
+		settings.primitive = primitive;
+		double generateSeconds = 0.0;
+		renderer.setSceneBuilder([&settings, &generateSeconds](Scene& scene, unsigned int seed)
+		{
+			BenchClock::time_point start = BenchClock::now();
+			settings.seed = seed;
+			GenerateScene(scene, settings);
+			generateSeconds = SecondsSince(start);
+		});
+
+		// Generation includes the hierarchy a sphere set builds over its own spheres, the BVH
+		// column is the scene's hierarchy over its objects
+		printf("%s, %ux%u pixels, %u workers, one frame each\n", GetScenePrimitiveName(primitive), width, height, renderer.getNumWorkers());
+		printf("%-10s %10s %12s %10s %10s %10s %10s %14s\n", "layout", "primitives", "generate ms", "bvh ms", "setup ms", "trace ms", "frame ms", "primary Mray/s");
+		for(unsigned int i = 0; i < NUM_SCENE_DISTRIBUTIONS; ++i)
+		{
+			settings.distribution = static_cast<SceneDistribution>(i);
+			for(unsigned int numObjects = MinObjects; numObjects <= maxObjects; numObjects *= 10)
+			{
+				settings.numObjects = numObjects;
+				renderer.render(width, height).wait();
+				renderer.waitForWorkers();
+
+				FrameTimings timings = renderer.getFrameTimings();
+				double traceSeconds = timings.frameSeconds - timings.setupSeconds;
+				double bvhSeconds = renderer.getScene()->getAccelerationStats().buildSeconds;
+				RayStats rays = renderer.getRayStats();
+				printf("%-10s %10u %12.2f %10.2f %10.2f %10.2f %10.2f %14.3f\n", GetSceneDistributionName(settings.distribution), numObjects,
+					generateSeconds * 1000.0, bvhSeconds * 1000.0, timings.setupSeconds * 1000.0, traceSeconds * 1000.0, timings.frameSeconds * 1000.0,
+					traceSeconds > 0.0 ? rays.numCameraRays / traceSeconds / 1.0e6 : 0.0);
+
+				// Stop before the count wraps
+				if(numObjects > maxObjects / 10)
+				{
+					break;
+				}
+			}
+		}
+		return 0;
+	}
+
+}	// Namespace
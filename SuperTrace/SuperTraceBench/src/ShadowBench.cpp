@@ -0,0 +1,145 @@
+//*************************************************************************************************
+// Title: ShadowBench.cpp
+// Description: Occlusion queries with any hit traversal against the same queries answered with a
+//	closest hit search. Both must agree on every ray, the any hit walk should be faster the more
+//	of the rays are blocked.
+//*************************************************************************************************
+#include "Bench.h"
+#include "BVH.h"
+#include "HitRecord.h"
+#include "Sphere.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Generate shadow rays between random points in the sphere volume, ending at the second
+		*	point like a ray towards a light
+		*/
+		void MakeShadowRays(unsigned int numRays, std::vector<Ray>& rays)
+		{
+			rays.clear();
+			rays.reserve(numRays);
+			for(unsigned int i = 0; i < numRays; ++i)
+			{
+				Vector3 from(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				Vector3 to(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				Vector3 direction = to - from;
+				float distance = direction.length();
+				direction.normalize();
+				rays.push_back(Ray(from, direction, RAY_TYPE_SHADOW, 0.0f, distance));
+			}
+		}
+
+		/** Answer each query by searching for the closest hit
+		*/
+		unsigned int OccludedClosestHit(const BVH& bvh, const std::vector<Object*>& objects, const std::vector<Ray>& rays, std::vector<char>& blocked)
+		{
+			unsigned int numBlocked = 0;
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				HitRecord hit(ray.getTMax());
+				bvh.traverse(ray, hit.t, [&](unsigned int index)
+				{
+					objects[index]->intersect(ray, hit);
+					return false;
+				});
+				blocked[r] = hit.isHit() == true ? 1 : 0;
+				numBlocked += blocked[r];
+			}
+			return numBlocked;
+		}
+
+		/** Answer each query by stopping at the first blocker
+		*/
+		unsigned int OccludedAnyHit(const BVH& bvh, const std::vector<Object*>& objects, const std::vector<Ray>& rays, std::vector<char>& blocked)
+		{
+			unsigned int numBlocked = 0;
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				bool occluded = bvh.traverseAny(ray, [&](unsigned int index)
+				{
+					return objects[index]->occludes(ray);
+				});
+				blocked[r] = occluded == true ? 1 : 0;
+				numBlocked += blocked[r];
+			}
+			return numBlocked;
+		}
+	}
+
+	/** Measure any hit occlusion queries against closest hit queries over the same rays
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunShadowBench(int argc, char** argv)
+	{
+		unsigned int maxPrimitives = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 100000;
+		unsigned int numRays = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 65536;
+
+		SeedRandf(1);
+		std::vector<Ray> rays;
+		MakeShadowRays(numRays, rays);
+		std::vector<char> closestBlocked(numRays);
+		std::vector<char> anyBlocked(numRays);
+
+		Matrix44 identity;
+		identity.setIdentity();
+
+		printf("%10s %16s %16s %8s %10s\n", "prims", "closest Mrays/s", "any hit Mrays/s", "speedup", "blocked %");
+		for(unsigned int numPrimitives = 100; numPrimitives <= maxPrimitives; numPrimitives *= 10)
+		{
+			// Same sizing as the closest hit bench so occlusion rates stay comparable
+			float radius = 2.0f * sqrtf(1000.0f / numPrimitives);
+
+			std::vector<Object*> objects;
+			std::vector<AABB> bounds;
+			objects.reserve(numPrimitives);
+			bounds.reserve(numPrimitives);
+			for(unsigned int i = 0; i < numPrimitives; ++i)
+			{
+				Vector3 center(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				Sphere* sphere = new Sphere(identity, center, Randf(0.5f, 1.0f) * radius);
+				objects.push_back(sphere);
+				bounds.push_back(sphere->getBounds());
+			}
+
+			BVH bvh;
+			bvh.build(bounds);
+
+			BenchClock::time_point start = BenchClock::now();
+			unsigned int closestCount = OccludedClosestHit(bvh, objects, rays, closestBlocked);
+			double closestRate = numRays / SecondsSince(start) / 1.0e6;
+
+			start = BenchClock::now();
+			unsigned int anyCount = OccludedAnyHit(bvh, objects, rays, anyBlocked);
+			double anyRate = numRays / SecondsSince(start) / 1.0e6;
+
+			if(closestBlocked != anyBlocked)
+			{
+				printf("occlusion mismatch: closest hit %u blocked, any hit %u blocked\n", closestCount, anyCount);
+				return 1;
+			}
+
+			printf("%10u %16.3f %16.3f %8.2f %10.1f\n", numPrimitives, closestRate, anyRate, anyRate / closestRate, 100.0 * anyCount / numRays);
+
+			for(unsigned int i = 0; i < objects.size(); ++i)
+			{
+				delete objects[i];
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,208 @@
+//*************************************************************************************************
+// Title: SphereSetBench.cpp
+// Description: Closest hit throughput and memory of a SphereSet against the same spheres held as
+//	separate Sphere objects under a BVH. Where the two disagree, which happens on small distant
+//	spheres where Sphere's quadratic loses precision, both candidates are solved again in double
+//	precision and the set must match that answer.
+//*************************************************************************************************
+#include "Bench.h"
+#include "BVH.h"
+#include "HitRecord.h"
+#include "Sphere.h"
+#include "SphereSet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+namespace SuperTrace
+{
+	namespace
+	{
+		/** Trace every ray through the objects' hierarchy, recording each hit
+		*/
+		void TraceObjects(const BVH& bvh, const std::vector<Object*>& objects, const std::vector<Ray>& rays, std::vector<HitRecord>& hits)
+		{
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				HitRecord& hit = hits[r];
+				hit = HitRecord(ray.getTMax());
+				bvh.traverse(ray, hit.t, [&](unsigned int index)
+				{
+					if(objects[index]->intersect(ray, hit) == true)
+					{
+						hit.primitive = index;
+					}
+					return false;
+				});
+			}
+		}
+
+		/** Trace every ray against the set, recording each hit
+		*/
+		void TraceSet(const SphereSet& set, const std::vector<Ray>& rays, std::vector<HitRecord>& hits)
+		{
+			for(unsigned int r = 0; r < rays.size(); ++r)
+			{
+				const Ray& ray = rays[r];
+				hits[r] = HitRecord(ray.getTMax());
+				set.intersect(ray, hits[r]);
+			}
+		}
+
+		/** Solve a ray against a sphere in double precision
+		* @return
+		*	double The nearest root within the ray, -1 if there is none
+		*/
+		double SolveSphereExact(const Ray& ray, const Vector3& center, float radius)
+		{
+			double l[3], d[3];
+			for(unsigned int axis = 0; axis < 3; ++axis)
+			{
+				l[axis] = static_cast<double>(ray.getOrigin()[axis]) - center[axis];
+				d[axis] = ray.getDirection()[axis];
+			}
+			double a = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+			double b = d[0] * l[0] + d[1] * l[1] + d[2] * l[2];
+			double c = l[0] * l[0] + l[1] * l[1] + l[2] * l[2] - static_cast<double>(radius) * radius;
+			double disc = b * b - a * c;
+			if(disc < 0.0)
+			{
+				return -1.0;
+			}
+
+			double t0 = (-b - sqrt(disc)) / a;
+			double t1 = (-b + sqrt(disc)) / a;
+			double t = t0 >= ray.getTMin() ? t0 : t1;
+			return t >= ray.getTMin() && t <= ray.getTMax() ? t : -1.0;
+		}
+
+		/** Check whether two hit distances agree
+		*/
+		bool SameHit(float a, float b, float tMax)
+		{
+			if(a >= tMax || b >= tMax)
+			{
+				return a >= tMax && b >= tMax;
+			}
+			return fabsf(a - b) <= 1.0e-3f * a;
+		}
+	}
+
+	/** Measure SphereSet closest hit throughput and memory against separate Sphere objects
+	* @param
+	*	argc The number of suite arguments
+	* @param
+	*	argv The suite arguments
+	* @return
+	*	int The process exit code
+	*/
+	int RunSphereSetBench(int argc, char** argv)
+	{
+		unsigned int maxSpheres = argc > 0 ? static_cast<unsigned int>(atoi(argv[0])) : 1000000;
+		unsigned int numRays = argc > 1 ? static_cast<unsigned int>(atoi(argv[1])) : 65536;
+
+		SeedRandf(1);
+		std::vector<Ray> rays;
+		MakeFanRays(numRays, rays);
+		std::vector<HitRecord> objectHits(numRays);
+		std::vector<HitRecord> setHits(numRays);
+
+		Matrix44 identity;
+		identity.setIdentity();
+		Material material;
+
+		// Each object is a heap block behind a pointer, the set keeps its spheres in flat arrays
+		unsigned int objectBytes = sizeof(Sphere) + sizeof(Object*);
+		printf("bytes per sphere: objects %u, set %u, hierarchies not counted\n", objectBytes, SphereSet::getBytesPerSphere());
+		printf("%10s %16s %16s %8s %10s %8s %8s %8s\n", "spheres", "objects Mrays/s", "set Mrays/s", "speedup", "hit %", "differ", "obj off", "set off");
+		for(unsigned int numSpheres = 1000; numSpheres <= maxSpheres; numSpheres *= 10)
+		{
+			// Same sizing as the BVH bench so hit rates stay comparable
+			float radius = 2.0f * sqrtf(1000.0f / numSpheres);
+
+			std::vector<Object*> objects;
+			std::vector<Vector3> centers;
+			std::vector<float> radii;
+			std::vector<AABB> bounds;
+			SphereSet set(identity);
+			objects.reserve(numSpheres);
+			bounds.reserve(numSpheres);
+			set.reserve(numSpheres);
+			unsigned int setMaterial = set.addMaterial(material);
+			for(unsigned int i = 0; i < numSpheres; ++i)
+			{
+				Vector3 center(Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f), Randf(-50.0f, 50.0f));
+				float r = Randf(0.5f, 1.0f) * radius;
+				Sphere* sphere = new Sphere(identity, center, r);
+				objects.push_back(sphere);
+				centers.push_back(center);
+				radii.push_back(r);
+				bounds.push_back(sphere->getBounds());
+				set.addSphere(center, r, setMaterial);
+			}
+
+			BVH bvh;
+			bvh.build(bounds);
+			set.build();
+
+			BenchClock::time_point start = BenchClock::now();
+			TraceObjects(bvh, objects, rays, objectHits);
+			double objectRate = numRays / SecondsSince(start) / 1.0e6;
+
+			start = BenchClock::now();
+			TraceSet(set, rays, setHits);
+			double setRate = numRays / SecondsSince(start) / 1.0e6;
+
+			unsigned int numHits = 0;
+			unsigned int numDiffer = 0;
+			unsigned int numObjectsOff = 0;
+			unsigned int numSetOff = 0;
+			for(unsigned int r = 0; r < numRays; ++r)
+			{
+				const Ray& ray = rays[r];
+				const HitRecord& objectHit = objectHits[r];
+				const HitRecord& setHit = setHits[r];
+				numHits += objectHit.isHit() == true ? 1 : 0;
+				if(SameHit(objectHit.t, setHit.t, ray.getTMax()) == true)
+				{
+					continue;
+				}
+				++numDiffer;
+
+				// The nearer of the two candidates in double precision is the answer both should give
+				double exact = -1.0;
+				if(objectHit.isHit() == true)
+				{
+					exact = SolveSphereExact(ray, centers[objectHit.primitive], radii[objectHit.primitive]);
+				}
+				if(setHit.isHit() == true)
+				{
+					double t = SolveSphereExact(ray, set.getCenter(setHit.primitive), set.getRadius(setHit.primitive));
+					exact = t >= 0.0 && (exact < 0.0 || t < exact) ? t : exact;
+				}
+				float expected = exact >= 0.0 ? static_cast<float>(exact) : ray.getTMax();
+				numObjectsOff += SameHit(objectHit.t, expected, ray.getTMax()) == true ? 0 : 1;
+				numSetOff += SameHit(setHit.t, expected, ray.getTMax()) == true ? 0 : 1;
+			}
+
+			printf("%10u %16.3f %16.3f %8.2f %10.1f %8u %8u %8u\n", numSpheres, objectRate, setRate, setRate / objectRate, 100.0 * numHits / numRays,
+				numDiffer, numObjectsOff, numSetOff);
+
+			for(unsigned int i = 0; i < objects.size(); ++i)
+			{
+				delete objects[i];
+			}
+
+			if(numSetOff > 0)
+			{
+				printf("set hits differ from the double precision solution on %u rays\n", numSetOff);
+				return 1;
+			}
+		}
+
+		return 0;
+	}
+
+}	// Namespace
@@ -0,0 +1,392 @@
+//*************************************************************************************************
+// Title: HeadlessMain.cpp
+// Description: Command line entry point that renders without a window and writes the frame to
+//	disk. Besides the Visual Studio project it builds anywhere with a C++11 compiler by compiling
+//	this file with SuperTrace/src and SuperTrace/source, leaving out Main.cpp and GLPresenter.cpp,
+//	e.g. from SuperTrace/:
+//	g++ -std=c++11 -O2 -pthread -ISuperTrace/include SuperTraceHeadless/src/HeadlessMain.cpp $(ls SuperTrace/src/*.cpp SuperTrace/source/*.cpp | grep -v -e Main.cpp -e GLPresenter.cpp)
+//*************************************************************************************************
+#include "AllocationTracker.h"
+#include "HeadlessPresenter.h"
+#include "ImageWriter.h"
+#include "PacketMath.h"
+#include "RenderStats.h"
+#include "Scene.h"
+#include "SceneGenerator.h"
+#include "SceneRenderer.h"
+#include "Timeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace SuperTrace;
+
+namespace
+{
+	void PrintUsage()
+	{
+		printf("usage: SuperTraceHeadless [options]\n"
+			"  -w <pixels>    image width (default 1024)\n"
+			"  -h <pixels>    image height (default 768)\n"
+			"  -t <count>     trace workers, 0 for one per hardware thread (default 0)\n"
+			"  -s <pixels>    fixed tile size, 0 for adaptive tiling (default 0)\n"
+			"  -p <0|1>       trace camera rays in packets (default 1 when built with SIMD)\n"
+			"  -b <0|1>       trace into per-worker tile buffers (default 1)\n"
+			"  -r <seed>      scene seed (default 1)\n"
+			"  -g <layout>    generate the scene, uniform, clustered or grid, instead of the default scene\n"
+			"  -e <type>      generated primitives, particles, spheres or boxes (default particles)\n"
+			"  -k <count>     generated primitives (default 10000)\n"
+			"  -l <count>     generated point lights (default 8)\n"
+			"  -z <min,max>   generated sphere radius or box half extent range (default 0.1,0.5)\n"
+			"  -n <frames>    frames to render, the last is written (default 1)\n"
+			"  -d <hz>        present tiles to an in-memory display at up to hz uploads a second, 0 for\n"
+			"                 uncapped, and check every frame presented matches the frame buffer\n"
+			"  -c <0|1>       hand out tiles most expensive first from the last frame's costs (default 1)\n"
+			"  -m <file>      write a heatmap of tile cost, and the tiles as CSV next to it\n"
+			"  -j <file>      write a timeline of every thread as Chrome trace-event JSON, needs a build\n"
+			"                 with ST_ENABLE_TIMELINE\n"
+			"  -o <file>      output image (default render.ppm)\n"
+			"  -f <format>    ppm, pfm or png, taken from the output extension if omitted\n");
+	}
+
+	/** Parse a non-negative integer argument
+	*/
+	bool ParseUnsigned(const char* text, unsigned int& value)
+	{
+		char* end = 0;
+		long parsed = strtol(text, &end, 10);
+		if(end == text || *end != '\0' || parsed < 0)
+		{
+			return false;
+		}
+		value = static_cast<unsigned int>(parsed);
+		return true;
+	}
+
+	/** Get a path with its extension replaced
+	*/
+	std::string ReplaceExtension(const char* path, const char* extension)
+	{
+		std::string result(path);
+		size_t dot = result.find_last_of('.');
+		size_t slash = result.find_last_of("/\\");
+		if(dot != std::string::npos && (slash == std::string::npos || dot > slash))
+		{
+			result.erase(dot);
+		}
+		return result + extension;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int width = 1024;
+	unsigned int height = 768;
+	unsigned int numWorkers = 0;
+	unsigned int tileSize = 0;
+	unsigned int packets = PacketHasSimd == true ? 1 : 0;
+	unsigned int tileBuffers = 1;
+	unsigned int seed = 1;
+	unsigned int numFrames = 1;
+	unsigned int costOrdering = 1;
+	const char* output = "render.ppm";
+	const char* heatmap = 0;
+	const char* timeline = 0;
+	double presentRate = -1.0;
+	const char* formatName = 0;
+	bool generate = false;
+	SceneGeneratorSettings generator;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : 0;
+		bool valid = value != 0;
+
+		if(strcmp(arg, "-w") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, width);
+		}
+		else if(strcmp(arg, "-h") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, height);
+		}
+		else if(strcmp(arg, "-t") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, numWorkers);
+		}
+		else if(strcmp(arg, "-s") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, tileSize);
+		}
+		else if(strcmp(arg, "-p") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, packets) && packets <= 1;
+		}
+		else if(strcmp(arg, "-b") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, tileBuffers) && tileBuffers <= 1;
+		}
+		else if(strcmp(arg, "-r") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, seed);
+		}
+		else if(strcmp(arg, "-g") == 0 && valid == true)
+		{
+			generator.distribution = SceneDistributionFromName(value);
+			valid = generate = generator.distribution != NUM_SCENE_DISTRIBUTIONS;
+		}
+		else if(strcmp(arg, "-e") == 0 && valid == true)
+		{
+			generator.primitive = ScenePrimitiveFromName(value);
+			valid = generator.primitive != NUM_SCENE_PRIMITIVES;
+		}
+		else if(strcmp(arg, "-k") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, generator.numObjects);
+		}
+		else if(strcmp(arg, "-l") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, generator.numLights);
+		}
+		else if(strcmp(arg, "-z") == 0 && valid == true)
+		{
+			valid = sscanf(value, "%f,%f", &generator.minSize, &generator.maxSize) == 2 && generator.minSize > 0.0f && generator.minSize <= generator.maxSize;
+		}
+		else if(strcmp(arg, "-n") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, numFrames) && numFrames >= 1;
+		}
+		else if(strcmp(arg, "-d") == 0 && valid == true)
+		{
+			char* end = 0;
+			presentRate = strtod(value, &end);
+			valid = end != value && *end == '\0' && presentRate >= 0.0;
+		}
+		else if(strcmp(arg, "-c") == 0 && valid == true)
+		{
+			valid = ParseUnsigned(value, costOrdering) && costOrdering <= 1;
+		}
+		else if(strcmp(arg, "-m") == 0 && valid == true)
+		{
+			heatmap = value;
+		}
+		else if(strcmp(arg, "-j") == 0 && valid == true)
+		{
+			timeline = value;
+		}
+		else if(strcmp(arg, "-o") == 0 && valid == true)
+		{
+			output = value;
+		}
+		else if(strcmp(arg, "-f") == 0 && valid == true)
+		{
+			formatName = value;
+		}
+		else
+		{
+			valid = false;
+		}
+
+		if(valid == false)
+		{
+			PrintUsage();
+			return 1;
+		}
+		++i;
+	}
+
+	if(width == 0 || height == 0)
+	{
+		fprintf(stderr, "image dimensions must be positive\n");
+		return 1;
+	}
+
+	// An explicit format wins over the extension
+	ImageFormat format = IMAGE_FORMAT_UNKNOWN;
+	if(formatName != 0)
+	{
+		char name[8];
+		snprintf(name, sizeof(name), ".%s", formatName);
+		format = ImageFormatFromPath(name);
+	}
+	else
+	{
+		format = ImageFormatFromPath(output);
+	}
+	if(format == IMAGE_FORMAT_UNKNOWN)
+	{
+		fprintf(stderr, "unknown image format, use ppm, pfm or png\n");
+		return 1;
+	}
+	ImageFormat heatmapFormat = heatmap != 0 ? ImageFormatFromPath(heatmap) : IMAGE_FORMAT_UNKNOWN;
+	if(heatmap != 0 && heatmapFormat == IMAGE_FORMAT_UNKNOWN)
+	{
+		fprintf(stderr, "unknown heatmap format, use ppm, pfm or png\n");
+		return 1;
+	}
+
+	SceneRenderer renderer;
+	renderer.setNumWorkers(numWorkers);
+	renderer.setPacketTracing(packets == 1);
+	renderer.setTileBuffers(tileBuffers == 1);
+	renderer.setSceneSeed(seed);
+	renderer.setTileCostOrdering(costOrdering == 1);
+
+	// Every frame builds its scene again, the generator is timed each time and the last kept
+	double generateSeconds = 0.0;
+	if(generate == true)
+	{
+		renderer.setSceneBuilder([&generator, &generateSeconds](Scene& scene, unsigned int sceneSeed)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			SceneGeneratorSettings settings = generator;
+			settings.seed = sceneSeed;
+			GenerateScene(scene, settings);
+			generateSeconds = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::high_resolution_clock::now() - start).count();
+		});
+	}
+	if(tileSize > 0)
+	{
+		renderer.setTileSize(tileSize, tileSize);
+	}
+	else
+	{
+		renderer.calcOptimalChunks(width, height);
+	}
+
+	if(timeline != 0)
+	{
+		if(IsTimelineEnabled() == false)
+		{
+			fprintf(stderr, "timeline spans are compiled out, build with ST_ENABLE_TIMELINE\n");
+			return 1;
+		}
+		BindTimelineThread(TIMELINE_THREAD_MAIN, "Main");
+		StartTimelineCapture();
+	}
+
+	// Tiles go through the same present thread and dirty rectangles as the windowed build
+	HeadlessPresenter presenter;
+	if(presentRate >= 0.0)
+	{
+		presenter.setMaxRefreshRate(presentRate);
+		renderer.setPresenter(&presenter);
+	}
+
+	// Later frames can order their tiles by what they cost in the frame before
+	double seconds = 0.0;
+	std::vector<float> presented;
+	for(unsigned int frame = 0; frame < numFrames; ++frame)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		renderer.render(width, height).wait();
+		seconds = std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::high_resolution_clock::now() - start).count();
+		renderer.waitForWorkers();
+
+		// Once the present thread has exited every pixel must have been uploaded exactly once
+		if(presentRate >= 0.0)
+		{
+			const PresenterStats& presentStats = presenter.getStats();
+			presenter.copyFrame(presented);
+			bool same = presented.size() == width * height * 3 && memcmp(&presented[0], renderer.getPixelData(), presented.size() * sizeof(float)) == 0;
+			if(same == false || presentStats.pixelsUploaded != static_cast<unsigned long long>(width) * height)
+			{
+				fprintf(stderr, "frame %u presented %llu of %u pixels%s\n", frame, presentStats.pixelsUploaded, width * height,
+					same == true ? "" : ", and the presented frame differs from the frame buffer");
+				return 1;
+			}
+		}
+	}
+
+	if(timeline != 0)
+	{
+		StopTimelineCapture();
+		if(WriteTimeline(timeline) == false)
+		{
+			fprintf(stderr, "failed to write %s\n", timeline);
+			return 1;
+		}
+		printf("wrote %s\n", timeline);
+	}
+
+	TilingStats tiling = renderer.getTilingStats();
+	printf("rendered %ux%u in %.3f s with %u workers, %ux%u tiles, %u splits\n",
+		width, height, seconds, renderer.getNumWorkers(), tiling.tileWidth, tiling.tileHeight, tiling.numSplits);
+
+	if(presentRate >= 0.0)
+	{
+		const PresenterStats& presentStats = presenter.getStats();
+		printf("presented %u chunks as %u rectangles in %u uploads, matches the frame buffer\n",
+			presentStats.numChunks, presentStats.numRects, presentStats.numPresents);
+	}
+
+	RayStats rayStats = renderer.getRayStats();
+	printf("%llu camera rays, %llu shadow rays, %.1f%% occluded\n", rayStats.numCameraRays, rayStats.numShadowRays,
+		rayStats.numShadowRays > 0 ? 100.0 * rayStats.numOccludedShadowRays / rayStats.numShadowRays : 0.0);
+
+	if(generate == true)
+	{
+		printf("generated %u %s %s in %.3f ms with %u lights\n", generator.numObjects, GetSceneDistributionName(generator.distribution),
+			GetScenePrimitiveName(generator.primitive), generateSeconds * 1000.0, generator.numLights);
+	}
+
+	const BVHBuildStats& bvhStats = renderer.getScene()->getAccelerationStats();
+	printf("bvh built in %.3f ms on %u threads, %u nodes, %u leaves, depth %u, SAH cost %.2f\n",
+		bvhStats.buildSeconds * 1000.0, bvhStats.numThreads, bvhStats.numNodes, bvhStats.numLeaves, bvhStats.maxDepth, bvhStats.sahCost);
+
+	if(IsRenderStatsEnabled() == true)
+	{
+		RenderStats renderStats = renderer.getRenderStats();
+		unsigned long long numRays = 0;
+		for(unsigned int i = 0; i < NUM_RAY_TYPES; ++i)
+		{
+			numRays += renderStats.numRays[i];
+		}
+		double perRay = numRays > 0 ? 1.0 / numRays : 0.0;
+		printf("rays: %llu camera, %llu shadow, %llu other; per ray %.1f node tests, %.2f primitive tests, %.2f hits; %llu shading calls\n",
+			renderStats.numRays[RAY_TYPE_CAMERA], renderStats.numRays[RAY_TYPE_SHADOW], renderStats.numRays[RAY_TYPE_UNKNOWN],
+			renderStats.numNodeTests * perRay, renderStats.numPrimitiveTests * perRay, renderStats.numPrimitiveHits * perRay, renderStats.numShadingCalls);
+		for(unsigned int i = 0; i < renderer.getNumWorkers(); ++i)
+		{
+			RenderStats workerStats = renderer.getWorkerRenderStats(i);
+			printf("worker %u: %llu tiles, %llu camera rays, %.3f s busy, %.3f s idle\n", i, workerStats.numTiles,
+				workerStats.numRays[RAY_TYPE_CAMERA], workerStats.busySeconds, workerStats.idleSeconds);
+		}
+	}
+
+	if(IsAllocationTrackingEnabled() == true)
+	{
+		RenderAllocationStats allocations = renderer.getAllocationStats();
+		printf("heap allocations: %llu setup (%llu KB), %llu tracing, %llu presenting\n", allocations.setup.numAllocations,
+			allocations.setup.numBytes / 1024, allocations.trace.numAllocations, allocations.present.numAllocations);
+	}
+
+	if(WriteImage(output, format, width, height, renderer.getPixelData()) == false)
+	{
+		fprintf(stderr, "failed to write %s\n", output);
+		return 1;
+	}
+	printf("wrote %s\n", output);
+
+	if(heatmap != 0)
+	{
+		std::vector<TileRecord> records;
+		renderer.getTileRecords(records);
+		std::vector<float> heat(width * height * 3);
+		BuildTileHeatmap(records, width, height, &heat[0]);
+
+		std::string csv = ReplaceExtension(heatmap, ".csv");
+		if(WriteImage(heatmap, heatmapFormat, width, height, &heat[0]) == false || WriteTileCsv(csv.c_str(), records) == false)
+		{
+			fprintf(stderr, "failed to write %s\n", heatmap);
+			return 1;
+		}
+		printf("wrote %s and %s, %u tiles\n", heatmap, csv.c_str(), static_cast<unsigned int>(records.size()));
+	}
+
+	return 0;
+}